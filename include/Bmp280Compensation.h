@@ -0,0 +1,49 @@
+#ifndef BMP280_COMPENSATION_H
+#define BMP280_COMPENSATION_H
+
+#include <stdint.h>
+
+// Leitura do BMP280 pelos registradores: uma única rajada de BMP280_REG_DATA traz pressão
+// e temperatura da mesma conversão, e a compensação em inteiros do datasheet (seção
+// 3.11.3) calcula as duas a partir dela, com o t_fine da temperatura na pressão.
+// Não depende de hardware: o driver lê os bytes pelo I2C e o simulador usa a mesma
+// compensação para gerar os registradores.
+
+// Registradores (datasheet, seção 4.2)
+#define BMP280_REG_CALIB     0x88    // dig_T1 ... dig_P9, little-endian
+#define BMP280_REG_CHIP_ID   0xD0
+#define BMP280_REG_STATUS    0xF3
+#define BMP280_REG_CTRL_MEAS 0xF4    // osrs_t (7:5), osrs_p (4:2), modo (1:0)
+#define BMP280_REG_CONFIG    0xF5    // Standby (7:5), filtro IIR (4:2)
+#define BMP280_REG_DATA      0xF7    // press_msb, press_lsb, press_xlsb, temp_msb, temp_lsb, temp_xlsb
+
+#define BMP280_CALIB_BYTES 24
+#define BMP280_DATA_BYTES 6
+#define BMP280_CHIP_ID 0x58
+#define BMP280_STATUS_MEASURING 0x08  // Conversão em andamento
+#define BMP280_MODE_FORCED 0x01
+#define BMP280_ADC_SKIPPED 0x80000    // Valor de uma medida desligada (oversampling 0)
+
+struct Bmp280Calibration {
+  uint16_t t1;
+  int16_t t2, t3;
+  uint16_t p1;
+  int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+};
+
+// Coeficientes a partir dos BMP280_CALIB_BYTES bytes lidos de BMP280_REG_CALIB
+void bmp280ParseCalibration(const uint8_t* raw, Bmp280Calibration& calibration);
+
+// ctrl_meas para uma conversão no modo forçado com os códigos de oversampling dados
+uint8_t bmp280CtrlMeas(uint8_t tempOversampling, uint8_t pressOversampling);
+
+// Temperatura (°C) e pressão (Pa) dos valores de 20 bits do ADC. Retorna false para uma
+// medida desligada ou coeficientes inválidos (dig_P1 = 0)
+bool bmp280CompensateAdc(const Bmp280Calibration& calibration, int32_t adcTemperature,
+                         int32_t adcPressure, float& temperature, float& pressurePa);
+
+// Temperatura (°C) e pressão (Pa) dos BMP280_DATA_BYTES bytes lidos de BMP280_REG_DATA
+bool bmp280Compensate(const Bmp280Calibration& calibration, const uint8_t* data,
+                      float& temperature, float& pressurePa);
+
+#endif // BMP280_COMPENSATION_H
@@ -0,0 +1,30 @@
+#ifndef BMP280_PROFILE_H
+#define BMP280_PROFILE_H
+
+#include <stdint.h>
+
+// Perfis de oversampling do BMP280 para o modo forçado, como recomendados no datasheet. Cada
+// leitura dispara uma única conversão e o sensor volta a dormir; mais oversampling
+// reduz o ruído da pressão ao custo de tempo de conversão, e a corrente do sensor
+// (cerca de 0,7 mA enquanto converte) cresce na mesma proporção. Sem filtro IIR: com um
+// wake a cada poucos minutos o filtro não se acomoda e as primeiras leituras saem
+// puxadas para o valor antigo.
+// Não depende de hardware: os códigos de oversampling são os do registrador ctrl_meas
+// (1 = x1 ... 5 = x16).
+
+#define BMP280_PROFILE_COUNT 5
+
+struct Bmp280Profile {
+  const char* name;
+  uint8_t tempOversampling;    // Código osrs_t
+  uint8_t pressOversampling;   // Código osrs_p
+};
+
+// Perfil pelo índice da configuração (0 = ultra low power ... 4 = ultra high resolution);
+// índices fora da faixa usam o último perfil
+const Bmp280Profile& bmp280Profile(uint8_t index);
+
+// Tempo máximo de uma conversão no modo forçado (datasheet, seção 3.8.1), em µs
+uint32_t bmp280ConversionUs(const Bmp280Profile& profile);
+
+#endif // BMP280_PROFILE_H
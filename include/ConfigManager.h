@@ -13,6 +13,12 @@ struct WeatherStationConfig {
   uint8_t deepSleepTimeMinutes;
   uint16_t cpuFreqMHz;
   float rainMmPerTip;
+  uint16_t rainFlushTips;      // Basculadas registradas sem rádio antes de forçar um envio
+  uint16_t rainFlushMinutes;   // Atraso máximo (min) para transmitir uma basculada
+  uint16_t rainEventDryMinutes; // Pausa seca (min) que encerra um evento de chuva
+  uint16_t sleepMinMinutes;    // Menor intervalo escolhido pelo agendador adaptativo
+  uint16_t sleepMaxMinutes;    // Maior intervalo escolhido pelo agendador adaptativo
+  uint8_t bmpProfile;          // Perfil de oversampling do BMP280 (Bmp280Profile.h)
   
   // Configurações WiFi
   char wifiSsid[32];
@@ -63,6 +69,10 @@ public:
   
   // Verifica se o botão de configuração foi pressionado
   bool checkConfigButtonPressed();
+  
+  // Arquivos binários de tamanho fixo (cópias de estado no flash)
+  bool readBlob(const char* path, void* data, size_t size);
+  bool writeBlob(const char* path, const void* data, size_t size);
 
 private:
   WeatherStationConfig _config;
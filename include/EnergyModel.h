@@ -0,0 +1,54 @@
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+#include <stdint.h>
+
+// Estimativa do consumo de cada ciclo de wake a partir das durações medidas e de um
+// modelo de corrente por componente. Não depende de hardware: um trace de fases
+// (ex.: o campo "prof" da telemetria) pode ser reprocessado no host.
+
+// Corrente de cada componente (mA); os valores padrão estão em config.h
+struct EnergyModelConfig {
+  float deepSleepMa;      // Deep sleep (inclui ULP e periféricos RTC ligados)
+  float cpuBaseMa;        // CPU ativa, parte independente da frequência
+  float cpuMaPerMHz;      // CPU ativa, parte proporcional à frequência
+  float wifiRxMa;         // WiFi recebendo/escutando (somado à CPU)
+  float wifiTxMa;         // WiFi transmitindo (somado à CPU)
+  float wifiTxDuty;       // Fração do tempo com WiFi ligado em transmissão
+  float bleMa;            // BLE anunciando/conectado (somado à CPU)
+};
+
+// Tempo de cada componente em um ciclo; os tempos de rádio se sobrepõem ao da CPU
+struct EnergySample {
+  uint32_t activeUs;      // CPU ativa
+  uint32_t wifiUs;        // WiFi ligado
+  uint32_t bleUs;         // BLE ligado
+  uint64_t sleepUs;       // Deep sleep
+  uint16_t cpuMHz;
+};
+
+// Consumo acumulado, mantido em memória RTC
+struct EnergyAccount {
+  uint32_t magic;
+  uint32_t cycles;
+  double consumedMah;     // Desde a instalação da bateria (power-on)
+  float lastCycleMah;
+  float averageMa;        // Corrente média suavizada (EMA)
+};
+
+// Carga (mAh) consumida em um ciclo
+float energyCycleMah(const EnergyModelConfig& config, const EnergySample& sample);
+
+// Zera o acumulado (nova bateria)
+void energyAccountReset(EnergyAccount& account);
+
+// Indica se o acumulado foi inicializado por energyAccountReset()
+bool energyAccountValid(const EnergyAccount& account);
+
+// Soma um ciclo ao acumulado e atualiza a corrente média
+void energyAccountAdd(EnergyAccount& account, const EnergyModelConfig& config, const EnergySample& sample);
+
+// Autonomia projetada (h) com a corrente média atual; negativo se ainda não houver média
+float energyProjectedHours(const EnergyAccount& account, float capacityMah);
+
+#endif // ENERGY_MODEL_H
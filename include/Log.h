@@ -0,0 +1,67 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Log com níveis definidos na compilação (LOG_LEVEL em config.h).
+//
+// Mensagens acima de LOG_LEVEL são removidas pelo pré-processador, inclusive a avaliação
+// dos argumentos. As habilitadas são formatadas em um buffer circular na memória RTC,
+// que sobrevive ao deep sleep; a serial só é inicializada e usada quando há um host
+// conectado (ou no modo de configuração). O buffer também pode ser lido pelo portal (/log).
+// Cada chamada gera uma linha; não inclua '\n' no formato.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+
+// Detecta o host e, se houver, abre a serial e envia o que foi registrado sem host
+void logBegin();
+
+// Abre a serial mesmo sem host detectado (modo de configuração)
+void logAttachSerial();
+
+// Registra uma mensagem já filtrada pelo nível
+void logWrite(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Copia o buffer para out, da linha mais antiga para a mais recente
+void logDump(Print& out);
+
+#else
+
+inline void logBegin() {}
+inline void logAttachSerial() {}
+inline void logDump(Print& out) {}
+
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+  #define LOG_E(...) logWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+  #define LOG_E(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+  #define LOG_W(...) logWrite(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+  #define LOG_W(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  #define LOG_I(...) logWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+  #define LOG_I(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+  #define LOG_D(...) logWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+  #define LOG_D(...) do {} while (0)
+#endif
+
+#endif // LOG_H
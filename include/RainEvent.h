@@ -0,0 +1,57 @@
+#ifndef RAIN_EVENT_H
+#define RAIN_EVENT_H
+
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+#include "RainHistory.h"
+
+// Segmentação da chuva em eventos (tempestades). Um evento começa na primeira basculada
+// depois de uma pausa seca de pelo menos dryMinutes e termina quando a pausa seguinte
+// chega a dryMinutes. Para cada evento guarda início, última basculada, total e o maior
+// intervalo de RAIN_BIN_MINUTES (a mesma base de rain_peak_5).
+//
+// Atualizado a cada basculada e a cada ciclo completo, sem varreduras: o evento aberto e
+// uma pequena fila de eventos encerrados ficam na memória RTC até serem publicados.
+// Não depende de hardware (ver tools/rain_event_bench.cpp).
+
+// Um evento de chuva; tips == 0 é "nenhum evento"
+struct RainEvent {
+  uint32_t start;        // Timestamp da primeira basculada
+  uint32_t end;          // Timestamp da última basculada
+  uint32_t tips;         // Basculadas no evento
+  uint16_t peakBinTips;  // Maior número de basculadas em um intervalo de RAIN_BIN_SECONDS
+};
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é sem eventos
+struct RainEventTable {
+  RainEvent current;                             // Evento aberto
+  uint32_t currentBin;                           // Intervalo (timestamp / RAIN_BIN_SECONDS) da última basculada
+  uint16_t currentBinTips;                       // Basculadas do evento aberto nesse intervalo
+  uint8_t completedCount;                        // Eventos encerrados aguardando publicação
+  RainEvent completed[RAIN_EVENT_TABLE_SIZE];    // Do mais antigo para o mais recente
+  uint16_t dropped;                              // Eventos descartados com a fila cheia
+};
+
+void rainEventReset(RainEventTable& table);
+
+// Registra basculadas no instante timestamp. Se a pausa desde a última basculada do
+// evento aberto chegou a dryMinutes, ele é encerrado e as basculadas começam outro.
+void rainEventAddTips(RainEventTable& table, uint16_t tips, time_t timestamp, uint16_t dryMinutes);
+
+// Encerra o evento aberto se não houve basculada nos últimos dryMinutes até now.
+// Retorna true se um evento foi encerrado.
+bool rainEventAdvance(RainEventTable& table, time_t now, uint16_t dryMinutes);
+
+// Evento encerrado mais antigo ainda não publicado; nullptr se não houver
+const RainEvent* rainEventOldest(const RainEventTable& table);
+
+// Remove da fila o evento encerrado mais antigo (depois de publicado)
+void rainEventPop(RainEventTable& table);
+
+// Duração (min), total (mm) e pico de intensidade (mm/h) de um evento
+uint32_t rainEventMinutes(const RainEvent& event);
+float rainEventTotal(const RainEvent& event, float mmPerTip);
+float rainEventPeakRate(const RainEvent& event, float mmPerTip);
+
+#endif // RAIN_EVENT_H
@@ -0,0 +1,46 @@
+#ifndef RAIN_HISTORY_H
+#define RAIN_HISTORY_H
+
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+
+// Histórico de chuva das últimas 24 h em intervalos fixos de RAIN_BIN_SECONDS, cada um
+// com o número de basculadas. Memória e custo das consultas não dependem da intensidade
+// da chuva. As somas da última hora e do último dia são mantidas de forma incremental:
+// cada wake só zera os intervalos que passaram desde o anterior.
+// Não depende de hardware (ver tools/rain_history_bench.cpp).
+
+#define RAIN_BIN_SECONDS (RAIN_BIN_MINUTES * 60)
+#define RAIN_HOUR_BINS (60 / RAIN_BIN_MINUTES)
+
+// As janelas cobrem intervalos inteiros: "última hora" são os RAIN_HOUR_BINS intervalos
+// mais recentes, incluindo o corrente (entre 55 e 60 min com intervalos de 5 min)
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é um histórico vazio
+struct RainHistory {
+  uint16_t tips[RAIN_HISTORY_BINS];  // Basculadas por intervalo, indexado por (bin % RAIN_HISTORY_BINS)
+  uint32_t currentBin;               // Intervalo mais recente (timestamp / RAIN_BIN_SECONDS)
+  uint32_t hourTips;                 // Soma dos RAIN_HOUR_BINS intervalos mais recentes
+  uint32_t dayTips;                  // Soma de todos os intervalos
+};
+
+void rainHistoryReset(RainHistory& history);
+
+// Registra basculadas no intervalo de timestamp. Um timestamp anterior ao intervalo
+// corrente (troca da base de tempo) conta no intervalo corrente.
+void rainHistoryAddTips(RainHistory& history, uint16_t tips, time_t timestamp);
+
+// Avança o intervalo corrente até now, zerando os intervalos que saíram das 24 h.
+// Retorna quantos intervalos com chuva foram descartados. Se now for anterior ao
+// intervalo corrente (relógio sem NTP), nada muda.
+uint16_t rainHistoryAdvance(RainHistory& history, time_t now);
+
+// Basculadas na última hora e nas últimas 24 h até now
+uint32_t rainHistoryHourTips(RainHistory& history, time_t now);
+uint32_t rainHistoryDayTips(RainHistory& history, time_t now);
+
+// Basculadas nos bins intervalos mais recentes, incluindo o corrente, sem avançar
+uint32_t rainHistoryRecentTips(const RainHistory& history, uint16_t bins);
+
+#endif // RAIN_HISTORY_H
@@ -0,0 +1,85 @@
+#ifndef RAIN_LOG_H
+#define RAIN_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include "config.h"
+#include "RainHistory.h"
+
+// Log de chuva em flash que sobrevive à perda de energia (troca de bateria, brownout).
+//
+// Cada registro guarda as basculadas de um intervalo de RAIN_BIN_SECONDS e o contador
+// total depois dele, protegidos por CRC. As basculadas ficam primeiro em RainLog
+// (memória RTC) e são gravadas em lote, até uma página de RAIN_LOG_PAGE_SIZE bytes por
+// escrita; o custo por basculada é só o incremento na memória RTC.
+// O log é circular sobre todos os setores da partição: cada setor só é apagado quando a
+// escrita volta a ele, de modo que os apagamentos se distribuem igualmente (wear levelling).
+// Uma escrita interrompida deixa um registro com CRC inválido, ignorado na leitura.
+//
+// Funciona sobre qualquer RainLogFlash (partição no dispositivo, memória no host; ver
+// tools/rain_log_bench.cpp).
+
+#define RAIN_LOG_SECTOR_SIZE 4096
+#define RAIN_LOG_PAGE_SIZE 256
+
+// Registro gravado no flash (16 por página)
+struct RainLogRecord {
+  uint32_t sequence;   // Número do registro desde o início do log
+  uint32_t bin;        // Intervalo (timestamp / RAIN_BIN_SECONDS)
+  uint32_t totalTips;  // Contador total de basculadas depois deste intervalo
+  uint16_t tips;       // Basculadas no intervalo
+  uint16_t crc;        // CRC-16 dos campos anteriores
+};
+
+#define RAIN_LOG_RECORDS_PER_PAGE (RAIN_LOG_PAGE_SIZE / sizeof(RainLogRecord))
+
+// Acesso ao flash. Como no NOR, escrever só leva bits de 1 para 0 e apagar (por setor)
+// volta tudo para 0xFF.
+struct RainLogFlash {
+  uint32_t size;                                                  // Múltiplo de RAIN_LOG_SECTOR_SIZE
+  bool (*read)(uint32_t offset, void* data, uint32_t length);
+  bool (*write)(uint32_t offset, const void* data, uint32_t length);
+  bool (*erase)(uint32_t offset, uint32_t length);                // Setores inteiros
+};
+
+// Intervalo com basculadas ainda não gravadas
+struct RainLogPending {
+  uint32_t bin;
+  uint16_t tips;
+};
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); válido após rainLogBegin()
+struct RainLog {
+  bool ready;                                         // Posição de escrita conhecida
+  uint32_t nextSequence;
+  uint32_t writeOffset;                               // Posição do próximo registro na partição
+  uint32_t committedTips;                             // Contador total no último registro gravado
+  uint32_t totalTips;                                 // Contador total, incluindo os pendentes
+  uint8_t pendingCount;
+  RainLogPending pending[RAIN_LOG_PENDING_RECORDS];
+};
+
+// Recebe os registros válidos do mais antigo para o mais recente
+typedef void (*RainLogRecordCallback)(const RainLogRecord& record);
+
+// Localiza o fim do log no flash e continua o contador do último registro. Um log vazio
+// começa em initialTips. As basculadas pendentes (memória RTC) são descartadas.
+bool rainLogBegin(RainLog& log, const RainLogFlash& flash, uint32_t initialTips);
+
+// Acumula basculadas no intervalo de timestamp (só memória RTC). Um timestamp anterior
+// ao último intervalo pendente conta nele; sem espaço, conta no último pendente.
+void rainLogAddTips(RainLog& log, uint16_t tips, time_t timestamp);
+
+// Indica se já há uma página de pendentes ou se o mais antigo tem mais de
+// RAIN_LOG_MAX_DELAY_MINUTES em relação a now
+bool rainLogCommitDue(const RainLog& log, time_t now);
+
+// Grava os pendentes, apagando cada setor ao entrar nele. Retorna os registros gravados
+// ou -1 em erro de flash (os pendentes são mantidos).
+int rainLogCommit(RainLog& log, const RainLogFlash& flash);
+
+// Percorre os registros válidos em ordem; retorna quantos foram lidos
+uint32_t rainLogReplay(const RainLogFlash& flash, RainLogRecordCallback onRecord);
+
+#endif // RAIN_LOG_H
@@ -0,0 +1,52 @@
+#ifndef RAIN_RATE_H
+#define RAIN_RATE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+#include "RainHistory.h"
+
+// Intensidade da chuva em mm/h: instantânea, pelos intervalos entre as basculadas mais
+// recentes, e os picos das janelas de 5, 15 e 60 min nas últimas 24 h.
+//
+// A intensidade instantânea é o intervalo médio entre as RAIN_RATE_TIPS últimas
+// basculadas do mesmo episódio (sem pausa de RAIN_RATE_TIMEOUT_MINUTES), medido em pelo
+// menos RAIN_RATE_MIN_SPAN_SECONDS (as basculadas do ULP têm resolução de um minuto).
+// Entre basculadas a estimativa é interpolada abaixo de uma basculada: se a próxima já
+// passou do intervalo medido, a chuva caiu pelo menos para uma basculada no tempo
+// decorrido. Sem basculadas há RAIN_RATE_TIMEOUT_MINUTES a intensidade é zero.
+//
+// Os picos são somas de 1, 3 e 12 intervalos consecutivos de RainHistory. Só a janela que
+// termina no intervalo corrente pode crescer, e só quando há basculada: cada basculada
+// atualiza o máximo da hora corrente em um anel de 24 horas, e o máximo das 24 h só é
+// recalculado quando sai do anel a hora que o continha. Nenhuma varredura por wake.
+// Não depende de hardware (ver tools/rain_rate_bench.cpp).
+
+#define RAIN_RATE_WINDOWS 3                                      // 5, 15 e 60 min
+#define RAIN_RATE_PEAK_HOURS (RAIN_HISTORY_BINS / RAIN_HOUR_BINS) // Período dos picos (24 h)
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é sem chuva
+struct RainRate {
+  uint32_t tipTimes[RAIN_RATE_TIPS];                         // Basculadas mais recentes, indexadas por (tipCount % RAIN_RATE_TIPS)
+  uint32_t tipCount;                                         // Basculadas registradas (só cresce)
+  uint32_t peakHour;                                         // Hora (timestamp / 3600) mais recente do anel
+  uint16_t hourPeaks[RAIN_RATE_PEAK_HOURS][RAIN_RATE_WINDOWS]; // Maior soma de cada janela por hora, indexado por (hora % 24)
+  uint16_t dayPeaks[RAIN_RATE_WINDOWS];                      // Maior soma de cada janela no anel
+};
+
+void rainRateReset(RainRate& rate);
+
+// Registra basculadas no instante timestamp. Chamada depois de rainHistoryAddTips(),
+// com o histórico já contando essas basculadas.
+void rainRateAddTips(RainRate& rate, const RainHistory& history, uint16_t tips, time_t timestamp);
+
+// Intensidade instantânea em now (mm/h)
+float rainRateInstant(const RainRate& rate, time_t now, float mmPerTip);
+
+// Picos das janelas de 5, 15 e 60 min nas últimas 24 h até now (mm/h)
+void rainRatePeaks(RainRate& rate, time_t now, float mmPerTip, float peaks[RAIN_RATE_WINDOWS]);
+
+// Duração de cada janela dos picos em minutos
+uint16_t rainRateWindowMinutes(uint8_t window);
+
+#endif // RAIN_RATE_H
@@ -0,0 +1,88 @@
+#ifndef RAIN_ROLLUP_H
+#define RAIN_ROLLUP_H
+
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+
+// Totais de chuva em janelas longas (7 dias, 30 dias, mês corrente, até um ano) em
+// camadas de hora, dia e mês no horário local. Os intervalos de 5 min de RainHistory
+// são a camada mais fina; aqui cada camada guarda, para cada hora/dia/mês, o contador
+// total de basculadas no início do intervalo. O total de uma janela é o contador atual
+// menos o valor guardado no intervalo em que a janela começa, escolhido na camada mais
+// fina que ainda o alcança: custo O(camadas), sem varreduras.
+// Só avança com relógio de parede (NTP); basculadas sem relógio contam no intervalo
+// corrente. Não depende de hardware (ver tools/rain_history_bench.cpp).
+//
+// As camadas de horas e dias guardam só os 16 bits menos significativos do contador;
+// totalTips (32 bits) é a âncora e a subtração módulo 2^16 é exata enquanto a janela
+// tiver menos de 65536 basculadas (16 m de chuva com 0,25 mm). Os meses, que somam até
+// um ano, ficam com 32 bits.
+
+#define RAIN_ROLLUP_MIN_EPOCH 1577836800     // 2020-01-01: abaixo disso o relógio não é de parede
+#define RAIN_ROLLUP_UTC_OFFSET (NTP_TIMEZONE * 3600)
+
+// As janelas cobrem intervalos inteiros: "últimos 7 dias" começa no início da hora que
+// contém now - 7 dias. Antes do primeiro intervalo registrado considera-se chuva zero.
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é um acumulado vazio
+struct RainRollup {
+  uint32_t totalTips;                       // Basculadas desde o início (só cresce)
+  uint32_t hourBin;                         // Hora local corrente (horas desde 1970; 0 = sem relógio ainda)
+  uint32_t dayBin;                          // Dia local corrente (dias desde 1970)
+  uint32_t monthBin;                        // Mês local corrente (ano * 12 + mês - 1)
+  uint16_t hourStart[RAIN_ROLLUP_HOURS];    // totalTips (16 bits) no início de cada hora, indexado por (hourBin % RAIN_ROLLUP_HOURS)
+  uint16_t dayStart[RAIN_ROLLUP_DAYS];      // Idem por dia
+  uint32_t monthStart[RAIN_ROLLUP_MONTHS];  // Idem por mês
+};
+
+// Cópia do acumulado gravada no flash, validada por magic, dimensões e CRC
+struct RainRollupCheckpoint {
+  uint32_t magic;
+  uint32_t layout;                          // Tamanhos das camadas; muda se config.h mudar
+  RainRollup rollup;
+  uint32_t crc;                             // CRC-32 dos campos anteriores
+};
+
+// Cópia gravada pela versão anterior, com todas as camadas em 32 bits; só é lida para
+// migrar o arquivo na primeira inicialização depois da atualização
+struct RainRollupCheckpointV1 {
+  uint32_t magic;
+  uint32_t layout;
+  uint32_t totalTips;
+  uint32_t hourBin;
+  uint32_t dayBin;
+  uint32_t monthBin;
+  uint32_t hourStart[RAIN_ROLLUP_HOURS];
+  uint32_t dayStart[RAIN_ROLLUP_DAYS];
+  uint32_t monthStart[RAIN_ROLLUP_MONTHS];
+  uint32_t crc;
+};
+
+void rainRollupReset(RainRollup& rollup);
+
+// Recomeça as camadas em now com o contador em tips e nenhuma chuva antes
+// (reconstrução a partir do log de chuva)
+void rainRollupStart(RainRollup& rollup, time_t now, uint32_t tips);
+
+// Indica se o acumulado está zerado (nem basculadas nem relógio registrados)
+bool rainRollupEmpty(const RainRollup& rollup);
+
+// Registra basculadas no instante timestamp
+void rainRollupAddTips(RainRollup& rollup, uint16_t tips, time_t timestamp);
+
+// Avança as camadas até now. Retorna false se now não for um relógio de parede.
+bool rainRollupAdvance(RainRollup& rollup, time_t now);
+
+// Basculadas desde since até now (qualquer janela até um ano)
+uint32_t rainRollupTipsSince(RainRollup& rollup, time_t now, time_t since);
+
+// Início (UTC) do mês local que contém now
+time_t rainRollupMonthStart(time_t now);
+
+// Conversão de/para a cópia em flash; rainRollupRestore rejeita cópias inválidas
+void rainRollupCheckpoint(const RainRollup& rollup, RainRollupCheckpoint& checkpoint);
+bool rainRollupRestore(RainRollup& rollup, const RainRollupCheckpoint& checkpoint);
+bool rainRollupRestoreV1(RainRollup& rollup, const RainRollupCheckpointV1& checkpoint);
+
+#endif // RAIN_ROLLUP_H
@@ -0,0 +1,69 @@
+#ifndef RUNTIME_BUDGET_H
+#define RUNTIME_BUDGET_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Fases com prazo próprio dentro de MAX_RUNTIME_MS
+// A ordem é parte do formato de telemetria ("budget") - só adicione novas fases no final
+enum BudgetPhase : uint8_t {
+  BUDGET_SENSORS = 0,   // Inicialização e leitura dos sensores
+  BUDGET_WIFI,          // Espera pela associação WiFi/DHCP
+  BUDGET_NTP,           // Espera pela sincronização NTP
+  BUDGET_SEND,          // Envio via MQTT/Meshtastic
+  BUDGET_PHASE_COUNT
+};
+
+// Contadores persistidos em memória RTC
+struct RuntimeBudgetStats {
+  uint16_t overruns[BUDGET_PHASE_COUNT];  // Fases que terminaram depois do prazo
+  uint16_t skipped;                       // Etapas opcionais descartadas por falta de tempo
+};
+
+// Orçamento de tempo do ciclo de wake. Cada fase recebe um prazo (o menor entre o seu
+// próprio limite e o fim do orçamento total, descontada a reserva para o deep sleep)
+// e o tempo restante é repassado como timeout às chamadas bloqueantes da fase.
+class RuntimeBudget {
+public:
+  RuntimeBudget();
+
+  // Inicia o orçamento do ciclo a partir de startMs (millis() do início de setup())
+  void begin(unsigned long startMs);
+
+  // Encerra a fase corrente (contando atraso) e abre a fase indicada. phaseMs
+  // substitui o limite padrão da fase, ex.: o WiFi já começou antes da espera.
+  void enter(BudgetPhase phase);
+  void enter(BudgetPhase phase, uint32_t phaseMs);
+
+  // Encerra a fase corrente sem abrir outra
+  void leave();
+
+  // Tempo até o prazo da fase corrente (0 se vencido)
+  uint32_t remaining() const;
+
+  // Prazo da fase corrente vencido
+  bool expired() const;
+
+  // Orçamento total esgotado: não há tempo nem para a próxima fase
+  bool exhausted() const;
+
+  // Indica se uma etapa opcional de costMs cabe no prazo; conta o descarte quando não cabe
+  bool allowOptional(uint32_t costMs);
+
+  const RuntimeBudgetStats& stats() const;
+
+  static const char* phaseName(BudgetPhase phase);
+
+private:
+  unsigned long _startMs;
+  uint32_t _deadlineMs;   // Prazo da fase corrente, relativo a _startMs
+  BudgetPhase _phase;
+  bool _inPhase;
+
+  // Tempo decorrido desde o início do ciclo
+  uint32_t elapsed() const;
+};
+
+extern RuntimeBudget runtimeBudget;
+
+#endif // RUNTIME_BUDGET_H
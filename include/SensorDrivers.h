@@ -0,0 +1,59 @@
+#ifndef SENSOR_DRIVERS_H
+#define SENSOR_DRIVERS_H
+
+#include "config.h"
+#include "ConfigManager.h"
+#include "SensorList.h"
+#include "SensorSnapshot.h"
+
+// Drivers dos sensores suportados (ver SensorList.h). Cada um só é compilado com o seu
+// flag; sem ele, o nome é um NoSensor. Para um sensor novo: o driver aqui e em
+// SensorDrivers.cpp, os pinos e tempos em config.h e uma entrada em EnabledSensors.
+
+#ifdef USE_DHT22
+struct Dht22Driver {
+  static const char* name() { return "DHT22"; }
+  static constexpr uint8_t quantities = SENSOR_TEMPERATURE | SENSOR_HUMIDITY;
+  static constexpr uint8_t fallbackQuantities = 0;
+  static constexpr uint32_t conversionMs = 6;            // Protocolo de um fio
+  static constexpr uint32_t retryMinMs = DHT_RETRY_MIN_MS;
+  static void begin(const WeatherStationConfig& config);
+  static bool read(SensorReadings& readings, uint8_t quantities);
+};
+#else
+typedef NoSensor Dht22Driver;
+#endif
+
+#ifdef USE_AHT20
+struct Aht20Driver {
+  static const char* name() { return "AHT20"; }
+  static constexpr uint8_t quantities = SENSOR_TEMPERATURE | SENSOR_HUMIDITY;
+  static constexpr uint8_t fallbackQuantities = 0;
+  static constexpr uint32_t conversionMs = 80;           // Medida disparada a cada leitura
+  static constexpr uint32_t retryMinMs = AHT20_RETRY_MIN_MS;
+  static void begin(const WeatherStationConfig& config);
+  static bool read(SensorReadings& readings, uint8_t quantities);
+};
+#else
+typedef NoSensor Aht20Driver;
+#endif
+
+#ifdef USE_BMP280
+// A temperatura do BMP280 é a do próprio chip: só é usada sem DHT22/AHT20
+struct Bmp280Driver {
+  static const char* name() { return "BMP280"; }
+  static constexpr uint8_t quantities = SENSOR_PRESSURE;
+  static constexpr uint8_t fallbackQuantities = SENSOR_TEMPERATURE;
+  static constexpr uint32_t conversionMs = 14;           // Perfil padrão; até 44 ms (Bmp280Profile.h)
+  static constexpr uint32_t retryMinMs = BMP280_RETRY_MIN_MS;
+  static void begin(const WeatherStationConfig& config);
+  static bool read(SensorReadings& readings, uint8_t quantities);
+};
+#else
+typedef NoSensor Bmp280Driver;
+#endif
+
+// Sensores do build, na ordem do campo "sensor" (ex.: "AHT20+BMP280")
+typedef SensorListOf<Dht22Driver, Aht20Driver, Bmp280Driver>::type EnabledSensors;
+
+#endif // SENSOR_DRIVERS_H
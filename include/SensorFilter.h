@@ -0,0 +1,58 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+
+// Filtro de um canal (temperatura, umidade, pressão) entre wakes, com o estado na memória
+// RTC. A cada wake:
+//   - a leitura bruta entra numa janela com as últimas SENSOR_FILTER_WINDOW leituras, e a
+//     mediana da janela descarta picos isolados;
+//   - um filtro de Kalman de um estado combina a mediana com a estimativa anterior. A
+//     incerteza da estimativa cresce com o tempo desde a última leitura (variação esperada
+//     por minuto), então intervalos de sono longos confiam mais na leitura nova e curtos
+//     suavizam mais;
+//   - uma mediana a mais de SENSOR_FILTER_GATE_SIGMA desvios da estimativa é descartada;
+//     depois de SENSOR_FILTER_MAX_REJECTS descartes seguidos do mesmo lado é uma mudança
+//     real e a estimativa recomeça nela.
+// Valores em ponto fixo (int32 em unidades do canal, ganho em Q16): uma atualização custa
+// alguns microssegundos, sem ponto flutuante além da conversão da leitura.
+// Não depende de hardware.
+
+#define SENSOR_FILTER_WINDOW_MAX 5
+
+// Parâmetros de um canal, em unidades do ponto fixo
+struct SensorFilterParams {
+  int32_t scale;            // Unidades por unidade física (100 = centésimos)
+  uint32_t noise;           // Desvio padrão de uma leitura
+  uint32_t drift;           // Desvio padrão da variação real em um minuto
+};
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é sem estimativa
+struct SensorFilterChannel {
+  int32_t window[SENSOR_FILTER_WINDOW_MAX]; // Últimas leituras brutas
+  uint8_t samples;          // Leituras na janela
+  uint8_t next;             // Posição da próxima leitura na janela
+  uint8_t rejects;          // Medianas descartadas seguidas...
+  bool rejectedAbove;       // ...todas acima (ou todas abaixo) da estimativa
+  bool valid;               // Há estimativa
+  int32_t estimate;         // Estimativa filtrada
+  uint32_t variance;        // Variância da estimativa
+  time_t updated;           // Horário da última leitura
+};
+
+// Descarta a estimativa e a janela
+void sensorFilterReset(SensorFilterChannel& channel);
+
+// Acrescenta a leitura bruta feita em now (segundos) e retorna o valor filtrado em
+// unidades físicas
+float sensorFilterUpdate(SensorFilterChannel& channel, const SensorFilterParams& params,
+                         float raw, time_t now);
+
+// Estimativa atual em unidades físicas, sem leitura nova (sensor que falhou em now); NAN
+// sem estimativa ou se a última leitura tem mais de SENSOR_FILTER_HOLD_SECONDS
+float sensorFilterHeld(const SensorFilterChannel& channel, const SensorFilterParams& params,
+                       time_t now);
+
+#endif // SENSOR_FILTER_H
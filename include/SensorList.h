@@ -0,0 +1,115 @@
+#ifndef SENSOR_LIST_H
+#define SENSOR_LIST_H
+
+#include <stdint.h>
+
+// Lista dos drivers de sensor habilitados, montada na compilação. Um driver é uma struct
+// sem instâncias, só com membros estáticos:
+//   static const char* name()                 nome no log e no campo "sensor"
+//   static constexpr uint8_t quantities       SensorQuantity que o sensor fornece
+//   static constexpr uint8_t fallbackQuantities  medidas usadas só se nenhum outro driver
+//                                             da lista as fornecer (ex.: a temperatura do BMP280)
+//   static constexpr uint32_t conversionMs    latência de uma leitura
+//   static constexpr uint32_t retryMinMs      menor intervalo útil entre leituras
+//   static void begin(...)                    inicialização a cada wake
+//   static bool read(readings, quantities)    uma leitura, gravando só as grandezas pedidas
+// As chamadas são diretas (sem funções virtuais) e um driver desabilitado é um NoSensor,
+// que a lista descarta: o binário só tem código dos sensores do build.
+//
+// A lista é percorrida por visitantes com um método template <typename Driver> void
+// visit(uint8_t index), em que index é a posição do driver na lista (para estado por
+// sensor em arrays). forEach() segue a ordem da lista; forEachByLatency() lê primeiro os
+// sensores mais rápidos, para que a espera antes da nova tentativa de um sensor rápido
+// que falhou corra enquanto os lentos convertem.
+// Não depende de hardware.
+
+// Grandezas medidas pelos sensores
+enum SensorQuantity : uint8_t {
+  SENSOR_TEMPERATURE = 1 << 0,
+  SENSOR_HUMIDITY = 1 << 1,
+  SENSOR_PRESSURE = 1 << 2
+};
+
+// Driver desabilitado nos flags de compilação
+struct NoSensor {};
+
+template <typename... Drivers> struct SensorList;
+
+template <> struct SensorList<> {
+  static constexpr uint8_t count = 0;
+  static constexpr uint8_t primaryQuantities = 0;
+  static constexpr uint8_t quantities = 0;
+
+  static constexpr uint8_t faster(uint32_t, uint8_t, uint8_t) { return 0; }
+
+  template <uint8_t Index = 0, typename Visitor> static void forEach(Visitor&) {}
+  template <typename Root, uint8_t Rank, uint8_t Index, typename Visitor> static void visitRank(Visitor&) {}
+};
+
+template <typename Driver, typename... Rest> struct SensorList<Driver, Rest...> {
+  typedef SensorList<Rest...> Tail;
+
+  static constexpr uint8_t count = 1 + Tail::count;
+  static constexpr uint8_t primaryQuantities = Driver::quantities | Tail::primaryQuantities;
+  static constexpr uint8_t quantities = Driver::quantities | Driver::fallbackQuantities | Tail::quantities;
+
+  // Drivers a partir de position mais rápidos que o de latência ms na posição index
+  // (empates pela posição na lista)
+  static constexpr uint8_t faster(uint32_t ms, uint8_t index, uint8_t position) {
+    return (Driver::conversionMs < ms || (Driver::conversionMs == ms && position < index) ? 1 : 0) +
+           Tail::faster(ms, index, position + 1);
+  }
+
+  template <uint8_t Index = 0, typename Visitor> static void forEach(Visitor& visitor) {
+    visitor.template visit<Driver>(Index);
+    Tail::template forEach<Index + 1>(visitor);
+  }
+
+  // Visita o driver que ocupa Rank na ordem de latência de Root
+  template <typename Root, uint8_t Rank, uint8_t Index, typename Visitor> static void visitRank(Visitor& visitor) {
+    if (Root::faster(Driver::conversionMs, Index, 0) == Rank) {
+      visitor.template visit<Driver>(Index);
+    }
+    Tail::template visitRank<Root, Rank, Index + 1>(visitor);
+  }
+};
+
+template <typename List, uint8_t Rank = 0, bool Done = (Rank >= List::count)>
+struct SensorListByLatency {
+  template <typename Visitor> static void run(Visitor& visitor) {
+    List::template visitRank<List, Rank, 0>(visitor);
+    SensorListByLatency<List, Rank + 1>::run(visitor);
+  }
+};
+
+template <typename List, uint8_t Rank> struct SensorListByLatency<List, Rank, true> {
+  template <typename Visitor> static void run(Visitor&) {}
+};
+
+// Visita os drivers da lista do mais rápido ao mais lento
+template <typename List, typename Visitor> void forEachByLatency(Visitor& visitor) {
+  SensorListByLatency<List>::run(visitor);
+}
+
+// Grandezas que o driver grava em SensorReadings: as suas, mais as de reserva que nenhum
+// outro driver da lista fornece
+template <typename List, typename Driver> constexpr uint8_t sensorQuantities() {
+  return Driver::quantities | (Driver::fallbackQuantities & ~List::primaryQuantities);
+}
+
+// Lista sem os drivers desabilitados (NoSensor)
+template <typename List, typename... Drivers> struct SensorListFilter;
+
+template <typename... Kept> struct SensorListFilter<SensorList<Kept...>> {
+  typedef SensorList<Kept...> type;
+};
+
+template <typename... Kept, typename... Rest>
+struct SensorListFilter<SensorList<Kept...>, NoSensor, Rest...> : SensorListFilter<SensorList<Kept...>, Rest...> {};
+
+template <typename... Kept, typename Driver, typename... Rest>
+struct SensorListFilter<SensorList<Kept...>, Driver, Rest...> : SensorListFilter<SensorList<Kept..., Driver>, Rest...> {};
+
+template <typename... Drivers> struct SensorListOf : SensorListFilter<SensorList<>, Drivers...> {};
+
+#endif // SENSOR_LIST_H
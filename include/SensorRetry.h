@@ -0,0 +1,57 @@
+#ifndef SENSOR_RETRY_H
+#define SENSOR_RETRY_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Novas tentativas de leitura de um sensor sem delay(): cada sensor tem uma máquina de
+// estados consultada (sensorRetryDue) enquanto o wake faz outras coisas, como esperar
+// pelo WiFi e pelo NTP. O número de tentativas e o espaçamento entre elas vêm do
+// histórico recente do sensor, guardado na memória RTC:
+//   - a primeira nova tentativa espera o intervalo mínimo do sensor (o DHT22 só mede a
+//     cada 2 s), dobrado para cada wake recente sem leitura, e a espera dobra a cada
+//     tentativa seguinte, até SENSOR_RETRY_MAX_MS;
+//   - depois de SENSOR_DEAD_WAKES wakes seguidos sem leitura o sensor recebe uma única
+//     tentativa por wake, até voltar a responder: um sensor solto custa milissegundos.
+// Nenhuma tentativa começa depois do prazo da fase de sensores.
+// Não depende de hardware: os tempos são millis() passados pelo firmware.
+
+enum SensorRetryState : uint8_t {
+  SENSOR_RETRY_IDLE = 0,   // Primeira tentativa ainda não feita
+  SENSOR_RETRY_WAITING,    // Falhou; nova tentativa em nextAtMs
+  SENSOR_RETRY_OK,         // Leitura obtida
+  SENSOR_RETRY_FAILED      // Sem leitura neste wake (tentativas ou prazo esgotados)
+};
+
+// Histórico do sensor persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é sem histórico
+struct SensorHealth {
+  uint8_t history;         // Resultado dos últimos 8 wakes (bit 0 = mais recente; 1 = leitura obtida)
+  uint8_t samples;         // Wakes registrados em history (até 8)
+  uint8_t failStreak;      // Wakes seguidos sem leitura
+};
+
+// Tentativas do sensor no wake corrente
+struct SensorRetry {
+  SensorRetryState state;
+  uint8_t attempts;        // Tentativas feitas
+  uint8_t maxAttempts;     // Limite deste wake, pelo histórico
+  uint32_t delayMs;        // Espera antes da próxima tentativa
+  uint32_t nextAtMs;       // millis() da próxima tentativa
+  uint32_t deadlineMs;     // Nenhuma tentativa começa depois disso
+};
+
+// Prepara as tentativas do wake; minRetryMs é o menor intervalo útil entre leituras do sensor
+void sensorRetryBegin(SensorRetry& retry, const SensorHealth& health, uint32_t minRetryMs,
+                      uint32_t nowMs, uint32_t deadlineMs);
+
+// Indica se é hora de uma tentativa
+bool sensorRetryDue(const SensorRetry& retry, uint32_t nowMs);
+
+// Indica se as tentativas terminaram (com ou sem leitura)
+bool sensorRetryDone(const SensorRetry& retry);
+
+// Registra o resultado da tentativa feita em nowMs: agenda a próxima ou encerra. Ao
+// encerrar, atualiza o histórico.
+void sensorRetryResult(SensorRetry& retry, SensorHealth& health, bool ok, uint32_t nowMs);
+
+#endif // SENSOR_RETRY_H
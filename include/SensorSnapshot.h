@@ -0,0 +1,53 @@
+#ifndef SENSOR_SNAPSHOT_H
+#define SENSOR_SNAPSHOT_H
+
+#include <stdint.h>
+#include <time.h>
+#include "RainRate.h"
+
+// Leituras dos sensores e da bateria enquanto o wake ainda as adquire: a bateria no
+// início da fase de sensores e cada sensor na sua tentativa bem-sucedida, inclusive nas
+// novas tentativas que correm durante as esperas pelo WiFi e pelo NTP
+struct SensorReadings {
+  bool sensorOk;                  // Todos os sensores lidos com sucesso
+  uint8_t quantities;             // Grandezas lidas neste wake (SensorQuantity)
+  float temperature;              // °C, como veio do sensor
+  float humidity;                 // %
+  float pressureHpa;              // hPa
+  float batteryVoltage;           // V
+  uint8_t batteryLevel;           // % estimado pela tensão
+};
+
+// Leituras de um wake, montadas uma única vez quando os sensores terminaram e a chuva
+// e o horário já passaram pelo ULP e pelo NTP. Os envios (MQTT, Meshtastic, fila de
+// leituras) e o agendador recebem o snapshot como const e só o serializam, então todos
+// publicam os mesmos valores sem repetir transações I2C ou leituras do ADC. Os
+// diagnósticos do próprio wake (perfil, orçamento, decisão de sono, consumo) não são
+// leituras e continuam fora dele.
+struct SensorSnapshot {
+  time_t timestamp;               // Base de tempo no fim da aquisição
+  bool wallClock;                 // timestamp é hora de parede (já houve sincronização NTP)
+  const char* sensor;             // Sensores do build (ex.: "AHT20+BMP280")
+  bool sensorOk;                  // Todos os sensores lidos com sucesso
+  uint8_t quantities;             // Grandezas lidas neste wake (SensorQuantity)
+  float rawTemperature;           // Leituras deste wake, como vieram dos sensores
+  float rawHumidity;
+  float rawPressureHpa;
+  float temperature;              // °C, filtrada (SensorFilter); se a leitura falhou, a
+                                  // estimativa anterior (sensorFilterHeld) ou NAN
+  float humidity;                 // %, idem; NAN sem sensor de umidade
+  float pressureHpa;              // hPa, idem; NAN sem BMP280
+  float batteryVoltage;           // V
+  uint8_t batteryLevel;           // % estimado pela tensão
+  float runtimeHours;             // Autonomia projetada até o ciclo anterior; < 0 sem estimativa
+  float rain;                     // Total registrado (mm)
+  float rainLastHour;             // mm
+  float rainLast24Hours;          // mm
+  float rainLast7Days;            // mm; 0 sem relógio NTP
+  float rainLast30Days;           // mm; 0 sem relógio NTP
+  float rainMonthToDate;          // mm; 0 sem relógio NTP
+  float rainRate;                 // Intensidade instantânea (mm/h)
+  float rainPeakRates[RAIN_RATE_WINDOWS]; // Picos de 5, 15 e 60 min nas últimas 24 h (mm/h)
+};
+
+#endif // SENSOR_SNAPSHOT_H
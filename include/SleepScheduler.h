@@ -0,0 +1,68 @@
+#ifndef SLEEP_SCHEDULER_H
+#define SLEEP_SCHEDULER_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Escolha do próximo intervalo de deep sleep a partir do estado atual.
+// Não depende de hardware: recebe as leituras já feitas e pode ser exercitado
+// no host repetindo traces gravados (cada linha de telemetria traz entradas e decisão).
+
+// Motivo da decisão (enviado na telemetria como texto, ver sleepReasonName())
+enum SleepReason : uint8_t {
+  SLEEP_REASON_BASE = 0,          // Nenhuma condição especial: intervalo configurado
+  SLEEP_REASON_RAIN,              // Chuva ativa: intervalo mínimo
+  SLEEP_REASON_PRESSURE,          // Pressão variando rápido: intervalo reduzido
+  SLEEP_REASON_STABLE,            // Condições estáveis: intervalo crescendo até o máximo
+  SLEEP_REASON_BATTERY_LOW,       // Bateria baixa: intervalo dobrado
+  SLEEP_REASON_BATTERY_CRITICAL   // Bateria crítica: intervalo máximo
+};
+
+// Parâmetros da política
+struct SleepSchedulerConfig {
+  uint16_t baseMinutes;           // Intervalo padrão (deepSleepTimeMinutes)
+  uint16_t minMinutes;            // Menor intervalo permitido
+  uint16_t maxMinutes;            // Maior intervalo permitido
+  float lowBatteryVoltage;
+  float criticalBatteryVoltage;
+  float fastPressureHpaPerHour;   // |dP/dt| a partir do qual a pressão é considerada em mudança rápida
+  float stablePressureHpaPerHour; // |dP/dt| abaixo do qual a pressão é considerada estável
+};
+
+// Leituras do ciclo atual
+struct SleepSchedulerInputs {
+  time_t now;                     // Timestamp atual (s)
+  float rainLastHourMm;
+  float pressureHpa;              // NAN quando não há sensor de pressão
+  float batteryVoltage;
+};
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware)
+struct SleepSchedulerState {
+  bool valid;
+  float lastPressureHpa;
+  time_t lastPressureTime;
+  float pressureTrend;            // hPa/h, suavizado
+  uint16_t lastMinutes;           // Último intervalo escolhido
+};
+
+struct SleepDecision {
+  uint16_t minutes;
+  SleepReason reason;
+  float pressureTrend;            // hPa/h usado na decisão (NAN se desconhecido)
+};
+
+// Calcula o próximo intervalo e atualiza o estado
+SleepDecision scheduleNextWake(const SleepSchedulerConfig& config, SleepSchedulerState& state,
+                               const SleepSchedulerInputs& inputs);
+
+const char* sleepReasonName(SleepReason reason);
+
+// Hora (UTC) do próximo wake alinhado ao relógio de parede: o ponto da grade mais próximo
+// de now + minutes, nunca a menos de minLeadSeconds de now. A grade é o maior divisor
+// comum entre o intervalo e uma hora (:00, :05, :10... para 5 min; :00, :30 para 30 min),
+// então estações com o mesmo intervalo amostram nos mesmos instantes e o tempo acordado
+// não se acumula de um ciclo para o outro.
+time_t sleepAlignedWake(time_t now, uint16_t minutes, uint16_t minLeadSeconds);
+
+#endif // SLEEP_SCHEDULER_H
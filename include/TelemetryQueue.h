@@ -0,0 +1,98 @@
+#ifndef TELEMETRY_QUEUE_H
+#define TELEMETRY_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Fila de leituras que não puderam ser enviadas (WiFi, broker ou nó Meshtastic fora do
+// ar), para reenvio na próxima conexão bem-sucedida.
+//
+// As leituras ficam primeiro em TelemetryQueue (memória RTC, TELEMETRY_QUEUE_FRAMES
+// quadros). Quando ela enche, todos os quadros passam de uma vez para TelemetrySpill, um
+// anel de TELEMETRY_SPILL_FRAMES quadros gravado no flash, que sobrevive também à perda
+// de energia. Com o anel cheio a leitura mais antiga é descartada.
+// A ordem de envio é sempre da mais antiga para a mais recente: primeiro as do flash,
+// depois as da memória RTC. O envio é feito em lotes de vários quadros por mensagem, na
+// mesma conexão do envio principal.
+// Não depende de hardware (ver tools/telemetry_queue_bench.cpp).
+
+// Valores de um sensor sem leitura nem estimativa recente no quadro
+#define TELEMETRY_NO_TEMPERATURE INT16_MIN
+#define TELEMETRY_NO_HUMIDITY UINT16_MAX
+#define TELEMETRY_NO_PRESSURE 0
+
+// TelemetryFrame::flags
+#define TELEMETRY_FRAME_UNSYNCED 0x01  // timestamp é a base de tempo sem âncora NTP
+
+// Uma leitura em ponto fixo (24 bytes)
+struct TelemetryFrame {
+  uint32_t timestamp;    // Unix; com TELEMETRY_FRAME_UNSYNCED, segundos desde o power-on
+  int16_t temperature;   // Centésimos de °C (TELEMETRY_NO_TEMPERATURE = sem leitura)
+  uint16_t humidity;     // Centésimos de % (TELEMETRY_NO_HUMIDITY = sem leitura)
+  uint16_t pressure;     // Décimos de hPa (TELEMETRY_NO_PRESSURE = sem leitura ou sem sensor)
+  uint16_t voltage;      // Tensão da bateria (mV)
+  uint32_t rain;         // Chuva total registrada (centésimos de mm)
+  uint16_t rain1h;       // Chuva na última hora (décimos de mm)
+  uint16_t rain24h;      // Chuva nas últimas 24 horas (décimos de mm)
+  uint8_t flags;         // TELEMETRY_FRAME_*
+};
+
+// Estado persistido entre wakes (RTC_DATA_ATTR no firmware); zerado é fila vazia
+struct TelemetryQueue {
+  uint8_t count;                                  // Quadros na memória RTC
+  uint16_t spilled;                               // Quadros no flash (cópia de TelemetrySpill::count)
+  uint32_t dropped;                               // Leituras descartadas com a fila cheia
+  TelemetryFrame frames[TELEMETRY_QUEUE_FRAMES];  // Do mais antigo para o mais recente
+};
+
+// Anel gravado no flash, validado por magic, dimensão e CRC
+struct TelemetrySpill {
+  uint32_t magic;
+  uint16_t head;                                  // Posição do quadro mais antigo
+  uint16_t count;
+  TelemetryFrame frames[TELEMETRY_SPILL_FRAMES];
+  uint32_t crc;                                   // CRC-32 dos campos anteriores
+};
+
+void telemetryQueueReset(TelemetryQueue& queue);
+void telemetrySpillReset(TelemetrySpill& spill);
+
+// Quadros aguardando envio (memória RTC e flash)
+uint32_t telemetryQueuePending(const TelemetryQueue& queue);
+
+// Indica se a memória RTC está cheia (o próximo quadro exige telemetryQueueSpill())
+bool telemetryQueueFull(const TelemetryQueue& queue);
+
+// Acrescenta uma leitura; com a memória RTC cheia descarta a mais antiga dela
+void telemetryQueuePush(TelemetryQueue& queue, const TelemetryFrame& frame);
+
+// Passa todos os quadros da memória RTC para o anel do flash (descartando os mais antigos
+// do anel se preciso). Retorna quantos quadros foram descartados.
+uint16_t telemetryQueueSpill(TelemetryQueue& queue, TelemetrySpill& spill);
+
+// i-ésimo quadro pendente, do mais antigo (i = 0) para o mais recente; o anel do flash
+// só é consultado se queue.spilled > 0
+const TelemetryFrame* telemetryQueueAt(const TelemetryQueue& queue, const TelemetrySpill& spill, uint32_t i);
+
+// Remove os count quadros mais antigos (depois de enviados)
+void telemetryQueueDrop(TelemetryQueue& queue, TelemetrySpill& spill, uint32_t count);
+
+// Primeira sincronização NTP: passa os quadros com TELEMETRY_FRAME_UNSYNCED para hora de
+// parede, somando offsetSeconds (hora NTP menos a base sem âncora no mesmo instante).
+// Retorna quantos quadros do anel do flash mudaram (o anel precisa ser regravado); o anel
+// só é percorrido se queue.spilled > 0
+uint32_t telemetryQueueRebase(TelemetryQueue& queue, TelemetrySpill& spill, int64_t offsetSeconds);
+
+// Relógio do sistema recomeçado (power-on): descarta do anel do flash os quadros com
+// TELEMETRY_FRAME_UNSYNCED, que não têm mais como ser acertados, mantendo a ordem dos
+// demais. Retorna quantos foram descartados (somados a queue.dropped)
+uint32_t telemetrySpillDropUnsynced(TelemetryQueue& queue, TelemetrySpill& spill);
+
+// Cópia em flash: telemetrySpillSeal() calcula o CRC antes da gravação e
+// telemetrySpillValid() rejeita cópias inválidas depois da leitura (a dimensão é
+// conferida pelo tamanho do arquivo)
+void telemetrySpillSeal(TelemetrySpill& spill);
+bool telemetrySpillValid(const TelemetrySpill& spill);
+
+#endif // TELEMETRY_QUEUE_H
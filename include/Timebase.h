@@ -0,0 +1,65 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "config.h"
+
+// Base de tempo única para todos os registros, em qualquer wake, com ou sem rádio.
+//
+// A fonte é o relógio do sistema, mantido pelo RTC durante o deep sleep e o restart: ao
+// contrário de millis(), ele não recomeça a cada wake. Acordado o relógio vem do cristal;
+// só durante o sono ele depende do oscilador lento do RTC, que adianta ou atrasa algumas
+// centenas de ppm. Cada sincronização NTP ancora a base (hora NTP e relógio do sistema no
+// mesmo instante) e mede o desvio do oscilador sobre o tempo dormido desde a âncora
+// anterior; esse desvio, suavizado entre sincronizações, é descontado do tempo dormido
+// desde a âncora.
+// Sem âncora (power-on sem NTP) a base é o próprio relógio, em segundos desde o
+// power-on: monotônica entre wakes, mas não é hora de parede.
+// Não depende de hardware (ver tools/timebase_bench.cpp).
+
+// Estado persistido entre wakes e restarts (RTC_NOINIT_ATTR no firmware), validado pelo
+// magic e zerado no power-on, quando o relógio do sistema recomeça
+struct Timebase {
+  uint32_t magic;
+  int64_t anchorClockUs;   // Relógio do sistema logo após a última sincronização
+  int64_t anchorEpochUs;   // Hora NTP (UTC) nesse instante; 0 = sem âncora
+  int64_t sleptClockUs;    // Tempo dormido desde a âncora (no relógio do sistema)
+  int64_t sleepStartClockUs; // Relógio do sistema ao entrar no deep sleep; 0 = acordado
+  int32_t driftPpb;        // Desvio do oscilador no sono (partes por bilhão; positivo = adianta)
+  int64_t unsyncedOffsetUs; // Hora NTP menos a base sem âncora, na primeira sincronização:
+                           // acerta registros feitos antes dela
+  uint16_t syncs;          // Sincronizações desde o power-on
+  uint16_t driftSamples;   // Sincronizações usadas na medida do desvio
+};
+
+void timebaseReset(Timebase& timebase);
+
+// Indica se o estado foi inicializado por timebaseReset()
+bool timebaseValid(const Timebase& timebase);
+
+// Indica se já houve uma sincronização NTP (a base é hora de parede)
+bool timebaseSynced(const Timebase& timebase);
+
+// Início e fim de um deep sleep (o fim é ignorado se não houve início: power-on, restart)
+void timebaseSleep(Timebase& timebase, int64_t clockUs);
+void timebaseWake(Timebase& timebase, int64_t clockUs);
+
+// Hora atual (UTC, us) para o relógio do sistema em clockUs
+int64_t timebaseNowUs(const Timebase& timebase, int64_t clockUs);
+
+// Hora atual (UTC, s) para o relógio do sistema em clockUs
+time_t timebaseNow(const Timebase& timebase, int64_t clockUs);
+
+// Timer de deep sleep (us no relógio do sistema) para acordar na hora wakeEpochUs. O timer
+// conta no mesmo oscilador RTC que o relógio durante o sono, então recebe o mesmo desvio;
+// 0 se a hora já passou.
+int64_t timebaseSleepUs(const Timebase& timebase, int64_t clockUs, int64_t wakeEpochUs);
+
+// Sincronização NTP: clockBeforeUs é o relógio do sistema imediatamente antes do ajuste,
+// clockAfterUs logo depois e epochUs a hora NTP no mesmo instante. Atualiza o desvio se
+// houve pelo menos TIMEBASE_MIN_DRIFT_SLEEP_MINUTES de sono desde a âncora anterior e
+// reancora a base. Na primeira sincronização guarda unsyncedOffsetUs.
+void timebaseSync(Timebase& timebase, int64_t clockBeforeUs, int64_t clockAfterUs, int64_t epochUs);
+
+#endif // TIMEBASE_H
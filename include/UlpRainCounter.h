@@ -0,0 +1,99 @@
+#ifndef ULP_RAIN_COUNTER_H
+#define ULP_RAIN_COUNTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include "config.h"
+
+// Níveis do Arduino para RAIN_GAUGE_WAKE_LEVEL quando o modelo é usado no host
+// (mesmos valores do core, então a redefinição no dispositivo é idêntica)
+#ifndef HIGH
+  #define LOW  0x0
+  #define HIGH 0x1
+#endif
+
+// Contador de basculadas executado pelo coprocessador ULP durante o deep sleep.
+//
+// O programa ULP amostra o pino do pluviômetro a cada ULP_RAIN_SAMPLE_PERIOD_US,
+// aplica debounce de ULP_RAIN_DEBOUNCE_SAMPLES amostras, conta as bordas para o
+// nível de wake e distribui as basculadas em bins de um minuto. As CPUs só acordam
+// pelo timer; a cada ciclo o firmware "colhe" os contadores e gera os registros de chuva.
+//
+// Todos os valores ficam na área de memória RTC reservada ao ULP
+// (CONFIG_ULP_COPROC_RESERVE_MEM), inclusive a referência da última colheita, para que
+// contadores e referência sejam sempre zerados juntos. Essa área não é reinicializada
+// pelo bootloader, ao contrário das variáveis RTC_DATA_ATTR.
+// O ULP só grava os 16 bits inferiores de cada palavra.
+
+// Layout da memória do ULP (em palavras de 32 bits a partir de RTC_SLOW_MEM)
+#define ULP_RAIN_PROGRAM_WORDS 48                       // Espaço reservado para o programa
+#define ULP_RAIN_VAR_MAGIC     (ULP_RAIN_PROGRAM_WORDS + 0) // Escrito só pela CPU principal
+#define ULP_RAIN_VAR_TOTAL     (ULP_RAIN_PROGRAM_WORDS + 1) // Total de basculadas (16 bits, circular)
+#define ULP_RAIN_VAR_LEVEL     (ULP_RAIN_PROGRAM_WORDS + 2) // Último nível estável do pino
+#define ULP_RAIN_VAR_COUNT     (ULP_RAIN_PROGRAM_WORDS + 3) // Amostras consecutivas diferentes do nível estável
+#define ULP_RAIN_VAR_TICKS     (ULP_RAIN_PROGRAM_WORDS + 4) // Amostras dentro do minuto corrente
+#define ULP_RAIN_VAR_MINUTE    (ULP_RAIN_PROGRAM_WORDS + 5) // Índice do minuto corrente (16 bits, circular)
+#define ULP_RAIN_VAR_LAST_TOTAL  (ULP_RAIN_PROGRAM_WORDS + 6) // Total na última colheita (CPU)
+#define ULP_RAIN_VAR_LAST_MINUTE (ULP_RAIN_PROGRAM_WORDS + 7) // Minuto na última colheita (CPU)
+#define ULP_RAIN_VAR_LAST_BIN    (ULP_RAIN_PROGRAM_WORDS + 8) // Valor já colhido do bin de LAST_MINUTE (CPU)
+#define ULP_RAIN_VAR_BINS      (ULP_RAIN_PROGRAM_WORDS + 9) // ULP_RAIN_BINS contadores por minuto
+#define ULP_RAIN_MEMORY_WORDS  (ULP_RAIN_VAR_BINS + ULP_RAIN_BINS)
+
+#define ULP_RAIN_MAGIC 0x52A1UL
+#define ULP_RAIN_TICKS_PER_MINUTE (60000000UL / ULP_RAIN_SAMPLE_PERIOD_US)
+
+#if ULP_RAIN_MEMORY_WORDS * 4 > 512
+  #error "Memória do contador ULP excede CONFIG_ULP_COPROC_RESERVE_MEM (512 bytes)"
+#endif
+#if (ULP_RAIN_BINS & (ULP_RAIN_BINS - 1)) != 0
+  #error "ULP_RAIN_BINS precisa ser potência de 2"
+#endif
+#if ULP_RAIN_TICKS_PER_MINUTE > 0xFFFF
+  #error "ULP_RAIN_SAMPLE_PERIOD_US muito curto para o contador de 16 bits do ULP"
+#endif
+
+// Recebe cada basculada colhida com o timestamp estimado do seu minuto
+typedef void (*UlpRainTipCallback)(time_t timestamp);
+
+// Converte os contadores do ULP em basculadas com timestamp. Funciona sobre qualquer
+// imagem da memória do ULP (RTC_SLOW_MEM no dispositivo ou UlpRainCounterSim no host).
+// Retorna o número de basculadas novas desde a colheita anterior.
+uint16_t ulpRainHarvest(volatile uint32_t* mem, time_t now, UlpRainTipCallback onTip);
+
+// Modelo da máquina de estados do programa ULP, instrução a instrução equivalente,
+// para exercitar a contagem, o debounce e os bins fora do dispositivo
+class UlpRainCounterSim {
+public:
+  UlpRainCounterSim();
+
+  // Equivale a ulpRainCounter.begin() em um boot a frio
+  void reset(uint8_t initialLevel);
+
+  // Uma execução do programa ULP com o nível lido do pino
+  void run(uint8_t level);
+
+  uint32_t memory[ULP_RAIN_MEMORY_WORDS];
+};
+
+#ifdef USE_ULP_RAIN_COUNTER
+
+class UlpRainCounter {
+public:
+  // Carrega o programa e inicia o timer do ULP (chamado por setupDeepSleep()).
+  // Os contadores só são zerados quando a memória RTC não os contém (boot a frio).
+  void start();
+
+  // Colhe as basculadas contadas desde a última chamada; o ULP é pausado durante
+  // a leitura para que total e bins fiquem consistentes
+  uint16_t harvest(time_t now, UlpRainTipCallback onTip);
+
+private:
+  bool isLoaded();
+};
+
+extern UlpRainCounter ulpRainCounter;
+
+#endif // USE_ULP_RAIN_COUNTER
+
+#endif // ULP_RAIN_COUNTER_H
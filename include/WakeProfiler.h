@@ -0,0 +1,77 @@
+#ifndef WAKE_PROFILER_H
+#define WAKE_PROFILER_H
+
+#include <Arduino.h>
+#include "config.h"
+
+// Fases de um ciclo de wake, na ordem em que ocorrem em setup()
+// A ordem é parte do formato de telemetria ("prof") - só adicione novas fases no final
+enum WakePhase : uint8_t {
+  PHASE_BOOT = 0,     // Bootloader até a entrada em setup()
+  PHASE_CONFIG,       // Serial, ADC e configManager.begin()
+  PHASE_WIFI,         // Espera pela associação WiFi/DHCP iniciada em segundo plano
+  PHASE_NTP,          // Espera pela sincronização NTP iniciada em segundo plano
+  PHASE_SENSORS,      // Sensores e histórico de chuva (em paralelo com a associação WiFi)
+  PHASE_SEND,         // Envio via MQTT/Meshtastic
+  PHASE_SLEEP,        // Configuração do deep sleep
+  PHASE_COUNT
+};
+
+// Duração de cada fase de um único ciclo de wake
+struct WakeProfile {
+  uint32_t phaseUs[PHASE_COUNT];  // Tempo gasto em cada fase (microssegundos)
+  uint32_t totalUs;               // Tempo total acordado (microssegundos)
+  uint8_t wakeReason;             // Causa do wake (TIMER_WAKEUP, EXTERNAL_WAKEUP...)
+};
+
+// Buffer circular dos últimos ciclos, mantido em memória RTC
+struct WakeProfileLog {
+  uint32_t cycles;                              // Total de ciclos registrados desde o power-on
+  uint8_t head;                                 // Próxima posição de escrita
+  uint8_t count;                                // Número de entradas válidas
+  WakeProfile entries[WAKE_PROFILE_HISTORY];
+};
+
+class WakeProfiler {
+public:
+  WakeProfiler();
+
+  // Inicia o perfil do ciclo atual; o tempo desde o boot é atribuído a PHASE_BOOT
+  void begin();
+
+  // Registra a causa do wake assim que ela for conhecida
+  void setWakeReason(uint8_t wakeReason);
+
+  // Encerra a fase corrente e inicia a fase indicada
+  void enter(WakePhase phase);
+
+  // Encerra o ciclo e grava o perfil no buffer RTC (chamar antes de esp_deep_sleep_start)
+  void finish();
+
+  // Perfil do ciclo anterior, ou nullptr se ainda não houver nenhum
+  const WakeProfile* previous() const;
+
+  // Fase corrente (PHASE_BOOT antes de begin(), PHASE_SLEEP depois de finish())
+  WakePhase phase() const { return _phase; }
+
+  // Acesso ao histórico (0 = mais recente)
+  uint8_t historyCount() const;
+  const WakeProfile* history(uint8_t age) const;
+
+  // Imprime o histórico completo na serial
+  void printHistory() const;
+
+  static const char* phaseName(WakePhase phase);
+
+private:
+  WakeProfile _current;
+  WakePhase _phase;
+  int64_t _phaseStartUs;
+  bool _active;
+  WakeProfile _previous;  // Cópia do ciclo anterior, feita em begin()
+  bool _hasPrevious;
+};
+
+extern WakeProfiler wakeProfiler;
+
+#endif // WAKE_PROFILER_H
@@ -5,11 +5,37 @@
 #define DEFAULT_DEEP_SLEEP_TIME_MINUTES 5    // Deep sleep duration in minutes
 #define DEFAULT_CPU_FREQ_MHZ 160             // CPU frequency in MHz (80 or 160 for ESP32)
 #define DEFAULT_RAIN_MM_PER_TIP 0.25         // Rain gauge produces 0.25mm per tip/interrupt
+#define DEFAULT_RAIN_FLUSH_TIPS 20           // Basculadas acumuladas sem rádio antes de forçar um envio
+#define DEFAULT_RAIN_FLUSH_MINUTES 15        // Atraso máximo (min) para transmitir uma basculada
+#define DEFAULT_RAIN_EVENT_DRY_MINUTES 60    // Pausa seca (min) que encerra um evento de chuva
+#define DEFAULT_SLEEP_MIN_MINUTES 2          // Intervalo mínimo do agendador adaptativo (chuva ativa)
+#define DEFAULT_SLEEP_MAX_MINUTES 30         // Intervalo máximo do agendador adaptativo (tempo estável)
+#define DEFAULT_BMP280_PROFILE 2             // Oversampling do BMP280 (0 = ultra low power ... 4 = ultra high resolution)
+
+// Agendador adaptativo de deep sleep
+#define SLEEP_LOW_BATTERY_VOLTAGE 3.5        // Abaixo disso o intervalo é dobrado
+#define SLEEP_CRITICAL_BATTERY_VOLTAGE 3.3   // Abaixo disso usa sempre o intervalo máximo
+#define SLEEP_FAST_PRESSURE_HPA_H 1.0        // Variação de pressão considerada rápida (hPa/h)
+#define SLEEP_STABLE_PRESSURE_HPA_H 0.3      // Variação de pressão considerada estável (hPa/h)
+#define SLEEP_ALIGN_MIN_SECONDS 60           // Sono mínimo ao alinhar o wake ao relógio de parede
 
 // Configurações para histórico de precipitação
-#define MAX_RAIN_RECORDS 288                 // Registros para 24 horas (suponha um registro a cada 5 minutos)
+#define RAIN_BIN_MINUTES 5                   // Largura de cada intervalo do histórico (divisor de 60)
+#define RAIN_HISTORY_BINS 288                // Intervalos para 24 horas (24 * 60 / RAIN_BIN_MINUTES)
 #define HOUR_MILLIS 3600000UL                // Milissegundos em uma hora
 #define DAY_MILLIS 86400000UL                // Milissegundos em um dia (24 horas)
+#define RAIN_ROLLUP_HOURS 169                // Horas guardadas (7 dias + a hora corrente)
+#define RAIN_ROLLUP_DAYS 32                  // Dias guardados (30 dias e o mês corrente)
+#define RAIN_ROLLUP_MONTHS 13                // Meses guardados (um ano + o mês corrente)
+#define RAIN_CHECKPOINT_HOURS 6              // Intervalo mínimo entre cópias do acumulado no flash
+#define RAIN_CHECKPOINT_FILE "/rain_rollup.bin"
+#define RAIN_LOG_PARTITION "rainlog"         // Partição do log de chuva em flash (partitions.csv)
+#define RAIN_LOG_PENDING_RECORDS 32          // Intervalos com chuva aguardando gravação (memória RTC)
+#define RAIN_LOG_MAX_DELAY_MINUTES 60        // Atraso máximo para gravar uma basculada no log
+#define RAIN_RATE_TIPS 8                     // Basculadas guardadas para a intensidade instantânea
+#define RAIN_RATE_MIN_SPAN_SECONDS 60        // Menor intervalo medido (resolução do contador ULP)
+#define RAIN_RATE_TIMEOUT_MINUTES 60         // Sem basculadas por este tempo a intensidade é zero
+#define RAIN_EVENT_TABLE_SIZE 4              // Eventos de chuva encerrados aguardando publicação
 #define DEFAULT_WIFI_SSID "your_wifi_ssid"        // WiFi SSID
 #define DEFAULT_WIFI_PASSWORD "your_wifi_password" // WiFi password
 #define DEFAULT_DEVICE_NAME "ESP32-Weather"        // Nome do dispositivo para BLE
@@ -33,20 +59,86 @@
 #define NTP_TIMEZONE -3                         // Fuso horário em horas (exemplo: -3 para Brasília)
 #define NTP_SYNC_INTERVAL 3600000               // Intervalo de sincronização em ms (1 hora)
 
+// Base de tempo (Timebase): desvio do relógio RTC aprendido entre sincronizações NTP
+#define TIMEBASE_MIN_DRIFT_SLEEP_MINUTES 30     // Menor tempo de sono entre sincronizações para medir o desvio
+#define TIMEBASE_MAX_DRIFT_PPM 2000             // Medidas acima disso são descartadas (relógio ajustado por fora)
+#define TIMEBASE_DRIFT_SMOOTHING 4              // Peso 1/N de cada nova medida na média do desvio
+
 // Configurações fixas do sistema
 #define MAX_RUNTIME_MS 30000         // Maximum runtime before forced sleep (30 seconds)
 #define uS_TO_MIN_FACTOR 60000000ULL // Conversion factor: microseconds to minutes
 #define WIFI_TIMEOUT 20000           // WiFi connection timeout in milliseconds
+#define WIFI_FAST_CONNECT_TIMEOUT 3000 // Tempo (ms) para a conexão rápida antes de voltar à varredura completa
+#define MQTT_BUFFER_SIZE 768         // Buffer do PubSubClient (tópico + payload)
 #define MESHTASTIC_API_ENDPOINT "/api/v1/toradio"  // Endpoint for sending messages to radio
 #define CONFIG_AP_PASSWORD "weatherconfig"  // Senha do ponto de acesso no modo configuração
 #define CONFIG_PORTAL_TIMEOUT 180    // Tempo limite (em segundos) do portal de configuração
+#define WAKE_PROFILE_HISTORY 8       // Número de ciclos de wake mantidos no perfil em memória RTC
+
+// Orçamento de tempo por fase, sempre limitado pelo que resta de MAX_RUNTIME_MS
+#define BUDGET_SENSORS_MS 5000       // Inicialização e leitura dos sensores
+#define BUDGET_WIFI_MS WIFI_TIMEOUT  // Associação WiFi/DHCP, contada desde setupWiFi()
+#define BUDGET_NTP_MS 5000           // Espera pela sincronização NTP
+#define BUDGET_SEND_MS 10000         // Conexão e envio MQTT/Meshtastic
+#define BUDGET_SLEEP_RESERVE_MS 500  // Reservado no fim do orçamento para configurar o deep sleep
+#define BUDGET_MIN_SEND_MS 1000      // Abaixo disso o envio nem é tentado
+#define BUDGET_OVERRUN_TOLERANCE_MS 100 // Atraso tolerado antes de contar um estouro de prazo
+
+// Novas tentativas de leitura dos sensores (SensorRetry), sem bloquear o wake
+#define SENSOR_MAX_ATTEMPTS 3        // Tentativas por wake de um sensor que tem respondido
+#define SENSOR_RETRY_MAX_MS 2000     // Maior espera entre tentativas
+#define SENSOR_DEAD_WAKES 3          // Wakes seguidos sem leitura até restar uma tentativa por wake
+#define SENSOR_POLL_MS 10            // Intervalo de consulta das esperas enquanto há tentativas pendentes
+
+// Filtro das leituras entre wakes (SensorFilter), em ponto fixo
+#define SENSOR_FILTER_WINDOW 3       // Leituras brutas na mediana (ímpar, até SENSOR_FILTER_WINDOW_MAX)
+#define SENSOR_FILTER_WINDOW_GAP_SECONDS 360 // Wakes mais espaçados que isso não entram na mesma mediana
+#define SENSOR_FILTER_GATE_SIGMA 4   // Mediana a mais que isso em desvios da estimativa é descartada
+#define SENSOR_FILTER_MAX_REJECTS 3  // Descartes seguidos até aceitar a leitura como mudança real
+#define SENSOR_FILTER_HOLD_SECONDS 3600 // Idade máxima da estimativa publicada quando a leitura falha
+// Por canal: desvio de uma leitura e variação esperada por √min, em unidades do ponto fixo
+#define SENSOR_FILTER_TEMPERATURE_NOISE 15   // 0,15 °C (centésimos de °C)
+#define SENSOR_FILTER_TEMPERATURE_DRIFT 15   // 0,15 °C/√min
+#define SENSOR_FILTER_HUMIDITY_NOISE 50      // 0,5 % (centésimos de %)
+#define SENSOR_FILTER_HUMIDITY_DRIFT 60      // 0,6 %/√min
+#define SENSOR_FILTER_PRESSURE_NOISE 20      // 2 Pa (milésimos de hPa)
+#define SENSOR_FILTER_PRESSURE_DRIFT 150     // 15 Pa/√min
+
+// Fila de leituras não enviadas (TelemetryQueue)
+#define TELEMETRY_QUEUE_FRAMES 12            // Leituras na memória RTC antes de passar para o flash
+#define TELEMETRY_SPILL_FRAMES 288           // Leituras guardadas no flash (24 h a cada 5 min)
+#define TELEMETRY_SPILL_FILE "/telemetry_queue.bin"
+#define TELEMETRY_DRAIN_MAX_BATCHES 8        // Lotes da fila enviados por conexão
+
+// Modelo de corrente (mA) para a estimativa de consumo por ciclo (EnergyModel)
+#define ENERGY_DEEP_SLEEP_MA 0.15    // Deep sleep com ULP e periféricos RTC ligados, incluindo a placa
+#define ENERGY_CPU_BASE_MA 20.0      // CPU ativa: parte fixa...
+#define ENERGY_CPU_MA_PER_MHZ 0.125  // ...mais esta por MHz (~30 mA a 80 MHz, ~40 mA a 160 MHz)
+#define ENERGY_WIFI_RX_MA 95.0       // WiFi recebendo/escutando, além da CPU
+#define ENERGY_WIFI_TX_MA 180.0      // WiFi transmitindo, além da CPU
+#define ENERGY_WIFI_TX_DUTY 0.15     // Fração do tempo com WiFi ligado em transmissão
+#define ENERGY_BLE_MA 30.0           // BLE ativo (modo de configuração), além da CPU
+#define BATTERY_CAPACITY_MAH 2000    // Capacidade da bateria usada na autonomia projetada
 
 // Rain gauge configuration (interrupt)
 #define RAIN_GAUGE_INTERRUPT_PIN GPIO_NUM_27 // Pin connected to rain gauge interrupt
+#define RAIN_GAUGE_WAKE_LEVEL HIGH           // Nível do pino que indica uma basculada (wake ext0)
+#define RAIN_TIP_RELEASE_TIMEOUT_MS 250      // Espera máxima pela liberação do contato antes de dormir
+
+// Contador de basculadas no coprocessador ULP (build flag USE_ULP_RAIN_COUNTER)
+#define ULP_RAIN_SAMPLE_PERIOD_US 5000       // Intervalo entre amostras do pino pelo ULP
+#define ULP_RAIN_DEBOUNCE_SAMPLES 4          // Amostras estáveis para aceitar uma mudança de nível (20 ms)
+#define ULP_RAIN_BINS 32                     // Bins de um minuto (potência de 2); resolução total entre colheitas de até 31 min
+// Maior intervalo de sono com o contador ULP (limita sleep_max e o intervalo configurado).
+// Só os wakes por timer colhem os bins, então de uma colheita à outra não podem passar mais
+// de ULP_RAIN_BINS - 1 minutos: o wake alinhado ao relógio cai até meia grade depois do
+// intervalo (28 min: grade de 4, até 30 min) e ainda há o tempo acordado
+#define ULP_RAIN_MAX_SLEEP_MINUTES 28
 
 // DHT22 pin definition
 #ifdef USE_DHT22
     #define DHT_PIN 4                  // DHT22 data pin
+    #define DHT_RETRY_MIN_MS 2000      // O DHT22 só faz uma nova medida a cada 2 s
 #endif
 
 // I2C pin definitions (for AHT20 and BMP280)
@@ -55,8 +147,13 @@
     #define I2C_SCL_PIN 22             // I2C SCL pin
 #endif
 
+#ifdef USE_AHT20
+    #define AHT20_RETRY_MIN_MS 100     // Espera mínima antes de repetir uma medida do AHT20
+#endif
+
 #ifdef USE_BMP280
     #define BMP280_ADDRESS 0x76        // Default BMP280 I2C address (some modules use 0x77)
+    #define BMP280_RETRY_MIN_MS 50     // Espera mínima antes de repetir uma leitura do BMP280
 #endif
 
 // Configuração BLE
@@ -67,8 +164,14 @@
 #define CONFIG_BUTTON_PIN GPIO_NUM_0  // Botão BOOT do ESP32 para entrar no modo de configuração
 #define BATTERY_ADC_PIN 35     // Pino ADC para medição de tensão da bateria
 
-// Debug configuration
-#define DEBUG_ENABLED true     // Enable/disable debug output
+// Configuração de log (ver Log.h). Mensagens acima de LOG_LEVEL são removidas na
+// compilação; use -DLOG_LEVEL=0 nas unidades de campo para não gastar nada com log
+#ifndef LOG_LEVEL
+  #define LOG_LEVEL 3            // 0 = nenhum, 1 = erro, 2 = aviso, 3 = info, 4 = debug
+#endif
+#define LOG_BUFFER_SIZE 1024     // Bytes do buffer circular de log em memória RTC
+#define LOG_LINE_MAX 160         // Tamanho máximo de uma mensagem formatada
+#define LOG_HOST_DETECT_PIN 3    // RX da UART0: nível alto quando o conversor USB-serial está alimentado (-1 = sempre enviar)
 
 // Meshtastic specific constants
 #define BROADCAST_ADDR 0xffffffff  // Broadcast address for Meshtastic nodes
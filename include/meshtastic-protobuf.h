@@ -5,6 +5,7 @@
 #include <pb_encode.h>
 #include <pb_decode.h>
 #include <ArduinoJson.h>
+#include "Log.h"
 
 // Definições chave do Meshtastic
 #define BROADCAST_ADDR 0xffffffff
@@ -135,9 +136,7 @@ String createMeshtasticToRadioJson(const MeshPacket& packet) {
   String jsonOutput;
   serializeJson(toRadioDoc, jsonOutput);
   
-  // Depuração
-  Serial.print("Pacote convertido para JSON: ");
-  Serial.println(jsonOutput);
+  LOG_D("Pacote convertido para JSON: %s", jsonOutput.c_str());
   
   return jsonOutput;
 }
@@ -160,7 +159,7 @@ MeshPacket createWeatherDataPacket(const String& jsonData, uint32_t nodeNum) {
     packet.payload.data[sizeof(packet.payload.data) - 1] = '\0';
     packet.payload.size = jsonData.length();
   } else {
-    Serial.println("AVISO: Dados muito grandes para o payload, truncando!");
+    LOG_W("Dados muito grandes para o payload, truncando!");
     strncpy(packet.payload.data, jsonData.c_str(), sizeof(packet.payload.data) - 1);
     packet.payload.data[sizeof(packet.payload.data) - 1] = '\0';
     packet.payload.size = sizeof(packet.payload.data) - 1;
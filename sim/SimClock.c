@@ -0,0 +1,24 @@
+// Relógio do sistema do dispositivo simulado. time() e gettimeofday() substituem os
+// da libc no executável, de modo que o firmware, localtime_r() e o SNTP simulado
+// vejam o relógio virtual (inclusive o erro acumulado no deep sleep).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/time.h>
+
+int64_t simSystemClockUs(void);
+
+time_t time(time_t* out) {
+  time_t now = (time_t)(simSystemClockUs() / 1000000);
+  if (out) *out = now;
+  return now;
+}
+
+int gettimeofday(struct timeval* tv, void* tz) {
+  (void)tz;
+  int64_t us = simSystemClockUs();
+  tv->tv_sec = (time_t)(us / 1000000);
+  tv->tv_usec = (suseconds_t)(us % 1000000);
+  return 0;
+}
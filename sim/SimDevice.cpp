@@ -0,0 +1,275 @@
+#include <Arduino.h>
+#include <driver/rtc_io.h>
+#include "SimDevice.h"
+#include "SimWorld.h"
+#include "config.h"
+#include "WakeProfiler.h"
+#include "Timebase.h"
+
+// Custo de cada leitura do relógio; garante que laços de espera ativa avancem
+#define SIM_CLOCK_READ_COST_US 1
+
+SimShared* simShared = nullptr;
+const char* simFsRoot = ".";
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static int64_t nowUs = 0;
+static int64_t clockOffsetUs = 0;
+static uint32_t cpuMHz = 240;     // Frequência do ROM/bootloader até setCpuFrequencyMhz()
+static bool wifiRadio = false;
+static bool bleRadio = false;
+static uint32_t rng = 1;
+
+static uint64_t timerWakeUs = 0;
+static bool ext0Armed = false;
+static uint8_t ext0Level = HIGH;
+
+// Chamado pelo driver no processo do wake, antes de setup()
+void simDeviceBegin() {
+  const SimBoot& boot = simShared->boot;
+  nowUs = (boot.kind == SIM_BOOT_DEEP_SLEEP ? SIM_BOOT_DEEP_SLEEP_MS : SIM_BOOT_POWER_ON_MS) * 1000LL;
+  clockOffsetUs = boot.clockOffsetUs;
+  rng = boot.wakeIndex * 2654435761UL + 12345;
+  
+  // Erro da base de tempo do firmware ao acordar, antes de qualquer sincronização NTP
+  extern Timebase timebase;
+  simShared->result.timebaseSynced = boot.kind != SIM_BOOT_POWER_ON && timebaseSynced(timebase);
+  if (simShared->result.timebaseSynced) {
+    simShared->result.timebaseErrorUs = timebaseNowUs(timebase, simClockUs()) - simWorldUs();
+  }
+  simShared->result.chargeMaUs[PHASE_BOOT] =
+    (ENERGY_CPU_BASE_MA + ENERGY_CPU_MA_PER_MHZ * cpuMHz) * nowUs;
+}
+
+// Carga do intervalo atribuída à fase corrente do WakeProfiler
+static void integrate(int64_t us) {
+  SimResult& result = simShared->result;
+  double ma = ENERGY_CPU_BASE_MA + ENERGY_CPU_MA_PER_MHZ * cpuMHz;
+  if (wifiRadio) {
+    ma += ENERGY_WIFI_RX_MA * (1.0 - ENERGY_WIFI_TX_DUTY) + ENERGY_WIFI_TX_MA * ENERGY_WIFI_TX_DUTY;
+    result.wifiUs += us;
+  }
+  if (bleRadio) {
+    ma += ENERGY_BLE_MA;
+    result.bleUs += us;
+  }
+  result.chargeMaUs[wakeProfiler.phase()] += ma * us;
+}
+
+void simAdvanceUs(int64_t us) {
+  int64_t target = nowUs + us;
+  simNetPoll();
+  while (nowUs < target) {
+    int64_t step = std::min(target, std::max(nowUs + 1, simNetNextEventUs()));
+    integrate(step - nowUs);
+    nowUs = step;
+    simNetPoll();
+  }
+  if (nowUs > SIM_MAX_AWAKE_MS * 1000LL) {
+    fprintf(stderr, "sim: wake passou de %d ms acordado\n", SIM_MAX_AWAKE_MS);
+    simExit(SIM_EXIT_HANG);
+  }
+}
+
+int64_t simNowUs() {
+  simAdvanceUs(SIM_CLOCK_READ_COST_US);
+  return nowUs;
+}
+
+int64_t simPeekUs() {
+  return nowUs;
+}
+
+int64_t simWorldUs() {
+  return simShared->boot.worldUs + nowUs;
+}
+
+int64_t simClockUs() {
+  return simWorldUs() + clockOffsetUs;
+}
+
+void simSetClockUs(int64_t clockUs) {
+  clockOffsetUs = clockUs - simWorldUs();
+}
+
+void simSetCpuMHz(uint32_t mhz) { cpuMHz = mhz; }
+uint32_t simCpuMHz() { return cpuMHz; }
+void simSetWifiRadio(bool on) { wifiRadio = on; }
+void simSetBle(bool on) { bleRadio = on; }
+
+uint32_t simRandom() {
+  return SimWorld::nextRandom(rng);
+}
+
+// Relógio do sistema para time()/gettimeofday() (SimClock.c)
+extern "C" int64_t simSystemClockUs() {
+  return simShared ? simClockUs() : 0;
+}
+
+// Preenche o resultado do wake; o driver copia as seções RTC e encerra o processo
+void simFinishWake() {
+  SimResult& result = simShared->result;
+  result.awakeUs = nowUs;
+  result.clockOffsetUs = clockOffsetUs;
+  result.sleepUs = timerWakeUs;
+  result.ext0Armed = ext0Armed;
+  result.ext0Level = ext0Level;
+}
+
+// ---- Pinos ----
+
+int simReadPin(uint8_t pin) {
+  if (pin == RAIN_GAUGE_INTERRUPT_PIN) {
+    bool closed = simWorld.rainContactClosed(simWorldUs());
+    return closed ? RAIN_GAUGE_WAKE_LEVEL : !RAIN_GAUGE_WAKE_LEVEL;
+  }
+  if (pin == CONFIG_BUTTON_PIN) {
+    return HIGH;  // Pull-up, botão solto
+  }
+  #if LOG_HOST_DETECT_PIN >= 0
+    if (pin == LOG_HOST_DETECT_PIN) {
+      return simShared->boot.hostAttached ? HIGH : LOW;
+    }
+  #endif
+  return LOW;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) { return simReadPin(pin); }
+
+int rtc_gpio_get_level(gpio_num_t gpio) { return simReadPin((uint8_t)gpio); }
+esp_err_t rtc_gpio_init(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t rtc_gpio_deinit(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t rtc_gpio_set_direction(gpio_num_t gpio, rtc_gpio_mode_t mode) { return ESP_OK; }
+esp_err_t rtc_gpio_pullup_dis(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpio) { return ESP_OK; }
+esp_err_t rtc_gpio_hold_en(gpio_num_t gpio) { return ESP_OK; }
+
+// Divisor 1:2 e atenuação de 11 dB (fundo de escala ~3,6 V), como em getBatteryVoltage()
+uint16_t analogRead(uint8_t pin) {
+  if (pin != BATTERY_ADC_PIN) {
+    return 0;
+  }
+  double consumed = simShared->boot.consumedMah;
+  for (double charge : simShared->result.chargeMaUs) {
+    consumed += charge / 3.6e9;
+  }
+  float voltage = SimWorld::batteryVoltage(consumed, BATTERY_CAPACITY_MAH);
+  return (uint16_t)std::min(4095.0f, voltage / 2.0f / 3.6f * 4095.0f);
+}
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+  return (uint32_t)(analogRead(pin) * 3600UL / 4095);
+}
+
+void analogReadResolution(uint8_t bits) {}
+void analogSetAttenuation(int attenuation) {}
+
+// ---- Tempo ----
+
+int64_t esp_timer_get_time() { return simNowUs(); }
+unsigned long millis() { return (unsigned long)(simNowUs() / 1000); }
+unsigned long micros() { return (unsigned long)simNowUs(); }
+void delay(uint32_t ms) { simAdvanceUs(ms * 1000LL); }
+void delayMicroseconds(uint32_t us) { simAdvanceUs(us); }
+void yield() { simAdvanceUs(SIM_CLOCK_READ_COST_US); }
+
+bool getLocalTime(struct tm* info, uint32_t ms) {
+  uint32_t start = millis();
+  while (millis() - start <= ms) {
+    time_t now = time(nullptr);
+    localtime_r(&now, info);
+    if (info->tm_year > (2016 - 1900)) {
+      return true;
+    }
+    delay(10);
+  }
+  return false;
+}
+
+// ---- CPU e sistema ----
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  if (mhz != 240 && mhz != 160 && mhz != 80 && mhz != 40 && mhz != 20 && mhz != 10) {
+    return false;
+  }
+  simAdvanceUs(20);
+  cpuMHz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz() { return cpuMHz; }
+
+long random(long max) { return max > 0 ? (long)(simRandom() % (uint32_t)max) : 0; }
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+
+void EspClass::restart() {
+  simExit(SIM_EXIT_RESTART);
+}
+
+uint64_t EspClass::getEfuseMac() { return 0x3C71BF5A1C24ULL; }
+uint32_t EspClass::getFreeHeap() { return 200000; }
+
+esp_reset_reason_t esp_reset_reason() {
+  switch (simShared->boot.kind) {
+    case SIM_BOOT_DEEP_SLEEP: return ESP_RST_DEEPSLEEP;
+    case SIM_BOOT_SOFTWARE_RESET: return ESP_RST_SW;
+    default: return ESP_RST_POWERON;
+  }
+}
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t length = strlen(src);
+  if (size > 0) {
+    size_t n = length < size - 1 ? length : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return length;
+}
+#endif
+
+// ---- Deep sleep ----
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+  timerWakeUs = timeUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio, int level) {
+  ext0Armed = gpio == RAIN_GAUGE_INTERRUPT_PIN;
+  ext0Level = level;
+  return ESP_OK;
+}
+
+// O botão de configuração não é pressionado nos cenários
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode) { return ESP_OK; }
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option) { return ESP_OK; }
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return (esp_sleep_wakeup_cause_t)simShared->boot.wakeCause;
+}
+
+void esp_deep_sleep_start() {
+  simExit(SIM_EXIT_DEEP_SLEEP);
+}
+
+// ---- Serial ----
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (simShared->boot.hostAttached) {
+    fputc(c, stdout);
+  }
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (simShared->boot.hostAttached) {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
@@ -0,0 +1,114 @@
+#ifndef SIM_DEVICE_H
+#define SIM_DEVICE_H
+
+#include <stdint.h>
+
+// Dispositivo simulado: estado de um único wake, executado em um processo filho.
+// O fork dá a cada wake uma RAM limpa, como no boot real; só as seções RTC
+// (RTC_DATA_ATTR / RTC_NOINIT_ATTR, ver esp_attr.h) são copiadas entre wakes.
+
+enum SimBootKind : uint8_t {
+  SIM_BOOT_POWER_ON = 0,
+  SIM_BOOT_DEEP_SLEEP,
+  SIM_BOOT_SOFTWARE_RESET
+};
+
+enum SimExit : uint8_t {
+  SIM_EXIT_DEEP_SLEEP = 0,
+  SIM_EXIT_RESTART,
+  SIM_EXIT_HANG,              // setup() retornou ou passou de SIM_MAX_AWAKE_MS
+  SIM_EXIT_CRASH              // Preenchido pelo driver quando o processo termina por sinal
+};
+
+// Fontes de wake na mesma numeração de esp_sleep_wakeup_cause_t
+#define SIM_WAKE_UNDEFINED 0
+#define SIM_WAKE_EXT0 2
+#define SIM_WAKE_EXT1 3
+#define SIM_WAKE_TIMER 4
+
+#define SIM_MAX_AWAKE_MS 600000       // "Watchdog" do simulador: 10 min acordado
+#define SIM_PHASES 7                  // PHASE_COUNT de WakeProfiler.h
+#define SIM_PAYLOAD_MAX 1024
+
+// Entrada do wake (driver -> dispositivo)
+struct SimBoot {
+  SimBootKind kind;
+  uint8_t wakeCause;
+  int64_t worldUs;            // Instante do boot
+  int64_t clockOffsetUs;      // Relógio do sistema menos o tempo do mundo
+  double consumedMah;         // Carga real já retirada da bateria
+  uint32_t wakeIndex;         // Semente das latências deste wake
+  bool hostAttached;          // Serial com host: o log do firmware vai para stdout
+  bool serialNetwork;         // WiFi.begin() bloqueia até a conexão e o NTP (referência sem sobreposição)
+};
+
+// Resultado do wake (dispositivo -> driver)
+struct SimResult {
+  SimExit exit;
+  int64_t awakeUs;            // esp_timer no fim do wake (inclui o boot)
+  int64_t wifiUs;             // Tempo com o rádio WiFi ligado
+  int64_t bleUs;              // Tempo com o BLE ligado
+  double chargeMaUs[SIM_PHASES];  // Carga por fase do WakeProfiler (mA·us)
+  uint64_t sleepUs;           // Timer programado (relógio do dispositivo)
+  bool ext0Armed;
+  uint8_t ext0Level;
+  int64_t clockOffsetUs;
+  bool timebaseSynced;        // Base de tempo do firmware ancorada no NTP no início do wake...
+  int64_t timebaseErrorUs;    // ...e o seu erro em relação ao tempo real nesse instante
+  uint16_t published;
+  uint16_t publishFailed;
+  uint32_t payloadBytes;
+  uint16_t flashWrites;       // Escritas e apagamentos na partição do log de chuva
+  uint16_t flashErases;
+  int64_t ntpStartUs;         // configTime() chamado (0 = não)...
+  int64_t ntpSyncUs;          // ...relógio ajustado pelo SNTP (0 = não)...
+  int64_t firstPublishUs;     // ...e primeiro envio bem-sucedido (0 = nenhum), em us do wake
+  char lastPayload[SIM_PAYLOAD_MAX];
+};
+
+// Memória compartilhada entre o driver e o processo do wake
+struct SimShared {
+  SimBoot boot;
+  SimResult result;
+};
+
+extern SimShared* simShared;
+
+// Início e fim do wake no processo filho
+void simDeviceBegin();
+void simFinishWake();
+
+// Relógio virtual do wake (us desde o boot). Cada leitura custa um pouco de tempo,
+// para que laços de espera ativa sempre avancem.
+int64_t simNowUs();
+int64_t simPeekUs();          // Sem custo: para o próprio simulador
+void simAdvanceUs(int64_t us);
+int64_t simWorldUs();
+
+// Relógio do sistema (time/gettimeofday) e seu ajuste pelo NTP
+int64_t simClockUs();
+void simSetClockUs(int64_t clockUs);
+
+// Estado de consumo
+void simSetCpuMHz(uint32_t mhz);
+uint32_t simCpuMHz();
+void simSetWifiRadio(bool on);
+void simSetBle(bool on);
+
+// Sorteio determinístico por wake
+uint32_t simRandom();
+
+// Eventos de rede que acontecem em segundo plano (associação, DHCP, SNTP)
+void simNetPoll();
+int64_t simNetNextEventUs();
+
+// Encerram o wake
+[[noreturn]] void simExit(SimExit exit);
+
+// Pinos
+int simReadPin(uint8_t pin);
+
+// Diretório do host que faz o papel da partição SPIFFS
+extern const char* simFsRoot;
+
+#endif // SIM_DEVICE_H
@@ -0,0 +1,516 @@
+// Simulação de eventos discretos do ciclo de wake completo no host (ambiente "native").
+//
+// Cada wake executa setup() do firmware em um processo filho com relógio virtual;
+// o processo pai faz o papel do hardware que dorme: guarda a memória RTC, avança o
+// mundo durante o deep sleep e decide quando (e por quê) o próximo wake acontece.
+
+#include <Arduino.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <filesystem>
+#include <vector>
+#include "SimDevice.h"
+#include "SimWorld.h"
+#include "config.h"
+#include "WakeProfiler.h"
+#include "RuntimeBudget.h"
+#include "EnergyModel.h"
+
+void setup();
+
+extern WakeProfileLog wakeProfileLog;
+extern EnergyAccount energyAccount;
+extern RuntimeBudgetStats runtimeBudgetStats;
+
+// Limites das seções RTC, gerados pelo linker (ver esp_attr.h)
+extern uint8_t __start_sim_rtc_data[] __attribute__((weak));
+extern uint8_t __stop_sim_rtc_data[] __attribute__((weak));
+extern uint8_t __start_sim_rtc_noinit[] __attribute__((weak));
+extern uint8_t __stop_sim_rtc_noinit[] __attribute__((weak));
+
+// Conteúdo da RTC_NOINIT no power-on: lixo, para exercitar as validações por "magic"
+#define SIM_NOINIT_GARBAGE 0xA5
+
+static size_t rtcDataSize;
+static size_t rtcNoinitSize;
+static uint8_t* sharedRtcData;      // Imagem das seções RTC no fim do wake (memória compartilhada)
+static uint8_t* sharedRtcNoinit;
+
+struct SimOptions {
+  const char* scenario = "storm";
+  double hours = 0;                  // 0 = duração padrão do cenário
+  uint32_t seed = 1;
+  bool trace = false;
+  bool log = false;
+  bool serial = false;
+  bool compare = false;
+};
+
+// Totais de um cenário
+struct SimReport {
+  uint32_t wakes = 0;
+  uint32_t wakesByCause[5] = {};     // Índice: SIM_WAKE_*
+  uint32_t powerOns = 0;
+  uint32_t restarts = 0;
+  uint32_t fastPathWakes = 0;
+  uint32_t hangs = 0;
+  uint32_t crashes = 0;
+  uint32_t undelivered = 0;          // Wakes completos sem nenhum envio
+  uint32_t published = 0;
+  uint32_t publishFailed = 0;
+  uint64_t payloadBytes = 0;
+  uint32_t flashWrites = 0;
+  uint32_t flashErases = 0;
+  std::vector<int64_t> awakeUs;
+  std::vector<int64_t> fullAwakeUs;  // Tempo acordado dos wakes completos (sem o caminho rápido)
+  int64_t wifiUs = 0;
+  int64_t bleUs = 0;
+  double phaseUs[SIM_PHASES] = {};   // Soma das durações medidas pelo WakeProfiler
+  uint32_t profiledWakes = 0;
+  double chargeMaUs[SIM_PHASES] = {};
+  double sleepMaUs = 0;
+  int64_t sleepUs = 0;
+  int64_t maxClockErrorUs = 0;
+  int64_t maxTimebaseErrorUs = 0;
+  uint32_t syncedTimerWakes = 0;     // Wakes por timer com a base de tempo já ancorada...
+  int64_t maxAlignUs = 0;            // ...e a maior distância de um deles ao minuto cheio
+  uint32_t ntpStarted = 0;           // Wakes com sincronização NTP iniciada...
+  uint32_t ntpLate = 0;              // ...que enviaram antes de o relógio ser ajustado
+  float lastReportedRain = NAN;
+  int64_t lastPublishWorldUs = 0;
+};
+
+[[noreturn]] void simExit(SimExit exit) {
+  simFinishWake();
+  simShared->result.exit = exit;
+  memcpy(sharedRtcData, __start_sim_rtc_data, rtcDataSize);
+  memcpy(sharedRtcNoinit, __start_sim_rtc_noinit, rtcNoinitSize);
+  fflush(stdout);
+  fflush(stderr);
+  _exit(0);
+}
+
+static void usage(const char* program) {
+  uint8_t count;
+  const SimScenario* scenarios = simScenarios(count);
+  printf("Uso: %s [--scenario NOME|all] [--hours H] [--seed N] [--trace] [--log] [--serial|--compare]\n\n", program);
+  printf("  --trace   uma linha por wake\n");
+  printf("  --log     host serial conectado: o log do firmware vai para a saída\n");
+  printf("  --serial  WiFi, DHCP e NTP bloqueiam antes dos sensores, sem sobreposição\n");
+  printf("  --compare roda em série e sobreposto e confere o ganho de tempo acordado\n\n");
+  printf("Cenários:\n");
+  for (uint8_t i = 0; i < count; i++) {
+    printf("  %-8s %s (%.0f h)\n", scenarios[i].name, scenarios[i].description, scenarios[i].hours);
+  }
+}
+
+static bool parseOptions(int argc, char** argv, SimOptions& options) {
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (strcmp(arg, "--scenario") == 0 && hasValue) {
+      options.scenario = argv[++i];
+    } else if (strcmp(arg, "--hours") == 0 && hasValue) {
+      options.hours = atof(argv[++i]);
+    } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+      options.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--trace") == 0) {
+      options.trace = true;
+    } else if (strcmp(arg, "--log") == 0) {
+      options.log = true;
+    } else if (strcmp(arg, "--serial") == 0) {
+      options.serial = true;
+    } else if (strcmp(arg, "--compare") == 0) {
+      options.compare = true;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Valor numérico de uma chave no último payload JSON enviado
+static float payloadNumber(const char* payload, const char* key) {
+  char pattern[32];
+  snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+  const char* found = strstr(payload, pattern);
+  return found ? strtof(found + strlen(pattern), nullptr) : NAN;
+}
+
+// Primeira queda de energia do cenário que começa em [fromUs, toUs)
+static bool nextPowerCut(const SimScenario& scenario, int64_t fromUs, int64_t toUs, SimWindow& cut) {
+  for (uint8_t i = 0; i < scenario.powerCutCount; i++) {
+    int64_t startUs = simWorld.startUs() + (int64_t)(scenario.powerCuts[i].startHours * SIM_US_PER_HOUR);
+    if (startUs >= fromUs && startUs < toUs) {
+      cut = scenario.powerCuts[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+// Executa um wake em um processo filho; o resultado e a memória RTC voltam pela memória compartilhada
+static SimExit runWake() {
+  memset(&simShared->result, 0, sizeof(simShared->result));
+  fflush(stdout);
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    exit(2);
+  }
+  if (pid == 0) {
+    simDeviceBegin();
+    setup();
+    simExit(SIM_EXIT_HANG);   // No firmware setup() nunca retorna
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (WIFSIGNALED(status)) {
+    fprintf(stderr, "sim: wake %u terminou com o sinal %d\n", simShared->boot.wakeIndex, WTERMSIG(status));
+    return SIM_EXIT_CRASH;
+  }
+
+  memcpy(__start_sim_rtc_data, sharedRtcData, rtcDataSize);
+  memcpy(__start_sim_rtc_noinit, sharedRtcNoinit, rtcNoinitSize);
+  return simShared->result.exit;
+}
+
+static int64_t percentile(std::vector<int64_t> values, double p) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+  return values[index];
+}
+
+static void printReport(const SimReport& report, double hours, double mmPerTip) {
+  const char* causes[] = {"power-on/reset", "-", "basculada (ext0)", "botão (ext1)", "timer"};
+  printf("Wakes: %u", report.wakes);
+  for (uint8_t i = 0; i < 5; i++) {
+    if (report.wakesByCause[i] > 0) printf("  %s=%u", causes[i], report.wakesByCause[i]);
+  }
+  printf("\n  caminho rápido=%u  reinícios=%u  travamentos=%u  falhas=%u\n",
+         report.fastPathWakes, report.restarts, report.hangs, report.crashes);
+
+  int64_t total = 0;
+  int64_t longest = 0;
+  for (int64_t us : report.awakeUs) {
+    total += us;
+    longest = std::max(longest, us);
+  }
+  double average = report.awakeUs.empty() ? 0 : (double)total / report.awakeUs.size();
+  printf("Acordado: média %.0f ms  p95 %.0f ms  máx %.0f ms  (WiFi %.0f s, BLE %.0f s no total)\n",
+         average / 1000.0, percentile(report.awakeUs, 0.95) / 1000.0, longest / 1000.0,
+         report.wifiUs / 1e6, report.bleUs / 1e6);
+
+  printf("Fases (média por wake completo / carga total):\n");
+  double awakeMaUs = 0;
+  for (uint8_t p = 0; p < SIM_PHASES; p++) {
+    awakeMaUs += report.chargeMaUs[p];
+    double phaseMs = report.profiledWakes ? report.phaseUs[p] / report.profiledWakes / 1000.0 : 0;
+    printf("  %-8s %8.1f ms %10.3f mAh\n", WakeProfiler::phaseName((WakePhase)p),
+           phaseMs, report.chargeMaUs[p] / 3.6e9);
+  }
+
+  double awakeMah = awakeMaUs / 3.6e9;
+  double sleepMah = report.sleepMaUs / 3.6e9;
+  double consumedMah = awakeMah + sleepMah;
+  double averageMa = consumedMah / hours;
+  printf("Energia: %.3f mAh (acordado %.3f + deep sleep %.3f)  média %.3f mA",
+         consumedMah, awakeMah, sleepMah, averageMa);
+  if (averageMa > 0) {
+    printf("  autonomia %.0f dias com %d mAh", BATTERY_CAPACITY_MAH / averageMa / 24.0,
+           BATTERY_CAPACITY_MAH);
+  }
+  printf("\n");
+  if (energyAccountValid(energyAccount)) {
+    printf("  estimativa do firmware: %.3f mAh em %lu ciclos (%+.1f%%)\n",
+           energyAccount.consumedMah, (unsigned long)energyAccount.cycles,
+           consumedMah > 0 ? 100.0 * (energyAccount.consumedMah - consumedMah) / consumedMah : 0.0);
+  }
+
+  printf("Envio: %u publicados, %u falharam, %.1f bytes/envio, %u wakes sem envio\n",
+         report.published, report.publishFailed,
+         report.published ? (double)report.payloadBytes / report.published : 0.0, report.undelivered);
+
+  uint32_t tips = simWorld.tipsBetween(simWorld.startUs(), simWorld.endUs());
+  uint32_t tipsUntilPublish = simWorld.tipsBetween(simWorld.startUs(), report.lastPublishWorldUs);
+  printf("Chuva: %.2f mm caíram (%.2f mm até o último envio)", tips * mmPerTip, tipsUntilPublish * mmPerTip);
+  if (!isnan(report.lastReportedRain)) {
+    printf(", último envio informou %.2f mm", report.lastReportedRain);
+  }
+  printf("\n");
+  printf("  log em flash: %u escritas, %u apagamentos de setor (%.3f escritas por basculada)\n",
+         report.flashWrites, report.flashErases, tips ? (double)report.flashWrites / tips : 0.0);
+
+  printf("Relógio: maior erro de %.1f s em relação ao tempo real (base de tempo com o desvio descontado: %.2f s)\n",
+         report.maxClockErrorUs / 1e6, report.maxTimebaseErrorUs / 1e6);
+  printf("  wakes por timer com hora NTP: %u, maior distância ao minuto cheio %.2f s\n",
+         report.syncedTimerWakes, report.maxAlignUs / 1e6);
+  printf("  sincronizações NTP: %u iniciadas, %u com envio antes do ajuste do relógio\n",
+         report.ntpStarted, report.ntpLate);
+
+  const RuntimeBudgetStats& budget = runtimeBudgetStats;
+  printf("Orçamento: estouros");
+  for (uint8_t p = 0; p < BUDGET_PHASE_COUNT; p++) {
+    printf(" %s=%u", RuntimeBudget::phaseName((BudgetPhase)p), budget.overruns[p]);
+  }
+  printf("  etapas descartadas=%u\n", budget.skipped);
+}
+
+// Roda um cenário do power-on até o fim do período; retorna false se algum wake travou ou falhou
+static bool runScenario(const SimScenario& scenario, const SimOptions& options,
+                        const std::vector<uint8_t>& pristineData, SimReport& report) {
+  double hours = options.hours > 0 ? options.hours : scenario.hours;
+  simWorld.build(scenario, hours, options.seed, DEFAULT_RAIN_MM_PER_TIP);
+  printf("== %s: %s, %.0f h, semente %u%s\n", scenario.name, scenario.description, hours, options.seed,
+         options.serial ? ", rede em série" : "");
+
+  // Sistema de arquivos novo a cada cenário
+  char fsRoot[] = "/tmp/weather-sim-XXXXXX";
+  if (!mkdtemp(fsRoot)) {
+    perror("mkdtemp");
+    exit(2);
+  }
+  simFsRoot = fsRoot;
+
+  report = SimReport();
+  SimBoot& boot = simShared->boot;
+  boot = {};
+  boot.kind = SIM_BOOT_POWER_ON;
+  boot.wakeCause = SIM_WAKE_UNDEFINED;
+  boot.worldUs = simWorld.startUs();
+  boot.clockOffsetUs = -simWorld.startUs();    // Relógio do sistema começa em 1970
+  boot.hostAttached = options.log;
+  boot.serialNetwork = options.serial;
+
+  double driftFactor = SIM_RTC_DRIFT_PPM * 1e-6;
+  bool ok = true;
+
+  while (boot.worldUs < simWorld.endUs()) {
+    // Memória RTC de acordo com o tipo de boot; no deep sleep ela fica como estava
+    if (boot.kind != SIM_BOOT_DEEP_SLEEP) {
+      memcpy(__start_sim_rtc_data, pristineData.data(), rtcDataSize);
+    }
+    if (boot.kind == SIM_BOOT_POWER_ON) {
+      memset(__start_sim_rtc_noinit, SIM_NOINIT_GARBAGE, rtcNoinitSize);
+    }
+
+    uint32_t cyclesBefore = wakeProfileLog.cycles;
+    boot.wakeIndex = report.wakes + options.seed * 100003;
+    boot.consumedMah = 0;
+    for (double charge : report.chargeMaUs) boot.consumedMah += charge / 3.6e9;
+    boot.consumedMah += report.sleepMaUs / 3.6e9;
+
+    SimExit exit = runWake();
+    const SimResult& result = simShared->result;
+    report.wakes++;
+    report.wakesByCause[boot.kind == SIM_BOOT_DEEP_SLEEP ? boot.wakeCause : SIM_WAKE_UNDEFINED]++;
+    if (boot.kind == SIM_BOOT_POWER_ON) report.powerOns++;
+
+    bool fastPath = exit == SIM_EXIT_DEEP_SLEEP && wakeProfileLog.cycles == cyclesBefore;
+    if (exit == SIM_EXIT_DEEP_SLEEP && !fastPath) {
+      const WakeProfile* profile = &wakeProfileLog.entries[(wakeProfileLog.head + WAKE_PROFILE_HISTORY - 1) % WAKE_PROFILE_HISTORY];
+      for (uint8_t p = 0; p < SIM_PHASES; p++) report.phaseUs[p] += profile->phaseUs[p];
+      report.profiledWakes++;
+      report.fullAwakeUs.push_back(result.awakeUs);
+    }
+    if (fastPath) report.fastPathWakes++;
+
+    report.awakeUs.push_back(result.awakeUs);
+    report.wifiUs += result.wifiUs;
+    report.bleUs += result.bleUs;
+    for (uint8_t p = 0; p < SIM_PHASES; p++) report.chargeMaUs[p] += result.chargeMaUs[p];
+    report.published += result.published;
+    report.publishFailed += result.publishFailed;
+    report.payloadBytes += result.payloadBytes;
+    report.flashWrites += result.flashWrites;
+    report.flashErases += result.flashErases;
+    if (result.published > 0) {
+      report.lastPublishWorldUs = boot.worldUs + result.awakeUs;
+      report.lastReportedRain = payloadNumber(result.lastPayload, "rain");
+    } else if (!fastPath) {
+      report.undelivered++;
+    }
+    if (result.ntpStartUs > 0) {
+      report.ntpStarted++;
+      if (result.published > 0 && (result.ntpSyncUs == 0 || result.ntpSyncUs > result.firstPublishUs)) {
+        report.ntpLate++;
+      }
+    }
+
+    if (options.trace) {
+      time_t clock = (time_t)((boot.worldUs + boot.clockOffsetUs) / 1000000);
+      struct tm clockTm;
+      gmtime_r(&clock, &clockTm);
+      const char* exits[] = {"sleep", "restart", "TRAVOU", "FALHOU"};
+      printf("  %6.2f h  wake %-4u %-7s %8.1f ms  envios %u/%u  relógio %04d-%02d-%02d %02d:%02d:%02d (base %+.2f s)%s  -> %s %.0f s\n",
+             (boot.worldUs - simWorld.startUs()) / (double)SIM_US_PER_HOUR, report.wakes,
+             boot.kind == SIM_BOOT_POWER_ON ? "power" : boot.kind == SIM_BOOT_SOFTWARE_RESET ? "reset" :
+             boot.wakeCause == SIM_WAKE_EXT0 ? "chuva" : "timer",
+             result.awakeUs / 1000.0, result.published, result.published + result.publishFailed,
+             clockTm.tm_year + 1900, clockTm.tm_mon + 1, clockTm.tm_mday,
+             clockTm.tm_hour, clockTm.tm_min, clockTm.tm_sec,
+             result.timebaseSynced ? result.timebaseErrorUs / 1e6 : 0.0, fastPath ? " rápido" : "",
+             exits[exit], result.sleepUs / 1e6);
+    }
+
+    if (result.timebaseSynced && boot.kind == SIM_BOOT_DEEP_SLEEP && boot.wakeCause == SIM_WAKE_TIMER) {
+      int64_t offsetUs = boot.worldUs % SIM_US_PER_MINUTE;
+      report.syncedTimerWakes++;
+      report.maxAlignUs = std::max(report.maxAlignUs, std::min<int64_t>(offsetUs, SIM_US_PER_MINUTE - offsetUs));
+    }
+    
+    boot.worldUs += result.awakeUs;
+    boot.clockOffsetUs = result.clockOffsetUs;
+    report.maxClockErrorUs = std::max(report.maxClockErrorUs, (int64_t)std::abs(boot.clockOffsetUs));
+    if (result.timebaseSynced) {
+      report.maxTimebaseErrorUs = std::max(report.maxTimebaseErrorUs, (int64_t)std::abs(result.timebaseErrorUs));
+    }
+
+    if (exit == SIM_EXIT_HANG || exit == SIM_EXIT_CRASH) {
+      // Watchdog/panic: reinicia como um reset por software
+      ok = false;
+      exit == SIM_EXIT_HANG ? report.hangs++ : report.crashes++;
+      boot.kind = SIM_BOOT_SOFTWARE_RESET;
+      boot.wakeCause = SIM_WAKE_UNDEFINED;
+      continue;
+    }
+    if (exit == SIM_EXIT_RESTART) {
+      report.restarts++;
+      boot.kind = SIM_BOOT_SOFTWARE_RESET;
+      boot.wakeCause = SIM_WAKE_UNDEFINED;
+      continue;
+    }
+
+    // Deep sleep: o timer RTC adianta SIM_RTC_DRIFT_PPM, então o sono real é mais curto
+    int64_t wakeAt = result.sleepUs > 0 ? boot.worldUs + (int64_t)(result.sleepUs / (1.0 + driftFactor))
+                                        : simWorld.endUs();
+    uint8_t cause = SIM_WAKE_TIMER;
+    if (result.ext0Armed) {
+      bool closedNow = simWorld.rainContactClosed(boot.worldUs);
+      bool wakeOnClosed = result.ext0Level == RAIN_GAUGE_WAKE_LEVEL;
+      int64_t trigger = closedNow == wakeOnClosed ? boot.worldUs
+                        : wakeOnClosed ? simWorld.nextTipAtOrAfter(boot.worldUs)
+                        : boot.worldUs + SIM_RAIN_CONTACT_MS * 1000LL;
+      if (trigger < wakeAt) {
+        wakeAt = trigger;
+        cause = SIM_WAKE_EXT0;
+      }
+    }
+    wakeAt = std::min(wakeAt, simWorld.endUs());
+    
+    // Queda de energia durante o sono: power-on quando ela volta, com a memória RTC
+    // perdida e o relógio do sistema de novo em 1970
+    SimWindow cut;
+    bool powerCut = nextPowerCut(scenario, boot.worldUs, wakeAt, cut);
+    if (powerCut) {
+      wakeAt = simWorld.startUs() + (int64_t)(cut.startHours * SIM_US_PER_HOUR);
+    }
+
+    int64_t sleptUs = wakeAt - boot.worldUs;
+    report.sleepUs += sleptUs;
+    report.sleepMaUs += ENERGY_DEEP_SLEEP_MA * sleptUs;
+    boot.clockOffsetUs += (int64_t)(sleptUs * driftFactor);
+    boot.worldUs = wakeAt;
+    boot.kind = SIM_BOOT_DEEP_SLEEP;
+    boot.wakeCause = cause;
+    
+    if (powerCut) {
+      boot.worldUs = std::min(wakeAt + (int64_t)(cut.hours * SIM_US_PER_HOUR), simWorld.endUs());
+      boot.clockOffsetUs = -boot.worldUs;
+      boot.kind = SIM_BOOT_POWER_ON;
+      boot.wakeCause = SIM_WAKE_UNDEFINED;
+    }
+  }
+
+  printReport(report, hours, DEFAULT_RAIN_MM_PER_TIP);
+  printf("\n");
+  std::filesystem::remove_all(fsRoot);
+  return ok;
+}
+
+// Mesmo cenário e semente com a rede em série e sobreposta aos sensores. Falha se a
+// sobreposição não reduzir a mediana do tempo acordado dos wakes completos (a média
+// depende de quantos wakes caem nas quedas de rede) ou se algum envio sair antes do
+// ajuste do relógio pelo NTP iniciado no mesmo wake
+static bool compareScenario(const SimScenario& scenario, const SimOptions& options,
+                            const std::vector<uint8_t>& pristineData) {
+  SimOptions serialOptions = options;
+  serialOptions.serial = true;
+  SimOptions overlappedOptions = options;
+  overlappedOptions.serial = false;
+
+  SimReport serial, overlapped;
+  bool ok = runScenario(scenario, serialOptions, pristineData, serial);
+  ok &= runScenario(scenario, overlappedOptions, pristineData, overlapped);
+
+  double serialMs = percentile(serial.fullAwakeUs, 0.5) / 1000.0;
+  double overlappedMs = percentile(overlapped.fullAwakeUs, 0.5) / 1000.0;
+  printf("== %s: mediana do wake completo %.0f ms em série, %.0f ms sobreposto (%+.1f%%); envios antes do NTP: %u em série, %u sobreposto\n\n",
+         scenario.name, serialMs, overlappedMs,
+         serialMs > 0 ? 100.0 * (overlappedMs - serialMs) / serialMs : 0.0,
+         serial.ntpLate, overlapped.ntpLate);
+
+  if (overlapped.fullAwakeUs.empty() || overlappedMs >= serialMs) {
+    printf("sim: a sobreposição não reduziu o tempo acordado em %s\n", scenario.name);
+    ok = false;
+  }
+  if (overlapped.ntpLate > 0) {
+    printf("sim: %u envios antes do ajuste do relógio em %s\n", overlapped.ntpLate, scenario.name);
+    ok = false;
+  }
+  return ok;
+}
+
+// Um cenário, sozinho ou comparado com a rede em série
+static bool runSelected(const SimScenario& scenario, const SimOptions& options,
+                        const std::vector<uint8_t>& pristineData) {
+  if (options.compare) {
+    return compareScenario(scenario, options, pristineData);
+  }
+  SimReport report;
+  return runScenario(scenario, options, pristineData, report);
+}
+
+int main(int argc, char** argv) {
+  SimOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  rtcDataSize = __stop_sim_rtc_data - __start_sim_rtc_data;
+  rtcNoinitSize = __stop_sim_rtc_noinit - __start_sim_rtc_noinit;
+  size_t sharedSize = sizeof(SimShared) + rtcDataSize + rtcNoinitSize;
+  void* shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    perror("mmap");
+    return 2;
+  }
+  simShared = (SimShared*)shared;
+  sharedRtcData = (uint8_t*)shared + sizeof(SimShared);
+  sharedRtcNoinit = sharedRtcData + rtcDataSize;
+
+  // Valores iniciais das variáveis RTC_DATA_ATTR, recarregados em todo boot que não vem do deep sleep
+  std::vector<uint8_t> pristineData(__start_sim_rtc_data, __start_sim_rtc_data + rtcDataSize);
+
+  uint8_t count;
+  const SimScenario* scenarios = simScenarios(count);
+  bool ok = true;
+  if (strcmp(options.scenario, "all") == 0) {
+    for (uint8_t i = 0; i < count; i++) {
+      ok &= runSelected(scenarios[i], options, pristineData);
+    }
+  } else {
+    const SimScenario* scenario = simFindScenario(options.scenario);
+    if (!scenario) {
+      usage(argv[0]);
+      return 2;
+    }
+    ok = runSelected(*scenario, options, pristineData);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,364 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <PubSubClient.h>
+#include <esp_sntp.h>
+#include "SimDevice.h"
+#include "SimWorld.h"
+#include "config.h"
+
+// Eventos de rede em segundo plano, em microssegundos do relógio do wake
+#define SIM_NO_EVENT INT64_MAX
+
+WiFiClass WiFi;
+
+static wifi_mode_t wifiMode = WIFI_OFF;
+static bool staConnected = false;
+static bool staConnecting = false;
+static int64_t staReadyAtUs = SIM_NO_EVENT;
+static int64_t gotIpAtUs = SIM_NO_EVENT;
+static uint32_t staticIp = 0;
+static uint32_t staticGateway = 0;
+static uint32_t staticNetmask = 0;
+static uint32_t staticDns = 0;
+
+static const uint8_t apBssid[6] = {0x24, 0x4B, 0xFE, 0x12, 0x34, 0x56};
+static const int32_t apChannel = 6;
+static const uint32_t leaseIp = IPAddress(192, 168, 1, 57);
+static const uint32_t leaseGateway = IPAddress(192, 168, 1, 1);
+static const uint32_t leaseNetmask = IPAddress(255, 255, 255, 0);
+
+struct EventHandler {
+  WiFiEventFuncCb callback;
+  WiFiEvent_t event;
+};
+static EventHandler eventHandlers[8];
+static uint8_t eventHandlerCount = 0;
+
+static bool ntpPending = false;
+static int64_t ntpReadyAtUs = SIM_NO_EVENT;
+static sntp_sync_time_cb_t ntpCallback = nullptr;
+
+static uint32_t jitterMs(uint32_t baseMs) {
+  uint32_t draw = simRandom();
+  return SimWorld::jitterMs(baseMs, draw);
+}
+
+static bool serverReachable() {
+  return staConnected && simWorld.brokerUp(simWorldUs());
+}
+
+static void fireEvent(WiFiEvent_t event) {
+  WiFiEventInfo_t info = {};
+  for (uint8_t i = 0; i < eventHandlerCount; i++) {
+    if (eventHandlers[i].event == event || eventHandlers[i].event == ARDUINO_EVENT_MAX) {
+      eventHandlers[i].callback(event, info);
+    }
+  }
+}
+
+static void scheduleNtp() {
+  ntpReadyAtUs = simPeekUs() + jitterMs(SIM_NTP_MS) * 1000LL;
+}
+
+// Associação/DHCP e SNTP concluídos em segundo plano
+void simNetPoll() {
+  static bool polling = false;
+  if (polling) return;
+  polling = true;
+
+  int64_t now = simPeekUs();
+  if (staConnecting && now >= staReadyAtUs) {
+    if (simWorld.wifiUp(simWorldUs())) {
+      staConnecting = false;
+      staConnected = true;
+      staReadyAtUs = SIM_NO_EVENT;
+      if (ntpPending) scheduleNtp();
+      // WiFi.status() já indica a conexão; os callbacks rodam quando a tarefa de eventos for escalonada
+      gotIpAtUs = now + jitterMs(SIM_WIFI_EVENT_MS) * 1000LL;
+    } else {
+      // Ponto de acesso fora do ar: nova varredura
+      staReadyAtUs = now + jitterMs(SIM_WIFI_SCAN_MS) * 1000LL;
+    }
+  } else if (staConnected && !simWorld.wifiUp(simWorldUs())) {
+    staConnected = false;
+    staConnecting = true;
+    staReadyAtUs = now + jitterMs(SIM_WIFI_SCAN_MS + SIM_WIFI_ASSOC_MS + SIM_WIFI_DHCP_MS) * 1000LL;
+    gotIpAtUs = SIM_NO_EVENT;
+    fireEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  }
+
+  if (staConnected && now >= gotIpAtUs) {
+    gotIpAtUs = SIM_NO_EVENT;
+    fireEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+    fireEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  }
+
+  if (ntpPending && staConnected && now >= ntpReadyAtUs) {
+    ntpPending = false;
+    ntpReadyAtUs = SIM_NO_EVENT;
+    simSetClockUs(simWorldUs());
+    simShared->result.ntpSyncUs = now;
+    if (ntpCallback) {
+      struct timeval tv;
+      gettimeofday(&tv, nullptr);
+      ntpCallback(&tv);
+    }
+  }
+
+  polling = false;
+}
+
+int64_t simNetNextEventUs() {
+  int64_t next = staConnecting ? staReadyAtUs : SIM_NO_EVENT;
+  if (staConnected) {
+    next = std::min(next, gotIpAtUs);
+  }
+  if (ntpPending && staConnected) {
+    next = std::min(next, ntpReadyAtUs);
+  }
+  return next;
+}
+
+// ---- WiFi ----
+
+int WiFiClass::onEvent(WiFiEventFuncCb callback, WiFiEvent_t event) {
+  if (eventHandlerCount >= sizeof(eventHandlers) / sizeof(eventHandlers[0])) {
+    return -1;
+  }
+  eventHandlers[eventHandlerCount] = {callback, event};
+  return eventHandlerCount++;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  wifiMode = mode;
+  simSetWifiRadio(mode != WIFI_OFF);
+  if (mode == WIFI_OFF || mode == WIFI_AP) {
+    staConnected = false;
+    staConnecting = false;
+    gotIpAtUs = SIM_NO_EVENT;
+  }
+  return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+  return wifiMode;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password, int32_t channel,
+                             const uint8_t* bssid, bool connect) {
+  if (wifiMode == WIFI_OFF) {
+    mode(WIFI_STA);
+  }
+
+  // Canal e BSSID conhecidos dispensam a varredura; IP estático dispensa o DHCP
+  uint32_t latencyMs = SIM_WIFI_ASSOC_MS;
+  if (channel <= 0 || bssid == nullptr) latencyMs += SIM_WIFI_SCAN_MS;
+  if (staticIp == 0) latencyMs += SIM_WIFI_DHCP_MS;
+
+  staConnected = false;
+  staConnecting = connect;
+  staReadyAtUs = simPeekUs() + jitterMs(latencyMs) * 1000LL;
+  gotIpAtUs = SIM_NO_EVENT;
+
+  // Referência sem sobreposição: associação, DHCP e NTP terminam antes de o firmware seguir
+  // para os sensores, com os mesmos limites de tempo
+  if (simShared->boot.serialNetwork && connect) {
+    int64_t deadlineUs = simPeekUs() + (WIFI_TIMEOUT + BUDGET_NTP_MS) * 1000LL;
+    while ((staConnecting || gotIpAtUs != SIM_NO_EVENT || ntpPending) && simPeekUs() < deadlineUs) {
+      simAdvanceUs(1000);
+    }
+    return staConnected ? WL_CONNECTED : WL_DISCONNECTED;
+  }
+  return WL_DISCONNECTED;
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+                       IPAddress dns1, IPAddress dns2) {
+  staticIp = localIP;
+  staticGateway = gateway;
+  staticNetmask = subnet;
+  staticDns = dns1;
+  return true;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+  staConnected = false;
+  staConnecting = false;
+  gotIpAtUs = SIM_NO_EVENT;
+  if (wifiOff) {
+    mode(WIFI_OFF);
+  }
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  simNetPoll();
+  return staConnected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+IPAddress WiFiClass::localIP() { return staConnected ? IPAddress(staticIp ? staticIp : leaseIp) : IPAddress(); }
+IPAddress WiFiClass::gatewayIP() { return IPAddress(staticIp ? staticGateway : leaseGateway); }
+IPAddress WiFiClass::subnetMask() { return IPAddress(staticIp ? staticNetmask : leaseNetmask); }
+IPAddress WiFiClass::dnsIP(uint8_t index) { return IPAddress(staticIp ? staticDns : leaseGateway); }
+uint8_t* WiFiClass::BSSID() { return (uint8_t*)apBssid; }
+int32_t WiFiClass::channel() { return apChannel; }
+int8_t WiFiClass::RSSI() { return staConnected ? -67 : 0; }
+
+bool WiFiClass::softAP(const char* ssid, const char* password) {
+  mode(WIFI_AP);
+  return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return IPAddress(192, 168, 4, 1);
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff) {
+  if (wifiOff) {
+    mode(WIFI_OFF);
+  }
+  return true;
+}
+
+// ---- TCP ----
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, (int32_t)(_timeoutSeconds * 1000));
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, (int32_t)(_timeoutSeconds * 1000));
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  return connect(IPAddress(), port, timeoutMs);
+}
+
+// Um único servidor no cenário (broker MQTT ou nó Meshtastic)
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  if (!staConnected) {
+    return 0;
+  }
+  if (serverReachable()) {
+    delay(jitterMs(SIM_TCP_CONNECT_MS));
+    _connected = true;
+    return 1;
+  }
+  delay(timeoutMs);
+  return 0;
+}
+
+// ---- MQTT ----
+
+bool PubSubClient::connect(const char* id) {
+  return connect(id, nullptr, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+  if (!_client->connect("broker", 1883)) {
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+  }
+  delay(jitterMs(SIM_MQTT_CONNACK_MS));
+  _state = MQTT_CONNECTED;
+  return true;
+}
+
+void PubSubClient::disconnect() {
+  delay(1);
+  _client->stop();
+  _state = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  SimResult& result = simShared->result;
+  size_t length = strlen(payload);
+
+  // Mesma verificação do PubSubClient: cabeçalho (5) + tamanho do tópico (2) + tópico + payload
+  if (_state != MQTT_CONNECTED || 5 + 2 + strlen(topic) + length > _bufferSize) {
+    result.publishFailed++;
+    return false;
+  }
+  delay(jitterMs(SIM_MQTT_PUBLISH_MS));
+  if (!serverReachable()) {
+    _state = MQTT_CONNECTION_LOST;
+    result.publishFailed++;
+    return false;
+  }
+
+  if (result.published++ == 0) result.firstPublishUs = simPeekUs();
+  result.payloadBytes += length;
+  strlcpy(result.lastPayload, payload, sizeof(result.lastPayload));
+  return true;
+}
+
+// ---- HTTP (API do nó Meshtastic) ----
+
+bool HTTPClient::begin(const String& url) {
+  return true;
+}
+
+int HTTPClient::PUT(const String& payload) {
+  return request(payload);
+}
+
+int HTTPClient::POST(const String& payload) {
+  return request(payload);
+}
+
+int HTTPClient::request(const String& payload) {
+  WiFiClient client;
+  if (!client.connect("node", 80, _connectTimeoutMs)) {
+    simShared->result.publishFailed++;
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  delay(jitterMs(SIM_HTTP_REQUEST_MS));
+
+  SimResult& result = simShared->result;
+  if (result.published++ == 0) result.firstPublishUs = simPeekUs();
+  result.payloadBytes += payload.length();
+  strlcpy(result.lastPayload, payload.c_str(), sizeof(result.lastPayload));
+  return 200;
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+    case HTTPC_ERROR_NO_STREAM: return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+    case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+    default: return String();
+  }
+}
+
+// ---- SNTP ----
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+  ntpCallback = callback;
+}
+
+// Mesmo formato de fuso do core: "UTC3:00:00" para UTC-3
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2, const char* server3) {
+  long offset = -(gmtOffsetSec + daylightOffsetSec);
+  char tz[32];
+  snprintf(tz, sizeof(tz), "UTC%ld:%02u:%02u", offset / 3600,
+           (unsigned)labs((offset % 3600) / 60), (unsigned)labs(offset % 60));
+  setenv("TZ", tz, 1);
+  tzset();
+
+  ntpPending = true;
+  ntpReadyAtUs = SIM_NO_EVENT;
+  if (simShared->result.ntpStartUs == 0) simShared->result.ntpStartUs = simPeekUs();
+  if (staConnected) {
+    scheduleNtp();
+  }
+}
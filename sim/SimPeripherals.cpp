@@ -0,0 +1,413 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPIFFS.h>
+#include <LittleFS.h>
+#include <Adafruit_AHTX0.h>
+#include <DHT.h>
+#include <NimBLEDevice.h>
+#include <esp_partition.h>
+#include <sys/stat.h>
+#include "SimDevice.h"
+#include "SimWorld.h"
+#include "config.h"
+#include "Bmp280Compensation.h"
+
+TwoWire Wire;
+SPIFFSFS SPIFFS;
+LittleFSFS LittleFS;
+
+// Ruído de leitura uniforme em ±amplitude
+static float noise(float amplitude) {
+  return amplitude * (2.0f * simRandom() / 4294967295.0f - 1.0f);
+}
+
+static uint32_t jitterMs(uint32_t baseMs) {
+  uint32_t draw = simRandom();
+  return SimWorld::jitterMs(baseMs, draw);
+}
+
+// ---- Sistema de arquivos ----
+
+namespace fs {
+
+size_t File::write(uint8_t c) {
+  return _file && fputc(c, _file.get()) != EOF ? 1 : 0;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+  return _file ? fwrite(buffer, 1, size, _file.get()) : 0;
+}
+
+int File::available() {
+  return _file ? (int)(size() - position()) : 0;
+}
+
+int File::read() {
+  return _file ? fgetc(_file.get()) : -1;
+}
+
+int File::peek() {
+  if (!_file) return -1;
+  int c = fgetc(_file.get());
+  if (c != EOF) ungetc(c, _file.get());
+  return c;
+}
+
+size_t File::read(uint8_t* buffer, size_t size) {
+  return _file ? fread(buffer, 1, size, _file.get()) : 0;
+}
+
+void File::flush() {
+  if (_file) fflush(_file.get());
+}
+
+bool File::seek(uint32_t position) {
+  return _file && fseek(_file.get(), position, SEEK_SET) == 0;
+}
+
+size_t File::position() const {
+  return _file ? (size_t)ftell(_file.get()) : 0;
+}
+
+size_t File::size() const {
+  if (!_file) return 0;
+  struct stat info;
+  fflush(_file.get());
+  return fstat(fileno(_file.get()), &info) == 0 ? (size_t)info.st_size : 0;
+}
+
+static std::string hostPath(const char* path) {
+  return std::string(simFsRoot) + (path[0] == '/' ? "" : "/") + path;
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  // Modos do Arduino ("r", "w", "a") mapeados para leitura binária do host
+  std::string hostMode = std::string(mode) + "b";
+  FILE* file = fopen(hostPath(path).c_str(), hostMode.c_str());
+  return file ? File(file) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat info;
+  return stat(hostPath(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return ::remove(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+}  // namespace fs
+
+// Montar a partição custa o tempo de varrer os blocos
+bool SPIFFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles,
+                     const char* partitionLabel) {
+  delay(jitterMs(15));
+  return true;
+}
+
+bool SPIFFSFS::format() {
+  return true;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char* basePath, uint8_t maxOpenFiles,
+                       const char* partitionLabel) {
+  delay(jitterMs(10));
+  return true;
+}
+
+bool LittleFSFS::format() {
+  return true;
+}
+
+// ---- Flash (partição do log de chuva) ----
+
+// Arquivo do host com o conteúdo da partição, criado apagado (0xFF) no primeiro acesso
+static const esp_partition_t rainLogPartition = {
+  ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, 0x3F0000, SIM_RAIN_LOG_PARTITION_SIZE, RAIN_LOG_PARTITION, false
+};
+
+static FILE* openPartition() {
+  std::string path = std::string(simFsRoot) + "/.partition-" + RAIN_LOG_PARTITION;
+  FILE* file = fopen(path.c_str(), "r+b");
+  if (!file) {
+    file = fopen(path.c_str(), "w+b");
+    if (!file) return nullptr;
+    std::vector<uint8_t> erased(SIM_RAIN_LOG_PARTITION_SIZE, 0xFF);
+    fwrite(erased.data(), 1, erased.size(), file);
+  }
+  return file;
+}
+
+static bool partitionRange(const esp_partition_t* partition, size_t offset, size_t size) {
+  return partition == &rainLogPartition && offset + size <= partition->size;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+  if (type != ESP_PARTITION_TYPE_DATA || !label || strcmp(label, RAIN_LOG_PARTITION) != 0) {
+    return nullptr;
+  }
+  return &rainLogPartition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+  if (!partitionRange(partition, src_offset, size)) return ESP_ERR_INVALID_ARG;
+  FILE* file = openPartition();
+  if (!file) return ESP_FAIL;
+  bool ok = fseek(file, src_offset, SEEK_SET) == 0 && fread(dst, 1, size, file) == size;
+  fclose(file);
+  simAdvanceUs(size / SIM_FLASH_READ_BYTES_PER_US);
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+// Como no NOR, a escrita só leva bits de 1 para 0
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size) {
+  if (!partitionRange(partition, dst_offset, size)) return ESP_ERR_INVALID_ARG;
+  FILE* file = openPartition();
+  if (!file) return ESP_FAIL;
+  std::vector<uint8_t> data(size);
+  bool ok = fseek(file, dst_offset, SEEK_SET) == 0 && fread(data.data(), 1, size, file) == size;
+  for (size_t i = 0; i < size; i++) {
+    data[i] &= ((const uint8_t*)src)[i];
+  }
+  ok = ok && fseek(file, dst_offset, SEEK_SET) == 0 && fwrite(data.data(), 1, size, file) == size;
+  fclose(file);
+  delay(jitterMs(SIM_FLASH_WRITE_MS * ((size + 255) / 256)));
+  simShared->result.flashWrites++;
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+  if (!partitionRange(partition, offset, size) || offset % 4096 != 0 || size % 4096 != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  FILE* file = openPartition();
+  if (!file) return ESP_FAIL;
+  std::vector<uint8_t> erased(size, 0xFF);
+  bool ok = fseek(file, offset, SEEK_SET) == 0 && fwrite(erased.data(), 1, size, file) == size;
+  fclose(file);
+  delay(jitterMs(SIM_FLASH_ERASE_MS * (size / 4096)));
+  simShared->result.flashErases++;
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+// ---- AHT20 ----
+
+bool Adafruit_AHTX0::begin(TwoWire* wire, int32_t sensorId, uint8_t address) {
+  delay(jitterMs(SIM_AHT20_INIT_MS));
+  return true;
+}
+
+bool Adafruit_AHTX0::getEvent(sensors_event_t* humidity, sensors_event_t* temperature) {
+  delay(jitterMs(SIM_AHT20_MEASURE_MS));
+  if (simWorld.sensorFails(simRandom())) {
+    return false;
+  }
+  int64_t now = simWorldUs();
+  temperature->temperature = simWorld.temperatureC(now) + noise(0.3f);
+  humidity->relative_humidity = simWorld.humidityPct(now) + noise(2.0f);
+  return true;
+}
+
+// ---- BMP280 (registradores no barramento I2C) ----
+
+// Coeficientes do exemplo do datasheet (seção 3.12), na ordem de BMP280_REG_CALIB
+static const Bmp280Calibration simBmpCalibration = {
+  27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000
+};
+
+// Estado do sensor neste wake: presença sorteada na primeira transação, como um sensor
+// que some do barramento; no modo forçado os registradores de dados só mudam no fim da
+// conversão, com o tempo máximo do datasheet (seção 3.8.1)
+static struct {
+  bool probed = false;
+  bool present = false;
+  uint8_t pointer = 0;
+  uint8_t ctrlMeas = 0;
+  uint8_t config = 0;
+  uint8_t data[BMP280_DATA_BYTES] = {0x80, 0, 0, 0x80, 0, 0};
+  uint8_t pending[BMP280_DATA_BYTES];
+  int64_t readyUs = 0;
+  bool converting = false;
+} simBmp;
+
+static float simBmpConversionMs(uint8_t ctrlMeas) {
+  uint8_t tempSampling = ctrlMeas >> 5;
+  uint8_t pressSampling = (ctrlMeas >> 2) & 0x07;
+  float ms = 1.25f;
+  if (tempSampling != 0) ms += 2.3f * (1 << (tempSampling - 1));
+  if (pressSampling != 0) ms += 2.3f * (1 << (pressSampling - 1)) + 0.575f;
+  return ms;
+}
+
+// Valores do ADC cuja compensação dá a temperatura (°C) e a pressão (Pa) pedidas, por
+// busca binária: a temperatura cresce com o ADC e a pressão diminui. BMP280_ADC_SKIPPED
+// (medida desligada) é trocado pelo valor seguinte
+static int32_t simBmpAdc(int32_t adc) {
+  return adc == BMP280_ADC_SKIPPED ? adc + 1 : adc;
+}
+
+static void simBmpEncode(float temperature, float pressurePa, uint8_t* data) {
+  float t, p;
+  int32_t low = 0, high = 0xFFFFF;
+  while (low < high) {
+    int32_t mid = (low + high) / 2;
+    bmp280CompensateAdc(simBmpCalibration, simBmpAdc(mid), 0x60000, t, p);
+    if (t < temperature) low = mid + 1; else high = mid;
+  }
+  int32_t adcTemperature = simBmpAdc(low);
+  low = 0;
+  high = 0xFFFFF;
+  while (low < high) {
+    int32_t mid = (low + high) / 2;
+    bmp280CompensateAdc(simBmpCalibration, adcTemperature, simBmpAdc(mid), t, p);
+    if (p > pressurePa) low = mid + 1; else high = mid;
+  }
+  int32_t adcPressure = simBmpAdc(low);
+  data[0] = adcPressure >> 12;
+  data[1] = (adcPressure >> 4) & 0xFF;
+  data[2] = (adcPressure & 0x0F) << 4;
+  data[3] = adcTemperature >> 12;
+  data[4] = (adcTemperature >> 4) & 0xFF;
+  data[5] = (adcTemperature & 0x0F) << 4;
+}
+
+// Fim de uma conversão em andamento: os dados ficam visíveis e o sensor volta a dormir
+static void simBmpUpdate() {
+  if (simBmp.converting && simWorldUs() >= simBmp.readyUs) {
+    memcpy(simBmp.data, simBmp.pending, sizeof(simBmp.data));
+    simBmp.ctrlMeas &= ~0x03;
+    simBmp.converting = false;
+  }
+}
+
+static uint8_t simBmpRegister(uint8_t reg) {
+  if (reg >= BMP280_REG_CALIB && reg < BMP280_REG_CALIB + BMP280_CALIB_BYTES) {
+    const uint8_t* calibration = (const uint8_t*)&simBmpCalibration;
+    return calibration[reg - BMP280_REG_CALIB];  // Little-endian, como no sensor
+  }
+  if (reg >= BMP280_REG_DATA && reg < BMP280_REG_DATA + BMP280_DATA_BYTES) {
+    return simBmp.data[reg - BMP280_REG_DATA];
+  }
+  switch (reg) {
+    case BMP280_REG_CHIP_ID: return BMP280_CHIP_ID;
+    case BMP280_REG_STATUS: return simBmp.converting ? BMP280_STATUS_MEASURING : 0;
+    case BMP280_REG_CTRL_MEAS: return simBmp.ctrlMeas;
+    case BMP280_REG_CONFIG: return simBmp.config;
+  }
+  return 0;
+}
+
+static void simBmpWrite(uint8_t reg, uint8_t value) {
+  if (reg == BMP280_REG_CONFIG) {
+    simBmp.config = value;
+  } else if (reg == BMP280_REG_CTRL_MEAS) {
+    simBmp.ctrlMeas = value;
+    if ((value & 0x03) == BMP280_MODE_FORCED) {
+      int64_t now = simWorldUs();
+      simBmpEncode(simWorld.temperatureC(now) + noise(0.5f),
+                   (simWorld.pressureHpa(now) + noise(0.12f)) * 100.0f, simBmp.pending);
+      simBmp.readyUs = now + (int64_t)(simBmpConversionMs(value) * 1000.0f);
+      simBmp.converting = true;
+    }
+  }
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t value) {
+  if (_txLength >= sizeof(_tx)) {
+    return 0;
+  }
+  _tx[_txLength++] = value;
+  return 1;
+}
+
+// 0 = sucesso, 2 = endereço sem ACK (como no Arduino)
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  delayMicroseconds(SIM_I2C_BYTE_US * (_txLength + 1));
+  if (_address != BMP280_ADDRESS) {
+    return 2;
+  }
+  if (!simBmp.probed) {
+    simBmp.probed = true;
+    simBmp.present = !simWorld.sensorFails(simRandom());
+  }
+  if (!simBmp.present) {
+    return 2;
+  }
+  simBmpUpdate();
+  if (_txLength > 0) {
+    simBmp.pointer = _tx[0];
+  }
+  for (uint8_t i = 1; i < _txLength; i++) {
+    simBmpWrite(simBmp.pointer++, _tx[i]);
+  }
+  return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+  delayMicroseconds(SIM_I2C_BYTE_US * (quantity + 1));
+  _rxLength = 0;
+  _rxIndex = 0;
+  if (address != BMP280_ADDRESS || !simBmp.present || quantity > sizeof(_rx)) {
+    return 0;
+  }
+  simBmpUpdate();
+  for (uint8_t i = 0; i < quantity; i++) {
+    _rx[_rxLength++] = simBmpRegister(simBmp.pointer++);
+  }
+  return _rxLength;
+}
+
+// ---- DHT22 ----
+
+float DHT::readTemperature(bool fahrenheit, bool force) {
+  delay(jitterMs(SIM_DHT22_READ_MS));
+  if (simWorld.sensorFails(simRandom())) {
+    return NAN;
+  }
+  float celsius = simWorld.temperatureC(simWorldUs()) + noise(0.5f);
+  return fahrenheit ? celsius * 1.8f + 32.0f : celsius;
+}
+
+float DHT::readHumidity(bool force) {
+  delay(jitterMs(SIM_DHT22_READ_MS));
+  if (simWorld.sensorFails(simRandom())) {
+    return NAN;
+  }
+  return simWorld.humidityPct(simWorldUs()) + noise(2.0f);
+}
+
+// ---- BLE ----
+
+static NimBLEServer bleServer;
+static NimBLEAdvertising bleAdvertising;
+
+void NimBLEDevice::init(const std::string& deviceName) {
+  delay(jitterMs(45));
+  simSetBle(true);
+}
+
+void NimBLEDevice::deinit(bool clearAll) {
+  simSetBle(false);
+}
+
+NimBLEServer* NimBLEDevice::createServer() {
+  return &bleServer;
+}
+
+NimBLEAdvertising* NimBLEDevice::getAdvertising() {
+  return &bleAdvertising;
+}
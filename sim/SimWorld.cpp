@@ -0,0 +1,199 @@
+#include "SimWorld.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+SimWorld simWorld;
+
+static const SimScenario scenarios[] = {
+  {
+    "calm", "Dia sem chuva, rede estável",
+    24.0,
+    {}, 0,
+    {}, 0,
+    {}, 0,
+    {0, 0}, 0.0,
+    0.0
+  },
+  {
+    "storm", "Queda de pressão seguida de tempestade (chuvisco, 40 mm/h, chuva moderada)",
+    24.0,
+    {{{8.0, 1.0}, 4.0}, {{9.0, 2.0}, 40.0}, {{11.0, 3.0}, 8.0}}, 3,
+    {}, 0,
+    {}, 0,
+    {4.0, 6.0}, 6.0,
+    0.0
+  },
+  {
+    "cloudburst", "Chuva o dia todo com um aguaceiro de 80 mm/h (mais de 200 mm em 24 h)",
+    24.0,
+    {{{1.0, 22.0}, 6.0}, {{10.0, 1.0}, 80.0}}, 2,
+    {}, 0,
+    {}, 0,
+    {0.0, 3.0}, 4.0,
+    0.0
+  },
+  {
+    "outage", "Chuva fraca com o ponto de acesso fora do ar por 3 h e o broker por 2 h",
+    24.0,
+    {{{2.0, 4.0}, 2.0}}, 1,
+    {{6.0, 3.0}}, 1,
+    {{14.0, 2.0}}, 1,
+    {0, 0}, 0.0,
+    0.0
+  },
+  {
+    "flaky", "Sensores falhando em 30% das leituras",
+    12.0,
+    {}, 0,
+    {}, 0,
+    {}, 0,
+    {0, 0}, 0.0,
+    0.3
+  },
+  {
+    "deadsensor", "Sensores sem resposta (cabo solto) o tempo todo",
+    12.0,
+    {}, 0,
+    {}, 0,
+    {}, 0,
+    {0, 0}, 0.0,
+    1.0
+  },
+  {
+    "battery", "Chuva com a bateria trocada duas vezes no meio dela (RTC perdido, relógio em 1970)",
+    24.0,
+    {{{2.0, 12.0}, 6.0}}, 1,
+    {}, 0,
+    {}, 0,
+    {0, 0}, 0.0,
+    0.0,
+    {{5.0, 0.25}, {10.5, 0.1}}, 2
+  },
+};
+
+const SimScenario* simScenarios(uint8_t& count) {
+  count = sizeof(scenarios) / sizeof(scenarios[0]);
+  return scenarios;
+}
+
+const SimScenario* simFindScenario(const char* name) {
+  for (const SimScenario& scenario : scenarios) {
+    if (strcmp(scenario.name, name) == 0) {
+      return &scenario;
+    }
+  }
+  return nullptr;
+}
+
+void SimWorld::build(const SimScenario& scenario, double hours, uint32_t seed, double mmPerTip) {
+  _scenario = &scenario;
+  _startUs = SIM_START_EPOCH * 1000000LL;
+  _endUs = _startUs + (int64_t)(hours * SIM_US_PER_HOUR);
+
+  // Basculadas como processo de Poisson com a intensidade de cada episódio
+  uint32_t rng = seed * 2654435761UL + 1;
+  _tips.clear();
+  for (uint8_t i = 0; i < scenario.rainCount; i++) {
+    const SimRainEpisode& episode = scenario.rain[i];
+    double tipsPerUs = episode.mmPerHour / mmPerTip / SIM_US_PER_HOUR;
+    int64_t t = _startUs + (int64_t)(episode.window.startHours * SIM_US_PER_HOUR);
+    int64_t end = t + (int64_t)(episode.window.hours * SIM_US_PER_HOUR);
+    while (true) {
+      double u = (nextRandom(rng) + 1.0) / 4294967297.0;
+      t += (int64_t)(-log(u) / tipsPerUs);
+      if (t >= end) break;
+      _tips.push_back(t);
+    }
+  }
+  std::sort(_tips.begin(), _tips.end());
+}
+
+bool SimWorld::rainContactClosed(int64_t worldUs) const {
+  // Última basculada até worldUs ainda com o contato fechado
+  auto it = std::upper_bound(_tips.begin(), _tips.end(), worldUs);
+  if (it == _tips.begin()) return false;
+  return worldUs - *(it - 1) < SIM_RAIN_CONTACT_MS * 1000LL;
+}
+
+int64_t SimWorld::nextTipAtOrAfter(int64_t worldUs) const {
+  auto it = std::lower_bound(_tips.begin(), _tips.end(), worldUs);
+  return it == _tips.end() ? INT64_MAX : *it;
+}
+
+uint32_t SimWorld::tipsBetween(int64_t fromUs, int64_t toUs) const {
+  return (uint32_t)(std::lower_bound(_tips.begin(), _tips.end(), toUs) -
+                    std::lower_bound(_tips.begin(), _tips.end(), fromUs));
+}
+
+bool SimWorld::inWindow(const SimWindow* windows, uint8_t count, int64_t worldUs) const {
+  double hours = (double)(worldUs - _startUs) / SIM_US_PER_HOUR;
+  for (uint8_t i = 0; i < count; i++) {
+    if (hours >= windows[i].startHours && hours < windows[i].startHours + windows[i].hours) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SimWorld::wifiUp(int64_t worldUs) const {
+  return !inWindow(_scenario->wifiOutages, _scenario->wifiOutageCount, worldUs);
+}
+
+bool SimWorld::brokerUp(int64_t worldUs) const {
+  return wifiUp(worldUs) &&
+         !inWindow(_scenario->brokerOutages, _scenario->brokerOutageCount, worldUs);
+}
+
+bool SimWorld::sensorFails(uint32_t draw) const {
+  return draw < _scenario->sensorFailRate * 4294967295.0;
+}
+
+float SimWorld::temperatureC(int64_t worldUs) const {
+  double hours = (double)(worldUs - _startUs) / SIM_US_PER_HOUR;
+  // Mínima às 3 h, máxima às 15 h; a chuva esfria o ar
+  double t = 20.0 + 6.0 * sin(2.0 * M_PI * (hours - 9.0) / 24.0);
+  if (rainContactClosed(worldUs) || tipsBetween(worldUs - SIM_US_PER_HOUR, worldUs) > 0) {
+    t -= 3.0;
+  }
+  return (float)t;
+}
+
+float SimWorld::humidityPct(int64_t worldUs) const {
+  double hours = (double)(worldUs - _startUs) / SIM_US_PER_HOUR;
+  double h = 70.0 - 20.0 * sin(2.0 * M_PI * (hours - 9.0) / 24.0);
+  if (tipsBetween(worldUs - SIM_US_PER_HOUR, worldUs) > 0) {
+    h += 25.0;
+  }
+  return (float)std::min(h, 99.0);
+}
+
+float SimWorld::pressureHpa(int64_t worldUs) const {
+  double hours = (double)(worldUs - _startUs) / SIM_US_PER_HOUR;
+  // Maré barométrica semidiurna (~1 hPa) mais a queda do cenário
+  double p = 1013.0 + 0.8 * sin(2.0 * M_PI * hours / 12.0);
+  const SimWindow& drop = _scenario->pressureDrop;
+  if (drop.hours > 0 && hours > drop.startHours) {
+    double progress = std::min(1.0, (hours - drop.startHours) / drop.hours);
+    p -= _scenario->pressureDropHpa * progress;
+  }
+  return (float)p;
+}
+
+float SimWorld::batteryVoltage(double consumedMah, double capacityMah) {
+  double remaining = std::max(0.0, 1.0 - consumedMah / capacityMah);
+  return (float)(3.3 + 0.9 * remaining);
+}
+
+uint32_t SimWorld::nextRandom(uint32_t& rng) {
+  // xorshift32
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return rng;
+}
+
+uint32_t SimWorld::jitterMs(uint32_t baseMs, uint32_t& rng) {
+  double factor = 1.0 + SIM_JITTER * (2.0 * nextRandom(rng) / 4294967295.0 - 1.0);
+  return (uint32_t)(baseMs * factor);
+}
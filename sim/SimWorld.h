@@ -0,0 +1,113 @@
+#ifndef SIM_WORLD_H
+#define SIM_WORLD_H
+
+#include <stdint.h>
+#include <vector>
+
+// Mundo simulado: tempo real (virtual), chuva, rede, ambiente e bateria.
+// Construído pelo driver antes do primeiro wake; os processos de cada wake
+// herdam uma cópia e apenas o consultam.
+
+#define SIM_US_PER_MINUTE 60000000LL
+#define SIM_US_PER_HOUR 3600000000LL
+
+// Latências de hardware e rede (ms), com variação aleatória de ±SIM_JITTER
+#define SIM_BOOT_DEEP_SLEEP_MS 60     // ROM + bootloader ao acordar do deep sleep
+#define SIM_BOOT_POWER_ON_MS 320      // Power-on/reset: inclui verificação da imagem
+#define SIM_WIFI_SCAN_MS 1400         // Varredura de todos os canais
+#define SIM_WIFI_ASSOC_MS 250         // Autenticação + associação + handshake WPA2
+#define SIM_WIFI_DHCP_MS 650          // DHCP completo (DISCOVER ... ACK)
+#define SIM_WIFI_EVENT_MS 5           // Entrega do GOT_IP pela tarefa de eventos, com WiFi.status() já conectado
+#define SIM_NTP_MS 90                 // DNS + troca SNTP
+#define SIM_TCP_CONNECT_MS 25         // Conexão TCP na rede local
+#define SIM_MQTT_CONNACK_MS 60        // CONNECT/CONNACK
+#define SIM_MQTT_PUBLISH_MS 15        // Envio de um PUBLISH QoS 0
+#define SIM_HTTP_REQUEST_MS 120       // PUT na API do nó Meshtastic
+#define SIM_AHT20_INIT_MS 40          // Calibração do AHT20
+#define SIM_AHT20_MEASURE_MS 80       // Conversão do AHT20
+#define SIM_I2C_BYTE_US 90            // Um byte e o ACK no barramento I2C a 100 kHz
+#define SIM_DHT22_READ_MS 6           // Protocolo de um fio do DHT22
+#define SIM_FLASH_WRITE_MS 1          // Programação de uma página de 256 bytes
+#define SIM_FLASH_ERASE_MS 45         // Apagamento de um setor de 4 KB
+#define SIM_FLASH_READ_BYTES_PER_US 4 // Leitura do flash pela SPI
+#define SIM_JITTER 0.2
+
+#define SIM_RAIN_CONTACT_MS 80        // Tempo que a báscula mantém o contato fechado
+#define SIM_RTC_DRIFT_PPM 150         // Erro do relógio RTC (oscilador de 150 kHz) durante o sono
+#define SIM_START_EPOCH 1717200000LL  // 2024-06-01 00:00:00 UTC
+#define SIM_RAIN_LOG_PARTITION_SIZE 0x10000  // Partição "rainlog" de partitions.csv
+
+// Intervalo [início, início + duração) em horas desde o início da simulação
+struct SimWindow {
+  double startHours;
+  double hours;
+};
+
+struct SimRainEpisode {
+  SimWindow window;
+  double mmPerHour;
+};
+
+struct SimScenario {
+  const char* name;
+  const char* description;
+  double hours;                      // Duração padrão
+  SimRainEpisode rain[4];
+  uint8_t rainCount;
+  SimWindow wifiOutages[4];          // Ponto de acesso fora do ar
+  uint8_t wifiOutageCount;
+  SimWindow brokerOutages[4];        // Rede local funcionando, broker/nó inacessível
+  uint8_t brokerOutageCount;
+  SimWindow pressureDrop;            // Queda de pressão antes da frente de chuva
+  double pressureDropHpa;
+  double sensorFailRate;             // Probabilidade de uma leitura de sensor falhar
+  SimWindow powerCuts[4];            // Sem energia (troca de bateria, brownout) a partir do sono
+  uint8_t powerCutCount;
+};
+
+// Cenários embutidos; nullptr se o nome não existir
+const SimScenario* simFindScenario(const char* name);
+const SimScenario* simScenarios(uint8_t& count);
+
+class SimWorld {
+public:
+  void build(const SimScenario& scenario, double hours, uint32_t seed, double mmPerTip);
+
+  const SimScenario& scenario() const { return *_scenario; }
+  int64_t startUs() const { return _startUs; }
+  int64_t endUs() const { return _endUs; }
+
+  // Basculadas: nível do contato e primeira basculada a partir de um instante
+  bool rainContactClosed(int64_t worldUs) const;
+  int64_t nextTipAtOrAfter(int64_t worldUs) const;   // INT64_MAX se não houver
+  uint32_t tipsBetween(int64_t fromUs, int64_t toUs) const;
+  uint32_t totalTips() const { return (uint32_t)_tips.size(); }
+
+  bool wifiUp(int64_t worldUs) const;
+  bool brokerUp(int64_t worldUs) const;
+  bool sensorFails(uint32_t draw) const;
+
+  // Ambiente
+  float temperatureC(int64_t worldUs) const;
+  float humidityPct(int64_t worldUs) const;
+  float pressureHpa(int64_t worldUs) const;
+
+  // Tensão da bateria após consumir consumedMah de capacityMah
+  static float batteryVoltage(double consumedMah, double capacityMah);
+
+  // Latência com variação pseudoaleatória determinística
+  static uint32_t jitterMs(uint32_t baseMs, uint32_t& rng);
+  static uint32_t nextRandom(uint32_t& rng);
+
+private:
+  bool inWindow(const SimWindow* windows, uint8_t count, int64_t worldUs) const;
+
+  const SimScenario* _scenario;
+  int64_t _startUs;
+  int64_t _endUs;
+  std::vector<int64_t> _tips;        // Instantes das basculadas (us desde a epoch), em ordem
+};
+
+extern SimWorld simWorld;
+
+#endif // SIM_WORLD_H
@@ -0,0 +1,17 @@
+#ifndef SIM_ADAFRUIT_AHTX0_H
+#define SIM_ADAFRUIT_AHTX0_H
+
+#include "Arduino.h"
+#include "Wire.h"
+#include "Adafruit_Sensor.h"
+
+#define AHTX0_I2CADDR_DEFAULT 0x38
+
+// AHT20 simulado: lê temperatura e umidade do ambiente do cenário
+class Adafruit_AHTX0 {
+public:
+  bool begin(TwoWire* wire = &Wire, int32_t sensorId = 0, uint8_t address = AHTX0_I2CADDR_DEFAULT);
+  bool getEvent(sensors_event_t* humidity, sensors_event_t* temperature);
+};
+
+#endif // SIM_ADAFRUIT_AHTX0_H
@@ -0,0 +1,274 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+// Subconjunto do core Arduino-ESP32 usado pelo firmware, sobre o relógio virtual do simulador
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdarg.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <string>
+
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "driver/gpio.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+
+#define DEC 10
+#define HEX 16
+
+#define F(string) (string)
+#define ADC_11db 3
+#define ADC_ATTEN_DB_12 3
+#define ADC_WIDTH_BIT_12 3
+
+// Seções críticas do FreeRTOS: o simulador tem uma única thread
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::min;
+using std::max;
+
+template <class T, class L, class H>
+T constrain(T x, L low, H high) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+class String {
+public:
+  String() {}
+  String(const char* text) : _s(text ? text : "") {}
+  String(const std::string& text) : _s(text) {}
+  String(char c) : _s(1, c) {}
+  String(int value, unsigned char base = DEC) : _s(format(base == HEX ? "%x" : "%d", value)) {}
+  String(unsigned int value, unsigned char base = DEC) : _s(format(base == HEX ? "%x" : "%u", value)) {}
+  String(long value, unsigned char base = DEC) : _s(format(base == HEX ? "%lx" : "%ld", value)) {}
+  String(unsigned long value, unsigned char base = DEC) : _s(format(base == HEX ? "%lx" : "%lu", value)) {}
+  String(long long value, unsigned char base = DEC) : _s(format(base == HEX ? "%llx" : "%lld", value)) {}
+  String(unsigned long long value, unsigned char base = DEC) : _s(format(base == HEX ? "%llx" : "%llu", value)) {}
+  String(float value, unsigned int decimals = 2) : _s(format("%.*f", decimals, (double)value)) {}
+  String(double value, unsigned int decimals = 2) : _s(format("%.*f", decimals, value)) {}
+
+  const char* c_str() const { return _s.c_str(); }
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  bool isEmpty() const { return _s.empty(); }
+  bool reserve(unsigned int size) { _s.reserve(size); return true; }
+
+  bool concat(const String& other) { _s += other._s; return true; }
+  bool concat(const char* text) { if (text) _s += text; return true; }
+  bool concat(const char* text, unsigned int length) { _s.append(text, length); return true; }
+  bool concat(char c) { _s += c; return true; }
+
+  String& operator+=(const String& other) { concat(other); return *this; }
+  String& operator+=(const char* text) { concat(text); return *this; }
+  String& operator+=(char c) { concat(c); return *this; }
+  template <typename T>
+  String& operator+=(T value) { concat(String(value)); return *this; }
+
+  bool operator==(const String& other) const { return _s == other._s; }
+  bool operator==(const char* text) const { return _s == (text ? text : ""); }
+  bool operator!=(const String& other) const { return _s != other._s; }
+  bool operator!=(const char* text) const { return !(*this == text); }
+  char operator[](unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+  char charAt(unsigned int index) const { return (*this)[index]; }
+
+  long toInt() const { return atol(_s.c_str()); }
+  float toFloat() const { return (float)atof(_s.c_str()); }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t pos = _s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  int indexOf(const char* text, unsigned int from = 0) const {
+    size_t pos = _s.find(text, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+  }
+  String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    return from < _s.size() && to > from ? String(_s.substr(from, to - from)) : String();
+  }
+  bool startsWith(const char* prefix) const { return _s.compare(0, strlen(prefix), prefix) == 0; }
+  bool endsWith(const char* suffix) const {
+    size_t n = strlen(suffix);
+    return _s.size() >= n && _s.compare(_s.size() - n, n, suffix) == 0;
+  }
+  void trim() {
+    size_t first = _s.find_first_not_of(" \t\r\n");
+    size_t last = _s.find_last_not_of(" \t\r\n");
+    _s = first == std::string::npos ? std::string() : _s.substr(first, last - first + 1);
+  }
+
+private:
+  static std::string format(const char* fmt, ...) {
+    char buffer[48];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buffer, sizeof(buffer), fmt, args);
+    va_end(args);
+    return buffer;
+  }
+
+  std::string _s;
+};
+
+// Resultado de concatenações, como no core (ArduinoJson conhece este tipo)
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String& s) : String(s) {}
+};
+
+inline StringSumHelper operator+(const StringSumHelper& lhs, const String& rhs) {
+  StringSumHelper result(lhs);
+  result.concat(rhs);
+  return result;
+}
+inline StringSumHelper operator+(const String& lhs, const String& rhs) {
+  StringSumHelper result(lhs);
+  result.concat(rhs);
+  return result;
+}
+inline StringSumHelper operator+(const String& lhs, const char* rhs) {
+  StringSumHelper result(lhs);
+  result.concat(rhs);
+  return result;
+}
+inline StringSumHelper operator+(const char* lhs, const String& rhs) {
+  StringSumHelper result{String(lhs)};
+  result.concat(rhs);
+  return result;
+}
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+
+  size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+  size_t print(const char* text) { return write(text); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(unsigned int value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(unsigned long value, int base = DEC) { return print(String(value, (unsigned char)base)); }
+  size_t print(double value, int decimals = 2) { return print(String(value, (unsigned int)decimals)); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T& value) { return print(value) + println(); }
+  template <typename T>
+  size_t println(const T& value, int format) { return print(value, format) + println(); }
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (length < 0) return 0;
+    return write((const uint8_t*)buffer, std::min((size_t)length, sizeof(buffer) - 1));
+  }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  virtual void flush() {}
+  void setTimeout(unsigned long timeoutMs) { _timeoutMs = timeoutMs; }
+  size_t readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+      int c = read();
+      if (c < 0) break;
+      buffer[count++] = (char)c;
+    }
+    return count;
+  }
+  size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+  String readString() {
+    String s;
+    int c;
+    while ((c = read()) >= 0) s += (char)c;
+    return s;
+  }
+
+protected:
+  unsigned long _timeoutMs = 1000;
+};
+
+// UART0: só escreve no stdout do simulador quando há "host conectado" (--log)
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  void end() {}
+  operator bool() const { return true; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void analogSetAttenuation(int attenuation);
+
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+long random(long max);
+long random(long min, long max);
+
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+class EspClass {
+public:
+  [[noreturn]] void restart();
+  uint64_t getEfuseMac();
+  uint32_t getFreeHeap();
+};
+
+extern EspClass ESP;
+
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+
+#endif // SIM_ARDUINO_H
@@ -0,0 +1,19 @@
+#ifndef SIM_DHT_H
+#define SIM_DHT_H
+
+#include "Arduino.h"
+
+#define DHT11 11
+#define DHT21 21
+#define DHT22 22
+
+// DHT22 simulado: NAN nas leituras que o cenário faz falhar
+class DHT {
+public:
+  DHT(uint8_t pin, uint8_t type, uint8_t count = 6) {}
+  void begin(uint8_t pullTimeUs = 55) {}
+  float readTemperature(bool fahrenheit = false, bool force = false);
+  float readHumidity(bool force = false);
+};
+
+#endif // SIM_DHT_H
@@ -0,0 +1,66 @@
+#ifndef SIM_ESP_ASYNC_WEB_SERVER_H
+#define SIM_ESP_ASYNC_WEB_SERVER_H
+
+// Servidor do portal simulado: as rotas são registradas mas nenhuma requisição chega
+
+#include "Arduino.h"
+#include "FS.h"
+#include "WiFi.h"
+#include <functional>
+
+#define HTTP_GET 0x01
+#define HTTP_POST 0x02
+#define HTTP_ANY 0x7F
+
+class AsyncWebParameter {
+public:
+  const String& value() const { return _value; }
+
+private:
+  String _value;
+};
+
+class AsyncWebServerResponse {
+public:
+  virtual ~AsyncWebServerResponse() {}
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+  size_t write(uint8_t c) override { return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return size; }
+  using Print::write;
+};
+
+class AsyncWebServerRequest {
+public:
+  bool hasParam(const String& name, bool post = false, bool file = false) const { return false; }
+  AsyncWebParameter* getParam(const String& name, bool post = false, bool file = false) const { return nullptr; }
+  AsyncResponseStream* beginResponseStream(const String& contentType, size_t bufferSize = 1460) {
+    return new AsyncResponseStream();
+  }
+  void send(AsyncWebServerResponse* response) { delete response; }
+  void send(int code, const String& contentType = String(), const String& content = String()) {}
+};
+
+typedef std::function<void(AsyncWebServerRequest* request)> ArRequestHandlerFunction;
+
+class AsyncStaticWebHandler {
+public:
+  AsyncStaticWebHandler& setDefaultFile(const char* filename) { return *this; }
+};
+
+class AsyncWebServer {
+public:
+  AsyncWebServer(uint16_t port) {}
+  void begin() {}
+  void end() {}
+  void on(const char* uri, int method, ArRequestHandlerFunction handler) {}
+  AsyncStaticWebHandler& serveStatic(const char* uri, fs::FS& fs, const char* path) { return _static; }
+  void onNotFound(ArRequestHandlerFunction handler) {}
+
+private:
+  AsyncStaticWebHandler _static;
+};
+
+#endif // SIM_ESP_ASYNC_WEB_SERVER_H
@@ -0,0 +1,51 @@
+#ifndef SIM_FS_H
+#define SIM_FS_H
+
+#include "Arduino.h"
+#include <memory>
+
+// Sistema de arquivos sobre um diretório do host (simFsRoot), que persiste entre os wakes
+namespace fs {
+
+class File : public Stream {
+public:
+  File() {}
+  explicit File(FILE* file) : _file(file, fclose) {}
+
+  operator bool() const { return (bool)_file; }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t read(uint8_t* buffer, size_t size);
+  void flush() override;
+  bool seek(uint32_t position);
+  size_t position() const;
+  size_t size() const;
+  void close() { _file.reset(); }
+
+private:
+  std::shared_ptr<FILE> _file;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = "r", bool create = false);
+  File open(const String& path, const char* mode = "r", bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // SIM_FS_H
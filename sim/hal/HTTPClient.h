@@ -0,0 +1,40 @@
+#ifndef SIM_HTTP_CLIENT_H
+#define SIM_HTTP_CLIENT_H
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+// Requisições ao nó Meshtastic: entregues se o "broker" do cenário estiver no ar
+class HTTPClient {
+public:
+  bool begin(const String& url);
+  void end() {}
+  void addHeader(const String& name, const String& value) {}
+  void setConnectTimeout(int32_t timeoutMs) { _connectTimeoutMs = timeoutMs; }
+  void setTimeout(uint16_t timeoutMs) { _timeoutMs = timeoutMs; }
+  int PUT(const String& payload);
+  int POST(const String& payload);
+  String getString() { return String(); }
+
+  static String errorToString(int error);
+
+private:
+  int request(const String& payload);
+
+  int32_t _connectTimeoutMs = 5000;
+  uint16_t _timeoutMs = 5000;
+};
+
+#endif // SIM_HTTP_CLIENT_H
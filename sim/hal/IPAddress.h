@@ -0,0 +1,39 @@
+#ifndef SIM_IP_ADDRESS_H
+#define SIM_IP_ADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress {
+public:
+  IPAddress() : _address(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t address) : _address(address) {}
+
+  operator uint32_t() const { return _address; }
+  bool operator==(const IPAddress& other) const { return _address == other._address; }
+  uint8_t operator[](int index) const { return (_address >> (8 * index)) & 0xFF; }
+
+  bool fromString(const char* text) {
+    unsigned a, b, c, d;
+    char extra;
+    if (sscanf(text, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4 ||
+        a > 255 || b > 255 || c > 255 || d > 255) {
+      return false;
+    }
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+  bool fromString(const String& text) { return fromString(text.c_str()); }
+
+  String toString() const {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buffer);
+  }
+
+private:
+  uint32_t _address;  // Primeiro octeto no byte menos significativo, como no lwIP
+};
+
+#endif // SIM_IP_ADDRESS_H
@@ -0,0 +1,18 @@
+#ifndef SIM_LITTLE_FS_H
+#define SIM_LITTLE_FS_H
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+  bool format();
+  void end() {}
+  size_t totalBytes() { return 0x30000; }
+  size_t usedBytes() { return 0; }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // SIM_LITTLE_FS_H
@@ -0,0 +1,80 @@
+#ifndef SIM_NIMBLE_DEVICE_H
+#define SIM_NIMBLE_DEVICE_H
+
+// BLE simulado: nenhum cliente se conecta; só o tempo com o rádio ligado é contabilizado
+
+#include "Arduino.h"
+
+#define ESP_PWR_LVL_P9 7
+
+namespace NIMBLE_PROPERTY {
+  enum { READ = 0x0002, WRITE_NR = 0x0004, WRITE = 0x0008, NOTIFY = 0x0010 };
+}
+
+class NimBLEServer;
+class NimBLECharacteristic;
+
+class NimBLEServerCallbacks {
+public:
+  virtual ~NimBLEServerCallbacks() {}
+  virtual void onConnect(NimBLEServer* server) {}
+  virtual void onDisconnect(NimBLEServer* server) {}
+};
+
+class NimBLECharacteristicCallbacks {
+public:
+  virtual ~NimBLECharacteristicCallbacks() {}
+  virtual void onRead(NimBLECharacteristic* characteristic) {}
+  virtual void onWrite(NimBLECharacteristic* characteristic) {}
+};
+
+class NimBLECharacteristic {
+public:
+  void setCallbacks(NimBLECharacteristicCallbacks* callbacks) {}
+  void setValue(const char* value) { _value = value; }
+  void setValue(const String& value) { _value = value.c_str(); }
+  void setValue(const std::string& value) { _value = value; }
+  std::string getValue() { return _value; }
+
+private:
+  std::string _value;
+};
+
+class NimBLEService {
+public:
+  NimBLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties) { return &_characteristic; }
+  bool start() { return true; }
+
+private:
+  NimBLECharacteristic _characteristic;
+};
+
+class NimBLEServer {
+public:
+  void setCallbacks(NimBLEServerCallbacks* callbacks) {}
+  NimBLEService* createService(const char* uuid) { return &_service; }
+
+private:
+  NimBLEService _service;
+};
+
+class NimBLEAdvertising {
+public:
+  void addServiceUUID(const char* uuid) {}
+  void setScanResponse(bool enabled) {}
+  void setMinPreferred(uint16_t interval) {}
+  void setMaxPreferred(uint16_t interval) {}
+};
+
+class NimBLEDevice {
+public:
+  static void init(const std::string& deviceName);
+  static void deinit(bool clearAll = false);
+  static void setPower(int powerLevel) {}
+  static NimBLEServer* createServer();
+  static NimBLEAdvertising* getAdvertising();
+  static bool startAdvertising() { return true; }
+  static bool stopAdvertising() { return true; }
+};
+
+#endif // SIM_NIMBLE_DEVICE_H
@@ -0,0 +1,40 @@
+#ifndef SIM_PUB_SUB_CLIENT_H
+#define SIM_PUB_SUB_CLIENT_H
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define MQTT_CONNECTION_TIMEOUT (-4)
+#define MQTT_CONNECTION_LOST (-3)
+#define MQTT_CONNECT_FAILED (-2)
+#define MQTT_DISCONNECTED (-1)
+#define MQTT_CONNECTED 0
+
+// Broker simulado: as publicações entregues são contadas no resultado do wake
+class PubSubClient {
+public:
+  PubSubClient(Client& client) : _client(&client) {}
+
+  PubSubClient& setServer(const char* domain, uint16_t port) { return *this; }
+  bool setBufferSize(uint16_t size) { _bufferSize = size; return true; }
+  uint16_t getBufferSize() { return _bufferSize; }
+  // Em segundos
+  PubSubClient& setSocketTimeout(uint16_t timeout) { _socketTimeout = timeout; return *this; }
+
+  bool connect(const char* id);
+  bool connect(const char* id, const char* user, const char* pass);
+  void disconnect();
+  bool connected() { return _state == MQTT_CONNECTED; }
+  int state() { return _state; }
+  bool loop() { return connected(); }
+
+  bool publish(const char* topic, const char* payload, bool retained = false);
+
+private:
+  Client* _client;
+  uint16_t _bufferSize = 256;
+  uint16_t _socketTimeout = 15;
+  int _state = MQTT_DISCONNECTED;
+};
+
+#endif // SIM_PUB_SUB_CLIENT_H
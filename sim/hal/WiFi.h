@@ -0,0 +1,98 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+// Estação WiFi simulada: a associação e o DHCP terminam em segundo plano após as
+// latências de SimWorld.h, desde que o ponto de acesso do cenário esteja no ar
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL,
+  WL_SCAN_COMPLETED,
+  WL_CONNECTED,
+  WL_CONNECT_FAILED,
+  WL_CONNECTION_LOST,
+  WL_DISCONNECTED
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_STA_START = 2,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+  ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef union { int unused; } WiFiEventInfo_t;
+typedef void (*WiFiEventFuncCb)(WiFiEvent_t event, WiFiEventInfo_t info);
+
+class WiFiClass {
+public:
+  int onEvent(WiFiEventFuncCb callback, WiFiEvent_t event = ARDUINO_EVENT_MAX);
+
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode();
+  bool persistent(bool persistent) { return true; }
+  bool setAutoReconnect(bool autoReconnect) { return true; }
+  bool setSleep(bool enabled) { return true; }
+
+  wl_status_t begin(const char* ssid, const char* password = nullptr, int32_t channel = 0,
+                    const uint8_t* bssid = nullptr, bool connect = true);
+  bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  wl_status_t status();
+
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t index = 0);
+  uint8_t* BSSID();
+  int32_t channel();
+  int8_t RSSI();
+
+  bool softAP(const char* ssid, const char* password = nullptr);
+  IPAddress softAPIP();
+  bool softAPdisconnect(bool wifiOff = false);
+};
+
+extern WiFiClass WiFi;
+
+class Client : public Stream {
+public:
+  virtual int connect(IPAddress ip, uint16_t port) = 0;
+  virtual int connect(const char* host, uint16_t port) = 0;
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+};
+
+// Conexão TCP: estabelecida se o destino estiver acessível no cenário; senão
+// falha após o timeout de conexão
+class WiFiClient : public Client {
+public:
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  void stop() override { _connected = false; }
+  uint8_t connected() override { return _connected; }
+  size_t write(uint8_t c) override { return _connected ? 1 : 0; }
+  size_t write(const uint8_t* buffer, size_t size) override { return _connected ? size : 0; }
+  using Print::write;
+
+  // Em segundos, como no core 2.x
+  void setTimeout(uint32_t seconds) { _timeoutSeconds = seconds; }
+  uint32_t timeoutSeconds() const { return _timeoutSeconds; }
+
+private:
+  bool _connected = false;
+  uint32_t _timeoutSeconds = 3;
+};
+
+#endif // SIM_WIFI_H
@@ -0,0 +1,32 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include "Arduino.h"
+
+// Barramento I2C a 100 kHz: só o BMP280 é simulado nos registradores (SimPeripherals.cpp);
+// o AHT20 passa pela biblioteca simulada. Cada byte custa o seu tempo no barramento.
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+  bool end() { return true; }
+  bool setClock(uint32_t frequency) { return true; }
+
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t value);
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity);
+  int available() { return _rxLength - _rxIndex; }
+  int read() { return _rxIndex < _rxLength ? _rx[_rxIndex++] : -1; }
+
+private:
+  uint8_t _address = 0;
+  uint8_t _tx[8];
+  uint8_t _txLength = 0;
+  uint8_t _rx[32];
+  uint8_t _rxLength = 0;
+  uint8_t _rxIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
@@ -0,0 +1,21 @@
+#ifndef SIM_DRIVER_RTC_IO_H
+#define SIM_DRIVER_RTC_IO_H
+
+#include "esp_sleep.h"
+
+typedef enum {
+  RTC_GPIO_MODE_INPUT_ONLY,
+  RTC_GPIO_MODE_OUTPUT_ONLY,
+  RTC_GPIO_MODE_INPUT_OUTPUT,
+  RTC_GPIO_MODE_DISABLED
+} rtc_gpio_mode_t;
+
+int rtc_gpio_get_level(gpio_num_t gpio);
+esp_err_t rtc_gpio_init(gpio_num_t gpio);
+esp_err_t rtc_gpio_deinit(gpio_num_t gpio);
+esp_err_t rtc_gpio_set_direction(gpio_num_t gpio, rtc_gpio_mode_t mode);
+esp_err_t rtc_gpio_pullup_dis(gpio_num_t gpio);
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t gpio);
+esp_err_t rtc_gpio_hold_en(gpio_num_t gpio);
+
+#endif // SIM_DRIVER_RTC_IO_H
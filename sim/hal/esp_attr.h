@@ -0,0 +1,13 @@
+#ifndef SIM_ESP_ATTR_H
+#define SIM_ESP_ATTR_H
+
+// No ESP32 estas variáveis ficam na memória RTC lenta. No simulador cada atributo
+// vira uma seção própria do executável, que o driver preserva entre os wakes
+// (RTC_DATA_ATTR: só no deep sleep; RTC_NOINIT_ATTR: também no reset por software).
+#define RTC_DATA_ATTR __attribute__((section("sim_rtc_data")))
+#define RTC_NOINIT_ATTR __attribute__((section("sim_rtc_noinit")))
+#define RTC_SLOW_ATTR RTC_DATA_ATTR
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif // SIM_ESP_ATTR_H
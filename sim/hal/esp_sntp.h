@@ -0,0 +1,11 @@
+#ifndef SIM_ESP_SNTP_H
+#define SIM_ESP_SNTP_H
+
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+// Chamada quando o relógio é ajustado (evento simulado após a latência SIM_NTP_MS)
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+
+#endif // SIM_ESP_SNTP_H
@@ -0,0 +1,66 @@
+#include "Bmp280Compensation.h"
+
+static uint16_t readU16(const uint8_t* raw) {
+  return (uint16_t)(raw[0] | (raw[1] << 8));
+}
+
+void bmp280ParseCalibration(const uint8_t* raw, Bmp280Calibration& calibration) {
+  calibration.t1 = readU16(raw + 0);
+  calibration.t2 = (int16_t)readU16(raw + 2);
+  calibration.t3 = (int16_t)readU16(raw + 4);
+  calibration.p1 = readU16(raw + 6);
+  calibration.p2 = (int16_t)readU16(raw + 8);
+  calibration.p3 = (int16_t)readU16(raw + 10);
+  calibration.p4 = (int16_t)readU16(raw + 12);
+  calibration.p5 = (int16_t)readU16(raw + 14);
+  calibration.p6 = (int16_t)readU16(raw + 16);
+  calibration.p7 = (int16_t)readU16(raw + 18);
+  calibration.p8 = (int16_t)readU16(raw + 20);
+  calibration.p9 = (int16_t)readU16(raw + 22);
+}
+
+uint8_t bmp280CtrlMeas(uint8_t tempOversampling, uint8_t pressOversampling) {
+  return (uint8_t)((tempOversampling << 5) | (pressOversampling << 2) | BMP280_MODE_FORCED);
+}
+
+bool bmp280CompensateAdc(const Bmp280Calibration& calibration, int32_t adcTemperature,
+                         int32_t adcPressure, float& temperature, float& pressurePa) {
+  if (adcTemperature == BMP280_ADC_SKIPPED || adcPressure == BMP280_ADC_SKIPPED) {
+    return false;
+  }
+
+  // Temperatura em centésimos de °C; t_fine segue para a pressão
+  int32_t var1 = ((((adcTemperature >> 3) - ((int32_t)calibration.t1 << 1))) *
+                  ((int32_t)calibration.t2)) >> 11;
+  int32_t delta = (adcTemperature >> 4) - ((int32_t)calibration.t1);
+  int32_t var2 = (((delta * delta) >> 12) * ((int32_t)calibration.t3)) >> 14;
+  int32_t tFine = var1 + var2;
+  int32_t centiCelsius = (tFine * 5 + 128) >> 8;
+
+  // Pressão em Pa no formato Q24.8
+  int64_t p1 = ((int64_t)tFine) - 128000;
+  int64_t p2 = p1 * p1 * (int64_t)calibration.p6;
+  p2 = p2 + ((p1 * (int64_t)calibration.p5) << 17);
+  p2 = p2 + (((int64_t)calibration.p4) << 35);
+  p1 = ((p1 * p1 * (int64_t)calibration.p3) >> 8) + ((p1 * (int64_t)calibration.p2) << 12);
+  p1 = (((((int64_t)1) << 47) + p1)) * ((int64_t)calibration.p1) >> 33;
+  if (p1 == 0) {
+    return false;  // Evita a divisão por zero
+  }
+  int64_t p = 1048576 - adcPressure;
+  p = (((p << 31) - p2) * 3125) / p1;
+  p1 = (((int64_t)calibration.p9) * (p >> 13) * (p >> 13)) >> 25;
+  p2 = (((int64_t)calibration.p8) * p) >> 19;
+  p = ((p + p1 + p2) >> 8) + (((int64_t)calibration.p7) << 4);
+
+  temperature = centiCelsius / 100.0f;
+  pressurePa = (uint32_t)p / 256.0f;
+  return true;
+}
+
+bool bmp280Compensate(const Bmp280Calibration& calibration, const uint8_t* data,
+                      float& temperature, float& pressurePa) {
+  int32_t adcPressure = ((int32_t)data[0] << 12) | ((int32_t)data[1] << 4) | (data[2] >> 4);
+  int32_t adcTemperature = ((int32_t)data[3] << 12) | ((int32_t)data[4] << 4) | (data[5] >> 4);
+  return bmp280CompensateAdc(calibration, adcTemperature, adcPressure, temperature, pressurePa);
+}
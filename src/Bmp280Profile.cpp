@@ -0,0 +1,25 @@
+#include "Bmp280Profile.h"
+
+static const Bmp280Profile profiles[BMP280_PROFILE_COUNT] = {
+  {"ultra low power", 1, 1},        // Pressão x1, temperatura x1: 6,4 ms
+  {"low power", 1, 2},              // x2, x1: 8,7 ms
+  {"standard resolution", 1, 3},    // x4, x1: 13,3 ms
+  {"high resolution", 1, 4},        // x8, x1: 22,5 ms
+  {"ultra high resolution", 2, 5}   // x16, x2: 43,2 ms
+};
+
+const Bmp280Profile& bmp280Profile(uint8_t index) {
+  return profiles[index < BMP280_PROFILE_COUNT ? index : BMP280_PROFILE_COUNT - 1];
+}
+
+// Cada amostra de oversampling leva 2,3 ms; a pressão tem mais 0,575 ms de preparo
+uint32_t bmp280ConversionUs(const Bmp280Profile& profile) {
+  uint32_t us = 1250;
+  if (profile.tempOversampling > 0) {
+    us += 2300u << (profile.tempOversampling - 1);
+  }
+  if (profile.pressOversampling > 0) {
+    us += (2300u << (profile.pressOversampling - 1)) + 575;
+  }
+  return us;
+}
@@ -1,4 +1,6 @@
 #include "ConfigManager.h"
+#include "Log.h"
+#include "Bmp280Profile.h"
 #include <FS.h>
 #include <SPIFFS.h>
 
@@ -27,25 +29,24 @@ ConfigManager::ConfigManager() {
 bool ConfigManager::begin() {
   // Inicializa sistema de arquivos
   if (!LittleFS.begin(true)) {
-    Serial.println("Falha ao montar sistema de arquivos SPIFFS");
-    Serial.println("Tentando formatar...");
+    LOG_W("Falha ao montar sistema de arquivos SPIFFS, tentando formatar...");
     
     if (!SPIFFS.format()) {
-      Serial.println("Formatação do SPIFFS falhou");
+      LOG_E("Formatação do SPIFFS falhou");
       return false;
     }
     
     if (!LittleFS.begin()) {
-      Serial.println("Falha ao montar SPIFFS mesmo após formatação");
+      LOG_E("Falha ao montar SPIFFS mesmo após formatação");
       return false;
     }
     
-    Serial.println("SPIFFS formatado com sucesso");
+    LOG_I("SPIFFS formatado com sucesso");
   }
   
   // Carrega configuração ou usa padrão
   if (!loadConfig()) {
-    Serial.println("Usando configuração padrão");
+    LOG_W("Usando configuração padrão");
     resetToDefaults();
     saveConfig();
   }
@@ -67,8 +68,7 @@ bool ConfigManager::loadConfig() {
   DeserializationError error = deserializeJson(doc, configJson);
   
   if (error) {
-    Serial.print("Falha ao deserializar JSON: ");
-    Serial.println(error.c_str());
+    LOG_E("Falha ao deserializar JSON: %s", error.c_str());
     return false;
   }
   
@@ -82,6 +82,16 @@ bool ConfigManager::loadConfig() {
   } else {
     _config.rainMmPerTip = DEFAULT_RAIN_MM_PER_TIP;
   }
+  _config.rainFlushTips = doc["flush_tips"] | DEFAULT_RAIN_FLUSH_TIPS;
+  _config.rainFlushMinutes = doc["flush_min"] | DEFAULT_RAIN_FLUSH_MINUTES;
+  _config.rainEventDryMinutes = doc["event_dry"] | DEFAULT_RAIN_EVENT_DRY_MINUTES;
+  _config.sleepMinMinutes = doc["sleep_min"] | DEFAULT_SLEEP_MIN_MINUTES;
+  _config.sleepMaxMinutes = doc["sleep_max"] | DEFAULT_SLEEP_MAX_MINUTES;
+  if (_config.sleepMinMinutes > _config.sleepMaxMinutes) {
+    LOG_W("Sleep mínimo (%u min) maior que o máximo (%u min) no arquivo, usando o mínimo",
+          _config.sleepMinMinutes, _config.sleepMaxMinutes);
+  }
+  _config.bmpProfile = doc["bmp_profile"] | DEFAULT_BMP280_PROFILE;
   
   // WiFi e nome do dispositivo
   strlcpy(_config.wifiSsid, doc["ssid"] | DEFAULT_WIFI_SSID, sizeof(_config.wifiSsid));
@@ -113,6 +123,12 @@ bool ConfigManager::saveConfig() {
   doc["sleep"] = _config.deepSleepTimeMinutes;
   doc["cpu"] = _config.cpuFreqMHz;
   doc["rain"] = _config.rainMmPerTip;
+  doc["flush_tips"] = _config.rainFlushTips;
+  doc["flush_min"] = _config.rainFlushMinutes;
+  doc["event_dry"] = _config.rainEventDryMinutes;
+  doc["sleep_min"] = _config.sleepMinMinutes;
+  doc["sleep_max"] = _config.sleepMaxMinutes;
+  doc["bmp_profile"] = _config.bmpProfile;
   doc["name"] = _config.deviceName;
   
   // WiFi
@@ -143,6 +159,12 @@ void ConfigManager::resetToDefaults() {
   _config.deepSleepTimeMinutes = DEFAULT_DEEP_SLEEP_TIME_MINUTES;
   _config.cpuFreqMHz = DEFAULT_CPU_FREQ_MHZ;
   _config.rainMmPerTip = DEFAULT_RAIN_MM_PER_TIP;
+  _config.rainFlushTips = DEFAULT_RAIN_FLUSH_TIPS;
+  _config.rainFlushMinutes = DEFAULT_RAIN_FLUSH_MINUTES;
+  _config.rainEventDryMinutes = DEFAULT_RAIN_EVENT_DRY_MINUTES;
+  _config.sleepMinMinutes = DEFAULT_SLEEP_MIN_MINUTES;
+  _config.sleepMaxMinutes = DEFAULT_SLEEP_MAX_MINUTES;
+  _config.bmpProfile = DEFAULT_BMP280_PROFILE;
   
   // WiFi e configurações básicas
   strlcpy(_config.wifiSsid, DEFAULT_WIFI_SSID, sizeof(_config.wifiSsid));
@@ -169,7 +191,7 @@ void ConfigManager::resetToDefaults() {
 void ConfigManager::startBLEServer() {
   if (_isBLEActive) return;
   
-  Serial.println("Iniciando servidor BLE...");
+  LOG_I("Iniciando servidor BLE...");
   
   // Inicializa BLE
   NimBLEDevice::init(_config.deviceName);
@@ -194,6 +216,15 @@ void ConfigManager::startBLEServer() {
   doc["sleep"] = _config.deepSleepTimeMinutes;
   doc["cpu"] = _config.cpuFreqMHz;
   doc["rain"] = _config.rainMmPerTip;
+  #ifndef USE_ULP_RAIN_COUNTER
+    // Só o caminho rápido (wake por basculada) usa os limites de envio da chuva
+    doc["flush_tips"] = _config.rainFlushTips;
+    doc["flush_min"] = _config.rainFlushMinutes;
+  #endif
+  doc["event_dry"] = _config.rainEventDryMinutes;
+  doc["sleep_min"] = _config.sleepMinMinutes;
+  doc["sleep_max"] = _config.sleepMaxMinutes;
+  doc["bmp_profile"] = _config.bmpProfile;
   doc["name"] = _config.deviceName;
   
   // WiFi
@@ -229,7 +260,7 @@ void ConfigManager::startBLEServer() {
   pAdvertising->setMaxPreferred(0x12);
   NimBLEDevice::startAdvertising();
   
-  Serial.println("BLE inicializado. Aguardando conexões...");
+  LOG_I("BLE inicializado. Aguardando conexões...");
   _isBLEActive = true;
 }
 
@@ -241,7 +272,7 @@ void ConfigManager::stopBLEServer() {
   NimBLEDevice::deinit(true);
   _isBLEActive = false;
   _bleConnected = false;
-  Serial.println("Servidor BLE parado");
+  LOG_I("Servidor BLE parado");
 }
 
 // Verifica se BLE está conectado
@@ -253,15 +284,13 @@ bool ConfigManager::isBLEConnected() {
 void ConfigManager::startConfigPortal() {
   if (_isPortalActive) return;
   
-  Serial.println("Iniciando portal de configuração...");
   
   // Inicializa AP
   WiFi.mode(WIFI_AP);
   String apName = String("ESP32-Weather-") + String((uint32_t)(ESP.getEfuseMac() & 0xFFFFFF), HEX);
   WiFi.softAP(apName.c_str(), CONFIG_AP_PASSWORD);
   
-  Serial.print("Portal iniciado em IP: ");
-  Serial.println(WiFi.softAPIP());
+  LOG_I("Portal iniciado em IP: %s", WiFi.softAPIP().toString().c_str());
   
   // Configura servidor web
   _webServer = new AsyncWebServer(80);
@@ -283,7 +312,7 @@ void ConfigManager::stopConfigPortal() {
   WiFi.softAPdisconnect(true);
   
   _isPortalActive = false;
-  Serial.println("Portal de configuração parado");
+  LOG_I("Portal de configuração parado");
 }
 
 // Verifica se portal está ativo
@@ -297,7 +326,7 @@ void ConfigManager::handlePortal() {
   
   // Verifica timeout
   if (millis() - _portalStartTime > CONFIG_PORTAL_TIMEOUT * 1000) {
-    Serial.println("Timeout do portal de configuração");
+    LOG_I("Timeout do portal de configuração");
     stopConfigPortal();
   }
 }
@@ -329,11 +358,11 @@ bool ConfigManager::checkConfigButtonPressed() {
 
 // Lê arquivo do sistema de arquivos
 String ConfigManager::readFile(const char* path) {
-  Serial.printf("Lendo arquivo: %s\n", path);
+  LOG_D("Lendo arquivo: %s", path);
   
   File file = LittleFS.open(path, "r");
   if (!file) {
-    Serial.println("Falha ao abrir arquivo para leitura");
+    LOG_W("Falha ao abrir arquivo para leitura: %s", path);
     return String();
   }
   
@@ -345,16 +374,16 @@ String ConfigManager::readFile(const char* path) {
 
 // Escreve arquivo no sistema de arquivos
 bool ConfigManager::writeFile(const char* path, const char* message) {
-  Serial.printf("Escrevendo em arquivo: %s\n", path);
+  LOG_D("Escrevendo em arquivo: %s", path);
   
   File file = LittleFS.open(path, "w");
   if (!file) {
-    Serial.println("Falha ao abrir arquivo para escrita");
+    LOG_E("Falha ao abrir arquivo para escrita: %s", path);
     return false;
   }
   
   if (!file.print(message)) {
-    Serial.println("Falha ao escrever");
+    LOG_E("Falha ao escrever: %s", path);
     file.close();
     return false;
   }
@@ -363,6 +392,34 @@ bool ConfigManager::writeFile(const char* path, const char* message) {
   return true;
 }
 
+// Lê um arquivo binário; falha se não existir ou tiver outro tamanho
+bool ConfigManager::readBlob(const char* path, void* data, size_t size) {
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    return false;
+  }
+  
+  bool ok = file.size() == size && file.read((uint8_t*)data, size) == size;
+  file.close();
+  return ok;
+}
+
+// Grava um arquivo binário, substituindo o anterior
+bool ConfigManager::writeBlob(const char* path, const void* data, size_t size) {
+  File file = LittleFS.open(path, "w");
+  if (!file) {
+    LOG_E("Falha ao abrir arquivo para escrita: %s", path);
+    return false;
+  }
+  
+  bool ok = file.write((const uint8_t*)data, size) == size;
+  file.close();
+  if (!ok) {
+    LOG_E("Falha ao escrever: %s", path);
+  }
+  return ok;
+}
+
 // Configura servidor web
 void ConfigManager::setupWebServer() {
   // Root - Página de configuração
@@ -375,6 +432,13 @@ void ConfigManager::setupWebServer() {
     handleConfigUpdate(request);
   });
   
+  // Conteúdo do buffer de log em memória RTC
+  _webServer->on("/log", HTTP_GET, [](AsyncWebServerRequest *request) {
+    AsyncResponseStream *response = request->beginResponseStream("text/plain; charset=utf-8");
+    logDump(*response);
+    request->send(response);
+  });
+  
   // Suporte a arquivos estáticos (CSS, JS)
   _webServer->serveStatic("/", LittleFS, "/");
   
@@ -407,7 +471,28 @@ String ConfigManager::generateConfigPage() {
   html += _config.cpuFreqMHz == 160 ? F("<option value='160' selected>160</option>") : F("<option value='160'>160</option>");
   html += F("</select><label>Rain (mm):</label><input type='number' name='rainMmPerTip' min='0.1' max='5' step='0.05' value='");
   html += String(_config.rainMmPerTip, 2);
-  html += F("'></div>");
+  #ifndef USE_ULP_RAIN_COUNTER
+    // Com o contador ULP as CPUs não acordam a cada basculada e estes limites não se aplicam
+    html += F("'><label>Envio após N basculadas:</label><input type='number' name='rainFlushTips' min='1' max='1000' value='");
+    html += _config.rainFlushTips;
+    html += F("'><label>Atraso máx. da chuva (min):</label><input type='number' name='rainFlushMinutes' min='1' max='360' value='");
+    html += _config.rainFlushMinutes;
+  #endif
+  html += F("'><label>Pausa que encerra um evento de chuva (min):</label><input type='number' name='rainEventDry' min='10' max='1440' value='");
+  html += _config.rainEventDryMinutes;
+  html += F("'><label>Sleep mín. adaptativo (min):</label><input type='number' name='sleepMin' min='1' max='360' value='");
+  html += _config.sleepMinMinutes;
+  html += F("'><label>Sleep máx. adaptativo (min):</label><input type='number' name='sleepMax' min='1' max='1440' value='");
+  html += _config.sleepMaxMinutes;
+  html += F("'><label>Oversampling do BMP280:</label><select name='bmpProfile'>");
+  for (uint8_t i = 0; i < BMP280_PROFILE_COUNT; i++) {
+    html += F("<option value='");
+    html += i;
+    html += i == _config.bmpProfile ? F("' selected>") : F("'>");
+    html += bmp280Profile(i).name;
+    html += F("</option>");
+  }
+  html += F("</select></div>");
   
   // WiFi
   html += F("<div class='s'><h3>Wi-Fi</h3><label>SSID:</label><input name='wifiSsid' value='");
@@ -485,6 +570,67 @@ void ConfigManager::handleConfigUpdate(AsyncWebServerRequest *request) {
     }
   }
   
+  if (request->hasParam("rainFlushTips", true)) {
+    int flushTips = request->getParam("rainFlushTips", true)->value().toInt();
+    if (flushTips >= 1 && flushTips <= 1000) {
+      _config.rainFlushTips = flushTips;
+      needsSave = true;
+    }
+  }
+  
+  if (request->hasParam("rainFlushMinutes", true)) {
+    int flushMinutes = request->getParam("rainFlushMinutes", true)->value().toInt();
+    if (flushMinutes >= 1 && flushMinutes <= 360) {
+      _config.rainFlushMinutes = flushMinutes;
+      needsSave = true;
+    }
+  }
+  
+  if (request->hasParam("rainEventDry", true)) {
+    int eventDryMinutes = request->getParam("rainEventDry", true)->value().toInt();
+    if (eventDryMinutes >= 10 && eventDryMinutes <= 1440) {
+      _config.rainEventDryMinutes = eventDryMinutes;
+      needsSave = true;
+    }
+  }
+  
+  // Os limites do agendador adaptativo são gravados juntos: um par com o mínimo acima do
+  // máximo é recusado em vez de ser corrigido em silêncio pelo agendador
+  uint16_t sleepMin = _config.sleepMinMinutes;
+  uint16_t sleepMax = _config.sleepMaxMinutes;
+  bool sleepLimitsChanged = false;
+  if (request->hasParam("sleepMin", true)) {
+    int value = request->getParam("sleepMin", true)->value().toInt();
+    if (value >= 1 && value <= 360) {
+      sleepMin = value;
+      sleepLimitsChanged = true;
+    }
+  }
+  
+  if (request->hasParam("sleepMax", true)) {
+    int value = request->getParam("sleepMax", true)->value().toInt();
+    if (value >= 1 && value <= 1440) {
+      sleepMax = value;
+      sleepLimitsChanged = true;
+    }
+  }
+  
+  if (sleepLimitsChanged && sleepMin > sleepMax) {
+    LOG_W("Sleep mínimo (%u min) maior que o máximo (%u min), limites mantidos", sleepMin, sleepMax);
+  } else if (sleepLimitsChanged) {
+    _config.sleepMinMinutes = sleepMin;
+    _config.sleepMaxMinutes = sleepMax;
+    needsSave = true;
+  }
+  
+  if (request->hasParam("bmpProfile", true)) {
+    int bmpProfile = request->getParam("bmpProfile", true)->value().toInt();
+    if (bmpProfile >= 0 && bmpProfile < BMP280_PROFILE_COUNT) {
+      _config.bmpProfile = bmpProfile;
+      needsSave = true;
+    }
+  }
+  
   if (request->hasParam("wifiSsid", true)) {
     String wifiSsid = request->getParam("wifiSsid", true)->value();
     if (wifiSsid.length() > 0 && wifiSsid.length() < sizeof(_config.wifiSsid)) {
@@ -590,7 +736,7 @@ void ConfigManager::handleConfigUpdate(AsyncWebServerRequest *request) {
   request->send(200, "text/html", html);
   
   // Agenda reinício do ESP32 para aplicar as novas configurações
-  Serial.println("Configurações atualizadas. Reiniciando em 5 segundos...");
+  LOG_I("Configurações atualizadas. Reiniciando...");
   delay(1000); // Dá tempo para enviar a resposta HTTP
   ESP.restart();
 }
@@ -598,12 +744,12 @@ void ConfigManager::handleConfigUpdate(AsyncWebServerRequest *request) {
 // Callbacks para servidor BLE
 void ConfigManager::ServerCallbacks::onConnect(NimBLEServer* pServer) {
   _configManager->_bleConnected = true;
-  Serial.println("Cliente BLE conectado");
+  LOG_I("Cliente BLE conectado");
 }
 
 void ConfigManager::ServerCallbacks::onDisconnect(NimBLEServer* pServer) {
   _configManager->_bleConnected = false;
-  Serial.println("Cliente BLE desconectado");
+  LOG_I("Cliente BLE desconectado");
   
   // Reinicia anúncio para nova conexão
   NimBLEDevice::startAdvertising();
@@ -614,16 +760,14 @@ void ConfigManager::CharacteristicCallbacks::onWrite(NimBLECharacteristic* pChar
   std::string value = pCharacteristic->getValue();
   
   if (value.length() > 0) {
-    Serial.println("Recebido via BLE:");
-    Serial.println(value.c_str());
+    LOG_D("Recebido via BLE: %s", value.c_str());
     
     // Analisa JSON recebido
     StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, value.c_str());
     
     if (error) {
-      Serial.print("Falha ao analisar JSON: ");
-      Serial.println(error.c_str());
+      LOG_E("Falha ao analisar JSON: %s", error.c_str());
       return;
     }
     
@@ -655,6 +799,67 @@ void ConfigManager::CharacteristicCallbacks::onWrite(NimBLECharacteristic* pChar
       }
     }
     
+    if (doc.containsKey("flush_tips")) {
+      uint16_t flushTips = doc["flush_tips"];
+      if (flushTips >= 1 && flushTips <= 1000) {
+        config->rainFlushTips = flushTips;
+        needsSave = true;
+      }
+    }
+    
+    if (doc.containsKey("flush_min")) {
+      uint16_t flushMinutes = doc["flush_min"];
+      if (flushMinutes >= 1 && flushMinutes <= 360) {
+        config->rainFlushMinutes = flushMinutes;
+        needsSave = true;
+      }
+    }
+    
+    if (doc.containsKey("event_dry")) {
+      uint16_t eventDryMinutes = doc["event_dry"];
+      if (eventDryMinutes >= 10 && eventDryMinutes <= 1440) {
+        config->rainEventDryMinutes = eventDryMinutes;
+        needsSave = true;
+      }
+    }
+    
+    // Limites do agendador adaptativo: gravados juntos, e recusados com o mínimo acima
+    // do máximo, como no portal
+    uint16_t sleepMin = config->sleepMinMinutes;
+    uint16_t sleepMax = config->sleepMaxMinutes;
+    bool sleepLimitsChanged = false;
+    if (doc.containsKey("sleep_min")) {
+      uint16_t value = doc["sleep_min"];
+      if (value >= 1 && value <= 360) {
+        sleepMin = value;
+        sleepLimitsChanged = true;
+      }
+    }
+    
+    if (doc.containsKey("sleep_max")) {
+      uint16_t value = doc["sleep_max"];
+      if (value >= 1 && value <= 1440) {
+        sleepMax = value;
+        sleepLimitsChanged = true;
+      }
+    }
+    
+    if (sleepLimitsChanged && sleepMin > sleepMax) {
+      LOG_W("Sleep mínimo (%u min) maior que o máximo (%u min), limites mantidos", sleepMin, sleepMax);
+    } else if (sleepLimitsChanged) {
+      config->sleepMinMinutes = sleepMin;
+      config->sleepMaxMinutes = sleepMax;
+      needsSave = true;
+    }
+    
+    if (doc.containsKey("bmp_profile")) {
+      uint8_t bmpProfile = doc["bmp_profile"];
+      if (bmpProfile < BMP280_PROFILE_COUNT) {
+        config->bmpProfile = bmpProfile;
+        needsSave = true;
+      }
+    }
+    
     if (doc.containsKey("ssid")) {
       const char* ssid = doc["ssid"];
       if (strlen(ssid) > 0 && strlen(ssid) < sizeof(config->wifiSsid)) {
@@ -715,7 +920,7 @@ void ConfigManager::CharacteristicCallbacks::onWrite(NimBLECharacteristic* pChar
       
       pCharacteristic->setValue(respJson.c_str());
       
-      Serial.println("Configuração atualizada via BLE");
+      LOG_I("Configuração atualizada via BLE");
     } else {
       // Envia resposta de erro
       StaticJsonDocument<128> respDoc;
@@ -731,7 +936,7 @@ void ConfigManager::CharacteristicCallbacks::onWrite(NimBLECharacteristic* pChar
 }
 
 void ConfigManager::CharacteristicCallbacks::onRead(NimBLECharacteristic* pCharacteristic) {
-  Serial.println("Leitura BLE solicitada");
+  LOG_D("Leitura BLE solicitada");
   
   WeatherStationConfig* config = _configManager->getConfig();
   
@@ -741,6 +946,15 @@ void ConfigManager::CharacteristicCallbacks::onRead(NimBLECharacteristic* pChara
   doc["sleep"] = config->deepSleepTimeMinutes;
   doc["cpu"] = config->cpuFreqMHz;
   doc["rain"] = config->rainMmPerTip;
+  #ifndef USE_ULP_RAIN_COUNTER
+    // Só o caminho rápido (wake por basculada) usa os limites de envio da chuva
+    doc["flush_tips"] = config->rainFlushTips;
+    doc["flush_min"] = config->rainFlushMinutes;
+  #endif
+  doc["event_dry"] = config->rainEventDryMinutes;
+  doc["sleep_min"] = config->sleepMinMinutes;
+  doc["sleep_max"] = config->sleepMaxMinutes;
+  doc["bmp_profile"] = config->bmpProfile;
   doc["name"] = config->deviceName;
   
   // WiFi
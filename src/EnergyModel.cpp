@@ -0,0 +1,58 @@
+#include "EnergyModel.h"
+
+#define ENERGY_ACCOUNT_MAGIC 0x454E5247UL
+#define US_PER_HOUR 3600000000.0
+// Peso de um novo ciclo na corrente média
+#define ENERGY_AVERAGE_ALPHA 0.1f
+
+float energyCycleMah(const EnergyModelConfig& config, const EnergySample& sample) {
+  double cpuMa = config.cpuBaseMa + config.cpuMaPerMHz * sample.cpuMHz;
+  double wifiMa = config.wifiRxMa * (1.0 - config.wifiTxDuty) + config.wifiTxMa * config.wifiTxDuty;
+
+  // mA * us
+  double charge = cpuMa * sample.activeUs +
+                  wifiMa * sample.wifiUs +
+                  (double)config.bleMa * sample.bleUs +
+                  (double)config.deepSleepMa * (double)sample.sleepUs;
+  return (float)(charge / US_PER_HOUR);
+}
+
+void energyAccountReset(EnergyAccount& account) {
+  account.magic = ENERGY_ACCOUNT_MAGIC;
+  account.cycles = 0;
+  account.consumedMah = 0.0;
+  account.lastCycleMah = 0.0f;
+  account.averageMa = 0.0f;
+}
+
+bool energyAccountValid(const EnergyAccount& account) {
+  return account.magic == ENERGY_ACCOUNT_MAGIC;
+}
+
+void energyAccountAdd(EnergyAccount& account, const EnergyModelConfig& config, const EnergySample& sample) {
+  float mah = energyCycleMah(config, sample);
+  account.consumedMah += mah;
+  account.lastCycleMah = mah;
+
+  uint64_t durationUs = (uint64_t)sample.activeUs + sample.sleepUs;
+  if (durationUs > 0) {
+    float cycleMa = (float)(mah * US_PER_HOUR / (double)durationUs);
+    if (account.cycles == 0) {
+      account.averageMa = cycleMa;
+    } else {
+      account.averageMa += ENERGY_AVERAGE_ALPHA * (cycleMa - account.averageMa);
+    }
+    account.cycles++;
+  }
+}
+
+float energyProjectedHours(const EnergyAccount& account, float capacityMah) {
+  if (account.cycles == 0 || account.averageMa <= 0.0f) {
+    return -1.0f;
+  }
+  double remaining = capacityMah - account.consumedMah;
+  if (remaining < 0.0) {
+    remaining = 0.0;
+  }
+  return (float)(remaining / account.averageMa);
+}
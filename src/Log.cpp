@@ -0,0 +1,122 @@
+#include "Log.h"
+
+#if LOG_LEVEL > LOG_LEVEL_NONE
+
+#include <stdarg.h>
+
+// Buffer circular de texto; as linhas terminam em '\n'
+struct LogRing {
+  uint16_t head;     // Próxima posição de escrita
+  uint16_t used;     // Bytes válidos no buffer
+  uint16_t unsent;   // Bytes mais recentes ainda não enviados à serial
+  char data[LOG_BUFFER_SIZE];
+};
+
+// Persiste durante o deep sleep
+RTC_DATA_ATTR LogRing logRing;
+
+// A tarefa de eventos do WiFi também registra mensagens
+static portMUX_TYPE logMux = portMUX_INITIALIZER_UNLOCKED;
+static bool serialAttached = false;
+
+static char levelChar(uint8_t level) {
+  switch (level) {
+    case LOG_LEVEL_ERROR: return 'E';
+    case LOG_LEVEL_WARN: return 'W';
+    case LOG_LEVEL_INFO: return 'I';
+    default: return 'D';
+  }
+}
+
+static void ringAppend(const char* text, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    logRing.data[logRing.head] = text[i];
+    logRing.head = (logRing.head + 1) % LOG_BUFFER_SIZE;
+  }
+  logRing.used = min((size_t)LOG_BUFFER_SIZE, logRing.used + length);
+  logRing.unsent = min((size_t)LOG_BUFFER_SIZE, logRing.unsent + length);
+}
+
+// Escreve os últimos count bytes do buffer. Com o buffer cheio, a linha mais antiga
+// pode ter sido sobrescrita pela metade e é descartada.
+static void ringWrite(Print& out, uint16_t count) {
+  uint16_t start = (logRing.head + LOG_BUFFER_SIZE - count) % LOG_BUFFER_SIZE;
+  bool skipping = count == LOG_BUFFER_SIZE;
+  for (uint16_t i = 0; i < count; i++) {
+    char c = logRing.data[(start + i) % LOG_BUFFER_SIZE];
+    if (skipping) {
+      skipping = c != '\n';
+      continue;
+    }
+    out.write(c);
+  }
+}
+
+// O conversor USB-serial só mantém o RX da UART0 em nível alto quando está alimentado
+// pela USB; sem host, o pull-down leva o pino a nível baixo
+static bool hostAttached() {
+  #if LOG_HOST_DETECT_PIN >= 0
+    pinMode(LOG_HOST_DETECT_PIN, INPUT_PULLDOWN);
+    delayMicroseconds(50);
+    return digitalRead(LOG_HOST_DETECT_PIN) == HIGH;
+  #else
+    return true;
+  #endif
+}
+
+void logBegin() {
+  if (hostAttached()) {
+    logAttachSerial();
+  }
+}
+
+void logAttachSerial() {
+  if (serialAttached) return;
+
+  Serial.begin(115200);
+  serialAttached = true;
+
+  // Mensagens registradas enquanto não havia host
+  portENTER_CRITICAL(&logMux);
+  uint16_t unsent = logRing.unsent;
+  logRing.unsent = 0;
+  portEXIT_CRITICAL(&logMux);
+  if (unsent > 0) {
+    Serial.println("--- log em memória RTC ---");
+    ringWrite(Serial, unsent);
+    Serial.println("--- fim do log em memória RTC ---");
+  }
+}
+
+void logWrite(uint8_t level, const char* format, ...) {
+  char line[LOG_LINE_MAX];
+  int prefix = snprintf(line, sizeof(line), "%6lu %c ", (unsigned long)millis(), levelChar(level));
+
+  // Reserva um byte para o '\n'
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line + prefix, sizeof(line) - prefix - 1, format, args);
+  va_end(args);
+  if (length < 0) {
+    length = 0;
+  }
+  size_t total = prefix + min((size_t)length, sizeof(line) - prefix - 2);
+  line[total++] = '\n';
+
+  portENTER_CRITICAL(&logMux);
+  ringAppend(line, total);
+  if (serialAttached) {
+    logRing.unsent = 0;
+  }
+  portEXIT_CRITICAL(&logMux);
+
+  if (serialAttached) {
+    Serial.write((const uint8_t*)line, total);
+  }
+}
+
+void logDump(Print& out) {
+  ringWrite(out, logRing.used);
+}
+
+#endif // LOG_LEVEL > LOG_LEVEL_NONE
@@ -0,0 +1,85 @@
+#include "RainEvent.h"
+#include <string.h>
+
+void rainEventReset(RainEventTable& table) {
+  memset(&table, 0, sizeof(table));
+}
+
+// Move o evento aberto para a fila de encerrados; com a fila cheia o mais antigo é descartado
+static void closeEvent(RainEventTable& table) {
+  if (table.completedCount == RAIN_EVENT_TABLE_SIZE) {
+    rainEventPop(table);
+    if (table.dropped < UINT16_MAX) {
+      table.dropped++;
+    }
+  }
+  table.completed[table.completedCount++] = table.current;
+  memset(&table.current, 0, sizeof(table.current));
+  table.currentBin = 0;
+  table.currentBinTips = 0;
+}
+
+void rainEventAddTips(RainEventTable& table, uint16_t tips, time_t timestamp, uint16_t dryMinutes) {
+  if (tips == 0) {
+    return;
+  }
+  uint32_t ts = (uint32_t)timestamp;
+  RainEvent& event = table.current;
+
+  if (event.tips > 0 && ts >= event.end && ts - event.end >= (uint32_t)dryMinutes * 60) {
+    closeEvent(table);
+  }
+
+  if (event.tips == 0) {
+    event.start = ts;
+    event.end = ts;
+  }
+  // Uma basculada fora de ordem (relógio ajustado) conta no evento sem mudar os limites
+  if (ts > event.end) {
+    event.end = ts;
+  }
+  event.tips += tips;
+
+  uint32_t bin = ts / RAIN_BIN_SECONDS;
+  if (bin != table.currentBin) {
+    table.currentBin = bin;
+    table.currentBinTips = 0;
+  }
+  table.currentBinTips = (uint16_t)(tips < UINT16_MAX - table.currentBinTips ? table.currentBinTips + tips : UINT16_MAX);
+  if (table.currentBinTips > event.peakBinTips) {
+    event.peakBinTips = table.currentBinTips;
+  }
+}
+
+bool rainEventAdvance(RainEventTable& table, time_t now, uint16_t dryMinutes) {
+  if (table.current.tips == 0 || (uint32_t)now < table.current.end ||
+      (uint32_t)now - table.current.end < (uint32_t)dryMinutes * 60) {
+    return false;
+  }
+  closeEvent(table);
+  return true;
+}
+
+const RainEvent* rainEventOldest(const RainEventTable& table) {
+  return table.completedCount > 0 ? &table.completed[0] : nullptr;
+}
+
+void rainEventPop(RainEventTable& table) {
+  if (table.completedCount == 0) {
+    return;
+  }
+  table.completedCount--;
+  memmove(table.completed, table.completed + 1, table.completedCount * sizeof(RainEvent));
+}
+
+uint32_t rainEventMinutes(const RainEvent& event) {
+  return (event.end - event.start) / 60;
+}
+
+float rainEventTotal(const RainEvent& event, float mmPerTip) {
+  return event.tips * mmPerTip;
+}
+
+float rainEventPeakRate(const RainEvent& event, float mmPerTip) {
+  return event.peakBinTips * mmPerTip * 60.0f / RAIN_BIN_MINUTES;
+}
@@ -0,0 +1,78 @@
+#include "RainHistory.h"
+#include <string.h>
+
+static uint16_t& binTips(RainHistory& history, uint32_t bin) {
+  return history.tips[bin % RAIN_HISTORY_BINS];
+}
+
+void rainHistoryReset(RainHistory& history) {
+  memset(history.tips, 0, sizeof(history.tips));
+  history.currentBin = 0;
+  history.hourTips = 0;
+  history.dayTips = 0;
+}
+
+uint16_t rainHistoryAdvance(RainHistory& history, time_t now) {
+  uint32_t bin = (uint32_t)now / RAIN_BIN_SECONDS;
+  if (bin <= history.currentBin) {
+    return 0;
+  }
+
+  // Depois de 24 h sem wakes completos nada do histórico continua na janela
+  if (bin - history.currentBin >= RAIN_HISTORY_BINS) {
+    uint16_t discarded = 0;
+    for (uint16_t i = 0; i < RAIN_HISTORY_BINS; i++) {
+      if (history.tips[i] > 0) discarded++;
+    }
+    rainHistoryReset(history);
+    history.currentBin = bin;
+    return discarded;
+  }
+
+  uint16_t discarded = 0;
+  while (history.currentBin < bin) {
+    history.currentBin++;
+    // O intervalo que sai da última hora continua nas 24 h
+    if (history.currentBin >= RAIN_HOUR_BINS) {
+      history.hourTips -= binTips(history, history.currentBin - RAIN_HOUR_BINS);
+    }
+    // O novo intervalo reaproveita a posição do que sai das 24 h
+    uint16_t& slot = binTips(history, history.currentBin);
+    if (slot > 0) {
+      history.dayTips -= slot;
+      slot = 0;
+      discarded++;
+    }
+  }
+  return discarded;
+}
+
+void rainHistoryAddTips(RainHistory& history, uint16_t tips, time_t timestamp) {
+  rainHistoryAdvance(history, timestamp);
+  uint16_t& slot = binTips(history, history.currentBin);
+  uint16_t added = (uint16_t)(tips < UINT16_MAX - slot ? tips : UINT16_MAX - slot);
+  slot += added;
+  history.hourTips += added;
+  history.dayTips += added;
+}
+
+uint32_t rainHistoryHourTips(RainHistory& history, time_t now) {
+  rainHistoryAdvance(history, now);
+  return history.hourTips;
+}
+
+uint32_t rainHistoryDayTips(RainHistory& history, time_t now) {
+  rainHistoryAdvance(history, now);
+  return history.dayTips;
+}
+
+uint32_t rainHistoryRecentTips(const RainHistory& history, uint16_t bins) {
+  if (bins == RAIN_HOUR_BINS) {
+    return history.hourTips;
+  }
+  uint32_t tips = 0;
+  for (uint16_t i = 0; i < bins && i <= history.currentBin && i < RAIN_HISTORY_BINS; i++) {
+    tips += history.tips[(history.currentBin - i) % RAIN_HISTORY_BINS];
+  }
+  return tips;
+}
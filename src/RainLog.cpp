@@ -0,0 +1,204 @@
+#include "RainLog.h"
+#include <string.h>
+
+#define RECORD_SIZE ((uint32_t)sizeof(RainLogRecord))
+
+// Último registro válido (maior sequência) encontrado na varredura
+struct RainLogHead {
+  bool found;
+  uint32_t offset;
+  RainLogRecord record;
+};
+
+static uint16_t crc16(const uint8_t* data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+static uint16_t recordCrc(const RainLogRecord& record) {
+  return crc16((const uint8_t*)&record, offsetof(RainLogRecord, crc));
+}
+
+static bool recordErased(const RainLogRecord& record) {
+  const uint8_t* bytes = (const uint8_t*)&record;
+  for (uint32_t i = 0; i < RECORD_SIZE; i++) {
+    if (bytes[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+static bool recordValid(const RainLogRecord& record) {
+  return !recordErased(record) && record.crc == recordCrc(record);
+}
+
+// Lê um setor página a página, chamando onRecord(offset, registro) para cada posição
+template <typename F>
+static bool scanSector(const RainLogFlash& flash, uint32_t sector, F onRecord) {
+  RainLogRecord page[RAIN_LOG_RECORDS_PER_PAGE];
+  for (uint32_t offset = sector; offset < sector + RAIN_LOG_SECTOR_SIZE; offset += sizeof(page)) {
+    if (!flash.read(offset, page, sizeof(page))) {
+      return false;
+    }
+    for (uint32_t i = 0; i < RAIN_LOG_RECORDS_PER_PAGE; i++) {
+      onRecord(offset + i * RECORD_SIZE, page[i]);
+    }
+  }
+  return true;
+}
+
+static bool findHead(const RainLogFlash& flash, RainLogHead& head) {
+  head.found = false;
+  for (uint32_t sector = 0; sector < flash.size; sector += RAIN_LOG_SECTOR_SIZE) {
+    bool ok = scanSector(flash, sector, [&](uint32_t offset, const RainLogRecord& record) {
+      if (recordValid(record) && (!head.found || record.sequence >= head.record.sequence)) {
+        head.found = true;
+        head.offset = offset;
+        head.record = record;
+      }
+    });
+    if (!ok) return false;
+  }
+  return true;
+}
+
+bool rainLogBegin(RainLog& log, const RainLogFlash& flash, uint32_t initialTips) {
+  log.ready = false;
+  log.pendingCount = 0;
+  if (flash.size < RAIN_LOG_SECTOR_SIZE || flash.size % RAIN_LOG_SECTOR_SIZE != 0) {
+    return false;
+  }
+
+  RainLogHead head;
+  if (!findHead(flash, head)) {
+    return false;
+  }
+
+  if (!head.found) {
+    log.nextSequence = 1;
+    log.writeOffset = 0;
+    log.committedTips = initialTips;
+  } else {
+    // Continua na primeira posição apagada depois do último registro; registros
+    // interrompidos no meio da escrita não podem ser regravados sem apagar o setor
+    uint32_t sector = head.offset - head.offset % RAIN_LOG_SECTOR_SIZE;
+    uint32_t next = sector + RAIN_LOG_SECTOR_SIZE;
+    bool ok = scanSector(flash, sector, [&](uint32_t offset, const RainLogRecord& record) {
+      if (offset > head.offset && next == sector + RAIN_LOG_SECTOR_SIZE && recordErased(record)) {
+        next = offset;
+      }
+    });
+    if (!ok) return false;
+    log.nextSequence = head.record.sequence + 1;
+    log.writeOffset = next % flash.size;
+    log.committedTips = head.record.totalTips;
+  }
+  log.totalTips = log.committedTips;
+  log.ready = true;
+  return true;
+}
+
+void rainLogAddTips(RainLog& log, uint16_t tips, time_t timestamp) {
+  uint32_t bin = (uint32_t)timestamp / RAIN_BIN_SECONDS;
+  RainLogPending* last = log.pendingCount > 0 ? &log.pending[log.pendingCount - 1] : nullptr;
+
+  if (last != nullptr && (bin <= last->bin || log.pendingCount == RAIN_LOG_PENDING_RECORDS)) {
+    uint16_t added = (uint16_t)(tips < UINT16_MAX - last->tips ? tips : UINT16_MAX - last->tips);
+    last->tips += added;
+    log.totalTips += added;
+    return;
+  }
+
+  log.pending[log.pendingCount].bin = bin;
+  log.pending[log.pendingCount].tips = tips;
+  log.pendingCount++;
+  log.totalTips += tips;
+}
+
+bool rainLogCommitDue(const RainLog& log, time_t now) {
+  if (log.pendingCount == 0) {
+    return false;
+  }
+  uint32_t age = (uint32_t)now / RAIN_BIN_SECONDS - log.pending[0].bin;
+  return log.pendingCount >= RAIN_LOG_RECORDS_PER_PAGE ||
+         age >= RAIN_LOG_MAX_DELAY_MINUTES / RAIN_BIN_MINUTES;
+}
+
+int rainLogCommit(RainLog& log, const RainLogFlash& flash) {
+  if (!log.ready) {
+    return -1;
+  }
+
+  RainLogRecord page[RAIN_LOG_RECORDS_PER_PAGE];
+  uint8_t written = 0;
+  bool ok = true;
+  while (written < log.pendingCount) {
+    // Entrar em um setor apaga o conteúdo mais antigo do log
+    if (log.writeOffset % RAIN_LOG_SECTOR_SIZE == 0 &&
+        !flash.erase(log.writeOffset, RAIN_LOG_SECTOR_SIZE)) {
+      ok = false;
+      break;
+    }
+
+    // Uma escrita por página, sem atravessar o limite da página
+    uint32_t room = (RAIN_LOG_PAGE_SIZE - log.writeOffset % RAIN_LOG_PAGE_SIZE) / RECORD_SIZE;
+    uint32_t left = (uint32_t)(log.pendingCount - written);
+    uint32_t count = left < room ? left : room;
+    uint32_t tips = log.committedTips;
+    for (uint32_t i = 0; i < count; i++) {
+      const RainLogPending& pending = log.pending[written + i];
+      tips += pending.tips;
+      page[i].sequence = log.nextSequence + i;
+      page[i].bin = pending.bin;
+      page[i].totalTips = tips;
+      page[i].tips = pending.tips;
+      page[i].crc = recordCrc(page[i]);
+    }
+    if (!flash.write(log.writeOffset, page, count * RECORD_SIZE)) {
+      // As posições podem ter sido gravadas em parte: a nova tentativa usa as seguintes,
+      // com as mesmas sequências (a leitura descarta a cópia repetida)
+      log.writeOffset = (log.writeOffset + count * RECORD_SIZE) % flash.size;
+      ok = false;
+      break;
+    }
+
+    written += count;
+    log.nextSequence += count;
+    log.committedTips = tips;
+    log.writeOffset = (log.writeOffset + count * RECORD_SIZE) % flash.size;
+  }
+
+  // Os registros já gravados saem da fila mesmo em erro
+  log.pendingCount -= written;
+  memmove(log.pending, log.pending + written, log.pendingCount * sizeof(RainLogPending));
+  return ok ? written : -1;
+}
+
+uint32_t rainLogReplay(const RainLogFlash& flash, RainLogRecordCallback onRecord) {
+  RainLogHead head;
+  if (flash.size < RAIN_LOG_SECTOR_SIZE || !findHead(flash, head) || !head.found) {
+    return 0;
+  }
+
+  // Do setor seguinte ao do último registro (o mais antigo) até ele
+  uint32_t count = 0;
+  uint32_t lastSequence = 0;
+  uint32_t headSector = head.offset - head.offset % RAIN_LOG_SECTOR_SIZE;
+  for (uint32_t i = 1; i <= flash.size / RAIN_LOG_SECTOR_SIZE; i++) {
+    uint32_t sector = (headSector + i * RAIN_LOG_SECTOR_SIZE) % flash.size;
+    scanSector(flash, sector, [&](uint32_t offset, const RainLogRecord& record) {
+      (void)offset;
+      if (recordValid(record) && (count == 0 || record.sequence > lastSequence)) {
+        onRecord(record);
+        lastSequence = record.sequence;
+        count++;
+      }
+    });
+  }
+  return count;
+}
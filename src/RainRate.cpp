@@ -0,0 +1,113 @@
+#include "RainRate.h"
+#include <string.h>
+
+#define TIMEOUT_SECONDS (RAIN_RATE_TIMEOUT_MINUTES * 60UL)
+
+// Intervalos de RainHistory em cada janela
+static const uint16_t windowBins[RAIN_RATE_WINDOWS] = {1, 15 / RAIN_BIN_MINUTES, RAIN_HOUR_BINS};
+
+static uint32_t hourOf(uint32_t bin) {
+  return bin / RAIN_HOUR_BINS;
+}
+
+// Avança o anel de picos até hour, zerando as horas que saíram das 24 h
+static void advancePeaks(RainRate& rate, uint32_t hour) {
+  if (hour <= rate.peakHour) {
+    return;
+  }
+
+  if (hour - rate.peakHour >= RAIN_RATE_PEAK_HOURS) {
+    memset(rate.hourPeaks, 0, sizeof(rate.hourPeaks));
+    memset(rate.dayPeaks, 0, sizeof(rate.dayPeaks));
+    rate.peakHour = hour;
+    return;
+  }
+
+  bool recompute = false;
+  while (rate.peakHour < hour) {
+    rate.peakHour++;
+    uint16_t* slot = rate.hourPeaks[rate.peakHour % RAIN_RATE_PEAK_HOURS];
+    for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+      recompute |= slot[w] > 0 && slot[w] == rate.dayPeaks[w];
+      slot[w] = 0;
+    }
+  }
+
+  // Saiu a hora com o pico de alguma janela
+  if (recompute) {
+    memset(rate.dayPeaks, 0, sizeof(rate.dayPeaks));
+    for (uint8_t h = 0; h < RAIN_RATE_PEAK_HOURS; h++) {
+      for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+        if (rate.hourPeaks[h][w] > rate.dayPeaks[w]) rate.dayPeaks[w] = rate.hourPeaks[h][w];
+      }
+    }
+  }
+}
+
+void rainRateReset(RainRate& rate) {
+  memset(&rate, 0, sizeof(rate));
+}
+
+void rainRateAddTips(RainRate& rate, const RainHistory& history, uint16_t tips, time_t timestamp) {
+  for (uint16_t i = 0; i < tips && i < RAIN_RATE_TIPS; i++) {
+    rate.tipTimes[rate.tipCount % RAIN_RATE_TIPS] = (uint32_t)timestamp;
+    rate.tipCount++;
+  }
+
+  // As janelas que terminam no intervalo corrente do histórico
+  advancePeaks(rate, hourOf(history.currentBin));
+  uint16_t* slot = rate.hourPeaks[rate.peakHour % RAIN_RATE_PEAK_HOURS];
+  for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+    uint32_t sum = rainHistoryRecentTips(history, windowBins[w]);
+    uint16_t value = (uint16_t)(sum < UINT16_MAX ? sum : UINT16_MAX);
+    if (value > slot[w]) slot[w] = value;
+    if (value > rate.dayPeaks[w]) rate.dayPeaks[w] = value;
+  }
+}
+
+float rainRateInstant(const RainRate& rate, time_t now, float mmPerTip) {
+  if (rate.tipCount == 0) {
+    return 0.0f;
+  }
+  uint32_t last = rate.tipTimes[(rate.tipCount - 1) % RAIN_RATE_TIPS];
+  uint32_t elapsed = (uint32_t)now > last ? (uint32_t)now - last : 0;
+  if (elapsed >= TIMEOUT_SECONDS) {
+    return 0.0f;
+  }
+
+  // Basculadas anteriores do mesmo episódio (uma pausa de RAIN_RATE_TIMEOUT_MINUTES
+  // separa episódios de chuva)
+  uint32_t available = rate.tipCount < RAIN_RATE_TIPS ? rate.tipCount : RAIN_RATE_TIPS;
+  uint32_t span = 0;
+  uint32_t intervals = 0;
+  for (uint32_t k = 1; k < available; k++) {
+    uint32_t earlier = rate.tipTimes[(rate.tipCount - 1 - k) % RAIN_RATE_TIPS];
+    if (earlier > last || last - earlier >= TIMEOUT_SECONDS) {
+      break;
+    }
+    span = last - earlier;
+    intervals = k;
+  }
+
+  // Uma basculada isolada: no máximo uma por RAIN_RATE_TIMEOUT_MINUTES
+  float interval = TIMEOUT_SECONDS;
+  if (intervals > 0) {
+    interval = (float)(span > RAIN_RATE_MIN_SPAN_SECONDS ? span : RAIN_RATE_MIN_SPAN_SECONDS) / intervals;
+  }
+  // A próxima basculada está atrasada: a chuva diminuiu pelo menos para esse intervalo
+  if (elapsed > interval) {
+    interval = elapsed;
+  }
+  return mmPerTip * 3600.0f / interval;
+}
+
+void rainRatePeaks(RainRate& rate, time_t now, float mmPerTip, float peaks[RAIN_RATE_WINDOWS]) {
+  advancePeaks(rate, hourOf((uint32_t)now / RAIN_BIN_SECONDS));
+  for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+    peaks[w] = rate.dayPeaks[w] * mmPerTip * 60.0f / rainRateWindowMinutes(w);
+  }
+}
+
+uint16_t rainRateWindowMinutes(uint8_t window) {
+  return windowBins[window] * RAIN_BIN_MINUTES;
+}
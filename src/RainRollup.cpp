@@ -0,0 +1,191 @@
+#include "RainRollup.h"
+#include <stddef.h>
+#include <string.h>
+
+#define RAIN_ROLLUP_MAGIC 0x524F4C32UL
+#define RAIN_ROLLUP_MAGIC_V1 0x524F4C4CUL
+#define RAIN_ROLLUP_LAYOUT (((uint32_t)RAIN_ROLLUP_HOURS << 16) | (RAIN_ROLLUP_DAYS << 8) | RAIN_ROLLUP_MONTHS)
+
+// Intervalos de uma camada no horário local
+struct RainRollupBins {
+  uint32_t hour;
+  uint32_t day;
+  uint32_t month;
+};
+
+// Dias desde 1970-01-01 até o primeiro dia de year/month (calendário gregoriano)
+static int32_t daysFromCivil(int32_t year, uint32_t month) {
+  year -= month <= 2;
+  int32_t era = (year >= 0 ? year : year - 399) / 400;
+  uint32_t yoe = (uint32_t)(year - era * 400);
+  uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5;
+  uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+// Ano * 12 + mês - 1 do dia days (desde 1970-01-01)
+static uint32_t monthFromDays(int32_t days) {
+  days += 719468;
+  int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+  uint32_t doe = (uint32_t)(days - era * 146097);
+  uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  uint32_t mp = (5 * doy + 2) / 153;
+  uint32_t month = mp < 10 ? mp + 3 : mp - 9;
+  int32_t year = (int32_t)yoe + era * 400 + (month <= 2);
+  return (uint32_t)year * 12 + month - 1;
+}
+
+static RainRollupBins localBins(time_t timestamp) {
+  int64_t local = (int64_t)timestamp + RAIN_ROLLUP_UTC_OFFSET;
+  RainRollupBins bins;
+  bins.hour = (uint32_t)(local / 3600);
+  bins.day = (uint32_t)(local / 86400);
+  bins.month = monthFromDays((int32_t)bins.day);
+  return bins;
+}
+
+// Entra nos intervalos até bin; os que passaram sem wake começam com o total atual
+// (truncado à largura T da camada)
+template <typename T>
+static void advanceTier(T* starts, uint32_t size, uint32_t& current, uint32_t bin, uint32_t total) {
+  if (bin <= current) {
+    return;
+  }
+  uint32_t steps = bin - current < size ? bin - current : size;
+  for (uint32_t i = steps; i > 0; i--) {
+    starts[(bin - i + 1) % size] = (T)total;
+  }
+  current = bin;
+}
+
+// Basculadas desde o início do intervalo bin, se a camada ainda o alcança. A diferença
+// é calculada na largura T da camada (módulo 2^16 nas camadas de 16 bits).
+template <typename T>
+static bool tierTips(const T* starts, uint32_t size, uint32_t current, uint32_t bin,
+                     uint32_t total, uint32_t& tips) {
+  if (bin > current) {
+    tips = 0;
+    return true;
+  }
+  if (current - bin >= size) {
+    return false;
+  }
+  tips = (T)((T)total - starts[bin % size]);
+  return true;
+}
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void rainRollupReset(RainRollup& rollup) {
+  memset(&rollup, 0, sizeof(rollup));
+}
+
+void rainRollupStart(RainRollup& rollup, time_t now, uint32_t tips) {
+  rainRollupReset(rollup);
+  rollup.totalTips = tips;
+  if (!rainRollupAdvance(rollup, now)) {
+    return;
+  }
+  for (uint32_t i = 0; i < RAIN_ROLLUP_HOURS; i++) rollup.hourStart[i] = (uint16_t)tips;
+  for (uint32_t i = 0; i < RAIN_ROLLUP_DAYS; i++) rollup.dayStart[i] = (uint16_t)tips;
+  for (uint32_t i = 0; i < RAIN_ROLLUP_MONTHS; i++) rollup.monthStart[i] = tips;
+}
+
+bool rainRollupEmpty(const RainRollup& rollup) {
+  return rollup.totalTips == 0 && rollup.hourBin == 0;
+}
+
+bool rainRollupAdvance(RainRollup& rollup, time_t now) {
+  if (now < RAIN_ROLLUP_MIN_EPOCH) {
+    return false;
+  }
+
+  RainRollupBins bins = localBins(now);
+  if (rollup.hourBin == 0) {
+    // Primeiro relógio de parede: as camadas começam agora, vazias
+    rollup.hourBin = bins.hour;
+    rollup.dayBin = bins.day;
+    rollup.monthBin = bins.month;
+    return true;
+  }
+
+  // Relógio que volta (correção do NTP) mantém os intervalos correntes
+  advanceTier(rollup.hourStart, RAIN_ROLLUP_HOURS, rollup.hourBin, bins.hour, rollup.totalTips);
+  advanceTier(rollup.dayStart, RAIN_ROLLUP_DAYS, rollup.dayBin, bins.day, rollup.totalTips);
+  advanceTier(rollup.monthStart, RAIN_ROLLUP_MONTHS, rollup.monthBin, bins.month, rollup.totalTips);
+  return true;
+}
+
+void rainRollupAddTips(RainRollup& rollup, uint16_t tips, time_t timestamp) {
+  rainRollupAdvance(rollup, timestamp);
+  rollup.totalTips += tips;
+}
+
+uint32_t rainRollupTipsSince(RainRollup& rollup, time_t now, time_t since) {
+  if (!rainRollupAdvance(rollup, now) || since < RAIN_ROLLUP_MIN_EPOCH) {
+    return rollup.totalTips;
+  }
+
+  RainRollupBins bins = localBins(since);
+  uint32_t tips;
+  if (tierTips(rollup.hourStart, RAIN_ROLLUP_HOURS, rollup.hourBin, bins.hour, rollup.totalTips, tips) ||
+      tierTips(rollup.dayStart, RAIN_ROLLUP_DAYS, rollup.dayBin, bins.day, rollup.totalTips, tips) ||
+      tierTips(rollup.monthStart, RAIN_ROLLUP_MONTHS, rollup.monthBin, bins.month, rollup.totalTips, tips)) {
+    return tips;
+  }
+  // Além da camada de meses: tudo o que ela ainda guarda
+  return rollup.totalTips - rollup.monthStart[(rollup.monthBin + 1) % RAIN_ROLLUP_MONTHS];
+}
+
+time_t rainRollupMonthStart(time_t now) {
+  uint32_t month = localBins(now).month;
+  int32_t days = daysFromCivil((int32_t)(month / 12), month % 12 + 1);
+  return (time_t)days * 86400 - RAIN_ROLLUP_UTC_OFFSET;
+}
+
+void rainRollupCheckpoint(const RainRollup& rollup, RainRollupCheckpoint& checkpoint) {
+  checkpoint.magic = RAIN_ROLLUP_MAGIC;
+  checkpoint.layout = RAIN_ROLLUP_LAYOUT;
+  checkpoint.rollup = rollup;
+  checkpoint.crc = crc32((const uint8_t*)&checkpoint, offsetof(RainRollupCheckpoint, crc));
+}
+
+bool rainRollupRestore(RainRollup& rollup, const RainRollupCheckpoint& checkpoint) {
+  if (checkpoint.magic != RAIN_ROLLUP_MAGIC || checkpoint.layout != RAIN_ROLLUP_LAYOUT ||
+      checkpoint.crc != crc32((const uint8_t*)&checkpoint, offsetof(RainRollupCheckpoint, crc))) {
+    return false;
+  }
+  rollup = checkpoint.rollup;
+  return true;
+}
+
+bool rainRollupRestoreV1(RainRollup& rollup, const RainRollupCheckpointV1& checkpoint) {
+  if (checkpoint.magic != RAIN_ROLLUP_MAGIC_V1 || checkpoint.layout != RAIN_ROLLUP_LAYOUT ||
+      checkpoint.crc != crc32((const uint8_t*)&checkpoint, offsetof(RainRollupCheckpointV1, crc))) {
+    return false;
+  }
+
+  // Os 16 bits menos significativos preservam todas as diferenças dentro das janelas
+  rollup.totalTips = checkpoint.totalTips;
+  rollup.hourBin = checkpoint.hourBin;
+  rollup.dayBin = checkpoint.dayBin;
+  rollup.monthBin = checkpoint.monthBin;
+  for (uint32_t i = 0; i < RAIN_ROLLUP_HOURS; i++) {
+    rollup.hourStart[i] = (uint16_t)checkpoint.hourStart[i];
+  }
+  for (uint32_t i = 0; i < RAIN_ROLLUP_DAYS; i++) {
+    rollup.dayStart[i] = (uint16_t)checkpoint.dayStart[i];
+  }
+  memcpy(rollup.monthStart, checkpoint.monthStart, sizeof(rollup.monthStart));
+  return true;
+}
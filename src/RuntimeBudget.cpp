@@ -0,0 +1,99 @@
+#include "RuntimeBudget.h"
+#include "Log.h"
+
+// Contadores de estouro - persistem durante o deep sleep
+RTC_DATA_ATTR RuntimeBudgetStats runtimeBudgetStats;
+
+// Instância global
+RuntimeBudget runtimeBudget;
+
+// Fim utilizável do orçamento, relativo ao início do ciclo
+static const uint32_t BUDGET_TOTAL_MS = MAX_RUNTIME_MS - BUDGET_SLEEP_RESERVE_MS;
+
+static uint32_t defaultPhaseMs(BudgetPhase phase) {
+  switch (phase) {
+    case BUDGET_SENSORS: return BUDGET_SENSORS_MS;
+    case BUDGET_WIFI: return BUDGET_WIFI_MS;
+    case BUDGET_NTP: return BUDGET_NTP_MS;
+    case BUDGET_SEND: return BUDGET_SEND_MS;
+    default: return 0;
+  }
+}
+
+RuntimeBudget::RuntimeBudget() {
+  _startMs = 0;
+  _deadlineMs = 0;
+  _phase = BUDGET_SENSORS;
+  _inPhase = false;
+}
+
+void RuntimeBudget::begin(unsigned long startMs) {
+  _startMs = startMs;
+  _deadlineMs = BUDGET_TOTAL_MS;
+  _inPhase = false;
+}
+
+void RuntimeBudget::enter(BudgetPhase phase) {
+  enter(phase, defaultPhaseMs(phase));
+}
+
+void RuntimeBudget::enter(BudgetPhase phase, uint32_t phaseMs) {
+  leave();
+
+  uint32_t now = elapsed();
+  uint32_t deadline = now + phaseMs;
+  _deadlineMs = deadline < BUDGET_TOTAL_MS ? deadline : BUDGET_TOTAL_MS;
+  _phase = phase;
+  _inPhase = true;
+}
+
+void RuntimeBudget::leave() {
+  if (!_inPhase) return;
+  _inPhase = false;
+
+  uint32_t now = elapsed();
+  if (now > _deadlineMs + BUDGET_OVERRUN_TOLERANCE_MS) {
+    runtimeBudgetStats.overruns[_phase]++;
+    LOG_W("Fase %s estourou o prazo em %lu ms", phaseName(_phase),
+          (unsigned long)(now - _deadlineMs));
+  }
+}
+
+uint32_t RuntimeBudget::remaining() const {
+  uint32_t now = elapsed();
+  return now < _deadlineMs ? _deadlineMs - now : 0;
+}
+
+bool RuntimeBudget::expired() const {
+  return elapsed() >= _deadlineMs;
+}
+
+bool RuntimeBudget::exhausted() const {
+  return elapsed() >= BUDGET_TOTAL_MS;
+}
+
+bool RuntimeBudget::allowOptional(uint32_t costMs) {
+  if (remaining() > costMs) {
+    return true;
+  }
+  runtimeBudgetStats.skipped++;
+  return false;
+}
+
+const RuntimeBudgetStats& RuntimeBudget::stats() const {
+  return runtimeBudgetStats;
+}
+
+uint32_t RuntimeBudget::elapsed() const {
+  return (uint32_t)(millis() - _startMs);
+}
+
+const char* RuntimeBudget::phaseName(BudgetPhase phase) {
+  switch (phase) {
+    case BUDGET_SENSORS: return "sensors";
+    case BUDGET_WIFI: return "wifi";
+    case BUDGET_NTP: return "ntp";
+    case BUDGET_SEND: return "send";
+    default: return "?";
+  }
+}
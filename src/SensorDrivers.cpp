@@ -0,0 +1,166 @@
+#include "SensorDrivers.h"
+#include "Log.h"
+
+#if defined(USE_AHT20) || defined(USE_BMP280)
+#include <Wire.h>
+
+// Barramento I2C iniciado uma vez, pelo primeiro sensor I2C
+static void beginI2C() {
+  static bool started = false;
+  if (!started) {
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+    started = true;
+  }
+}
+#endif
+
+#ifdef USE_DHT22
+#include <DHT.h>
+
+static DHT dht(DHT_PIN, DHT22);
+
+void Dht22Driver::begin(const WeatherStationConfig& config) {
+  LOG_D("Initializing DHT22 sensor...");
+  dht.begin();
+}
+
+// One temperature and humidity reading from the DHT22 sensor (retries in pollSensorRead)
+bool Dht22Driver::read(SensorReadings& readings, uint8_t quantities) {
+  LOG_D("Reading DHT22 sensor...");
+
+  float humidity = dht.readHumidity();
+  float temperature = dht.readTemperature();
+  if (isnan(humidity) || isnan(temperature)) {
+    return false;
+  }
+
+  readings.temperature = temperature;
+  readings.humidity = humidity;
+  LOG_I("Temperature: %.2f °C, humidity: %.2f %%", temperature, humidity);
+  return true;
+}
+#endif
+
+#ifdef USE_AHT20
+#include <Adafruit_AHTX0.h>
+
+static Adafruit_AHTX0 aht;
+
+void Aht20Driver::begin(const WeatherStationConfig& config) {
+  beginI2C();
+  LOG_D("Initializing AHT20 sensor...");
+  if (!aht.begin()) {
+    LOG_E("Could not find AHT20 sensor! Check wiring");
+  } else {
+    LOG_D("AHT20 sensor found");
+  }
+}
+
+// One temperature and humidity reading from the AHT20 sensor (retries in pollSensorRead)
+bool Aht20Driver::read(SensorReadings& readings, uint8_t quantities) {
+  LOG_D("Reading AHT20 sensor...");
+
+  sensors_event_t humidityEvent, temperatureEvent;
+  if (!aht.getEvent(&humidityEvent, &temperatureEvent)) {
+    return false;
+  }
+
+  readings.temperature = temperatureEvent.temperature;
+  readings.humidity = humidityEvent.relative_humidity;
+  LOG_I("Temperature: %.2f °C, humidity: %.2f %%", readings.temperature, readings.humidity);
+  return true;
+}
+#endif
+
+#ifdef USE_BMP280
+#include "Bmp280Profile.h"
+#include "Bmp280Compensation.h"
+
+static Bmp280Calibration bmpCalibration;
+static uint8_t bmpCtrlMeas = 0;          // 0: sensor não encontrado em begin()
+static uint32_t bmpConversionUs = 0;     // Tempo máximo de conversão do perfil configurado
+
+// Lê length registradores seguidos a partir de reg em uma única transação I2C
+static bool bmp280ReadRegisters(uint8_t reg, uint8_t* data, uint8_t length) {
+  Wire.beginTransmission(BMP280_ADDRESS);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0 ||
+      Wire.requestFrom((uint8_t)BMP280_ADDRESS, length) != length) {
+    return false;
+  }
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = Wire.read();
+  }
+  return true;
+}
+
+static bool bmp280WriteRegister(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(BMP280_ADDRESS);
+  Wire.write(reg);
+  Wire.write(value);
+  return Wire.endTransmission() == 0;
+}
+
+void Bmp280Driver::begin(const WeatherStationConfig& config) {
+  beginI2C();
+  LOG_D("Initializing BMP280 sensor...");
+  bmpCtrlMeas = 0;
+  
+  uint8_t chipId = 0;
+  uint8_t calibration[BMP280_CALIB_BYTES];
+  if (!bmp280ReadRegisters(BMP280_REG_CHIP_ID, &chipId, 1) || chipId != BMP280_CHIP_ID ||
+      !bmp280ReadRegisters(BMP280_REG_CALIB, calibration, sizeof(calibration))) {
+    LOG_E("Could not find BMP280 sensor! Check wiring or try a different address");
+    return;
+  }
+  bmp280ParseCalibration(calibration, bmpCalibration);
+  
+  // Modo forçado: uma conversão por leitura e o sensor dorme no resto do tempo,
+  // inclusive durante o deep sleep; sem filtro IIR, que não se acomoda entre wakes
+  const Bmp280Profile &profile = bmp280Profile(config.bmpProfile);
+  if (!bmp280WriteRegister(BMP280_REG_CONFIG, 0)) {
+    LOG_E("Could not configure BMP280 sensor");
+    return;
+  }
+  bmpCtrlMeas = bmp280CtrlMeas(profile.tempOversampling, profile.pressOversampling);
+  bmpConversionUs = bmp280ConversionUs(profile);
+  LOG_D("BMP280 sensor found, %s profile (%lu us per conversion)",
+        profile.name, (unsigned long)bmpConversionUs);
+}
+
+// One pressure reading from the BMP280 sensor (retries in pollSensorRead); the temperature
+// goes into the readings only when it was requested, and it has no humidity sensor.
+// Dispara uma única conversão, espera o tempo máximo de conversão do perfil
+// (bmp280ConversionUs) e lê pressão e temperatura em uma rajada de 6 bytes; se o status
+// ainda indicar conversão em andamento, a leitura falha e é refeita na próxima tentativa
+bool Bmp280Driver::read(SensorReadings& readings, uint8_t quantities) {
+  LOG_D("Reading BMP280 sensor...");
+
+  if (bmpCtrlMeas == 0 || !bmp280WriteRegister(BMP280_REG_CTRL_MEAS, bmpCtrlMeas)) {
+    return false;
+  }
+  delayMicroseconds(bmpConversionUs);
+  
+  uint8_t status;
+  uint8_t data[BMP280_DATA_BYTES];
+  if (!bmp280ReadRegisters(BMP280_REG_STATUS, &status, 1) || (status & BMP280_STATUS_MEASURING) ||
+      !bmp280ReadRegisters(BMP280_REG_DATA, data, sizeof(data))) {
+    return false;
+  }
+  
+  float temperature, pressurePa;
+  if (!bmp280Compensate(bmpCalibration, data, temperature, pressurePa)) {
+    return false;
+  }
+  float pressure = pressurePa / 100.0F; // Convert Pa to hPa
+
+  readings.pressureHpa = pressure;
+  if (quantities & SENSOR_TEMPERATURE) {
+    readings.temperature = temperature;
+    LOG_I("Temperature: %.2f °C, pressure: %.2f hPa", temperature, pressure);
+  } else {
+    LOG_I("Pressure: %.2f hPa", pressure);
+  }
+  return true;
+}
+#endif
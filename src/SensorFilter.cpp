@@ -0,0 +1,102 @@
+#include "SensorFilter.h"
+#include <math.h>
+#include <string.h>
+
+#define GAIN_ONE 65536                  // 1,0 em Q16
+#define MAX_VARIANCE (1UL << 30)        // Limite da incerteza depois de longos períodos sem leitura
+
+#if SENSOR_FILTER_WINDOW < 1 || SENSOR_FILTER_WINDOW > SENSOR_FILTER_WINDOW_MAX || SENSOR_FILTER_WINDOW % 2 == 0
+#error "SENSOR_FILTER_WINDOW deve ser ímpar e até SENSOR_FILTER_WINDOW_MAX"
+#endif
+
+// Mediana da janela (ordenação por inserção de até SENSOR_FILTER_WINDOW_MAX valores)
+static int32_t windowMedian(const SensorFilterChannel& channel) {
+  int32_t sorted[SENSOR_FILTER_WINDOW_MAX];
+  for (uint8_t i = 0; i < channel.samples; i++) {
+    int32_t value = channel.window[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return sorted[channel.samples / 2];
+}
+
+// Recomeça a estimativa em value, com a incerteza de uma leitura
+static void seed(SensorFilterChannel& channel, const SensorFilterParams& params, int32_t value) {
+  channel.valid = true;
+  channel.estimate = value;
+  channel.variance = params.noise * params.noise;
+  channel.rejects = 0;
+}
+
+void sensorFilterReset(SensorFilterChannel& channel) {
+  memset(&channel, 0, sizeof(channel));
+}
+
+float sensorFilterUpdate(SensorFilterChannel& channel, const SensorFilterParams& params,
+                         float raw, time_t now) {
+  // Leituras antigas demais não descrevem mais o mesmo valor: a janela recomeça e o
+  // descarte fica só com o gate
+  if (now < channel.updated || now - channel.updated > SENSOR_FILTER_WINDOW_GAP_SECONDS) {
+    channel.samples = 0;
+    channel.next = 0;
+  }
+  channel.window[channel.next] = (int32_t)lroundf(raw * params.scale);
+  channel.next = (channel.next + 1) % SENSOR_FILTER_WINDOW;
+  if (channel.samples < SENSOR_FILTER_WINDOW) {
+    channel.samples++;
+  }
+  int32_t median = windowMedian(channel);
+
+  // Incerteza cresce com o tempo desde a última leitura; um relógio que voltou (acerto
+  // pelo NTP) conta como nenhum tempo
+  uint64_t variance = channel.variance;
+  if (channel.valid && now > channel.updated) {
+    uint64_t seconds = (uint64_t)(now - channel.updated);
+    variance += (uint64_t)params.drift * params.drift * seconds / 60;
+  }
+  channel.variance = variance < MAX_VARIANCE ? (uint32_t)variance : MAX_VARIANCE;
+  channel.updated = now;
+
+  if (!channel.valid) {
+    seed(channel, params, median);
+    return (float)channel.estimate / params.scale;
+  }
+
+  // Descarte: inovação² > gate² · (variância da estimativa + da leitura)
+  int64_t innovation = (int64_t)median - channel.estimate;
+  uint64_t total = (uint64_t)channel.variance + (uint64_t)params.noise * params.noise;
+  uint64_t magnitude = (uint64_t)(innovation < 0 ? -innovation : innovation);
+  // Só descartes seguidos do mesmo lado da estimativa contam como mudança real
+  if (magnitude * magnitude > (uint64_t)SENSOR_FILTER_GATE_SIGMA * SENSOR_FILTER_GATE_SIGMA * total) {
+    bool above = innovation > 0;
+    if (channel.rejects > 0 && above != channel.rejectedAbove) {
+      channel.rejects = 0;
+    }
+    channel.rejectedAbove = above;
+    if (++channel.rejects >= SENSOR_FILTER_MAX_REJECTS) {
+      seed(channel, params, median);
+    }
+    return (float)channel.estimate / params.scale;
+  }
+
+  // Ganho de Kalman em Q16
+  uint32_t gain = (uint32_t)(((uint64_t)channel.variance << 16) / total);
+  int64_t correction = innovation * (int64_t)gain;
+  channel.estimate += (int32_t)((correction + (correction < 0 ? -GAIN_ONE / 2 : GAIN_ONE / 2)) / GAIN_ONE);
+  channel.variance = (uint32_t)(((uint64_t)channel.variance * (GAIN_ONE - gain)) >> 16);
+  channel.rejects = 0;
+  return (float)channel.estimate / params.scale;
+}
+
+float sensorFilterHeld(const SensorFilterChannel& channel, const SensorFilterParams& params,
+                       time_t now) {
+  // Relógio que voltou conta como nenhum tempo, como em sensorFilterUpdate()
+  if (!channel.valid || (now > channel.updated && now - channel.updated > SENSOR_FILTER_HOLD_SECONDS)) {
+    return NAN;
+  }
+  return (float)channel.estimate / params.scale;
+}
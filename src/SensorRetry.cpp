@@ -0,0 +1,68 @@
+#include "SensorRetry.h"
+
+// Wakes recentes sem leitura no histórico
+static uint8_t recentFailures(const SensorHealth& health) {
+  uint8_t failures = 0;
+  for (uint8_t i = 0; i < health.samples; i++) {
+    if ((health.history & (1 << i)) == 0) {
+      failures++;
+    }
+  }
+  return failures;
+}
+
+static void finish(SensorRetry& retry, SensorHealth& health, bool ok) {
+  retry.state = ok ? SENSOR_RETRY_OK : SENSOR_RETRY_FAILED;
+  health.history = (uint8_t)((health.history << 1) | (ok ? 1 : 0));
+  if (health.samples < 8) {
+    health.samples++;
+  }
+  if (ok) {
+    health.failStreak = 0;
+  } else if (health.failStreak < UINT8_MAX) {
+    health.failStreak++;
+  }
+}
+
+void sensorRetryBegin(SensorRetry& retry, const SensorHealth& health, uint32_t minRetryMs,
+                      uint32_t nowMs, uint32_t deadlineMs) {
+  retry.state = SENSOR_RETRY_IDLE;
+  retry.attempts = 0;
+  retry.maxAttempts = health.failStreak >= SENSOR_DEAD_WAKES ? 1 : SENSOR_MAX_ATTEMPTS;
+  retry.nextAtMs = nowMs;
+  retry.deadlineMs = deadlineMs;
+
+  uint32_t delayMs = minRetryMs;
+  for (uint8_t i = recentFailures(health); i > 0 && delayMs < SENSOR_RETRY_MAX_MS; i--) {
+    delayMs *= 2;
+  }
+  retry.delayMs = delayMs < SENSOR_RETRY_MAX_MS ? delayMs : SENSOR_RETRY_MAX_MS;
+}
+
+bool sensorRetryDue(const SensorRetry& retry, uint32_t nowMs) {
+  return (retry.state == SENSOR_RETRY_IDLE || retry.state == SENSOR_RETRY_WAITING) &&
+         (int32_t)(nowMs - retry.nextAtMs) >= 0;
+}
+
+bool sensorRetryDone(const SensorRetry& retry) {
+  return retry.state == SENSOR_RETRY_OK || retry.state == SENSOR_RETRY_FAILED;
+}
+
+void sensorRetryResult(SensorRetry& retry, SensorHealth& health, bool ok, uint32_t nowMs) {
+  retry.attempts++;
+  if (ok) {
+    finish(retry, health, true);
+    return;
+  }
+
+  // Sem tentativas ou sem prazo para a próxima
+  uint32_t nextAtMs = nowMs + retry.delayMs;
+  if (retry.attempts >= retry.maxAttempts || (int32_t)(nextAtMs - retry.deadlineMs) > 0) {
+    finish(retry, health, false);
+    return;
+  }
+
+  retry.state = SENSOR_RETRY_WAITING;
+  retry.nextAtMs = nextAtMs;
+  retry.delayMs = retry.delayMs * 2 < SENSOR_RETRY_MAX_MS ? retry.delayMs * 2 : SENSOR_RETRY_MAX_MS;
+}
@@ -0,0 +1,117 @@
+#include "SleepScheduler.h"
+#include <math.h>
+
+// Intervalo mínimo entre duas leituras para estimar a tendência de pressão
+#define PRESSURE_TREND_MIN_SECONDS 600
+// Peso da nova estimativa na média exponencial da tendência
+#define PRESSURE_TREND_ALPHA 0.5f
+// Fator de crescimento do intervalo em condições estáveis
+#define STABLE_GROWTH_NUM 3
+#define STABLE_GROWTH_DEN 2
+
+// Atualiza a tendência de pressão (hPa/h) com a leitura atual
+static void updatePressureTrend(SleepSchedulerState& state, const SleepSchedulerInputs& inputs) {
+  if (isnan(inputs.pressureHpa)) {
+    state.pressureTrend = NAN;
+    return;
+  }
+
+  if (!state.valid || isnan(state.lastPressureHpa) || inputs.now < state.lastPressureTime) {
+    state.lastPressureHpa = inputs.pressureHpa;
+    state.lastPressureTime = inputs.now;
+    state.pressureTrend = NAN;
+    return;
+  }
+
+  time_t elapsed = inputs.now - state.lastPressureTime;
+  if (elapsed < PRESSURE_TREND_MIN_SECONDS) {
+    // Muito próximo da leitura anterior: mantém a tendência atual
+    return;
+  }
+
+  float trend = (inputs.pressureHpa - state.lastPressureHpa) * 3600.0f / (float)elapsed;
+  if (isnan(state.pressureTrend)) {
+    state.pressureTrend = trend;
+  } else {
+    state.pressureTrend += PRESSURE_TREND_ALPHA * (trend - state.pressureTrend);
+  }
+  state.lastPressureHpa = inputs.pressureHpa;
+  state.lastPressureTime = inputs.now;
+}
+
+SleepDecision scheduleNextWake(const SleepSchedulerConfig& config, SleepSchedulerState& state,
+                               const SleepSchedulerInputs& inputs) {
+  updatePressureTrend(state, inputs);
+
+  uint16_t minMinutes = config.minMinutes > 0 ? config.minMinutes : 1;
+  uint16_t maxMinutes = config.maxMinutes >= minMinutes ? config.maxMinutes : minMinutes;
+  uint16_t lastMinutes = state.valid ? state.lastMinutes : config.baseMinutes;
+  bool trendKnown = !isnan(state.pressureTrend);
+  float trendAbs = trendKnown ? fabsf(state.pressureTrend) : 0.0f;
+
+  SleepDecision decision;
+  decision.pressureTrend = state.pressureTrend;
+
+  if (inputs.batteryVoltage < config.criticalBatteryVoltage) {
+    // Preserva o que resta da bateria, mesmo durante chuva
+    decision.minutes = maxMinutes;
+    decision.reason = SLEEP_REASON_BATTERY_CRITICAL;
+  } else if (inputs.rainLastHourMm > 0.0f) {
+    decision.minutes = minMinutes;
+    decision.reason = SLEEP_REASON_RAIN;
+  } else if (trendKnown && trendAbs >= config.fastPressureHpaPerHour) {
+    decision.minutes = (minMinutes + config.baseMinutes) / 2;
+    decision.reason = SLEEP_REASON_PRESSURE;
+  } else if (inputs.batteryVoltage < config.lowBatteryVoltage) {
+    decision.minutes = config.baseMinutes * 2;
+    decision.reason = SLEEP_REASON_BATTERY_LOW;
+  } else if (!trendKnown || trendAbs < config.stablePressureHpaPerHour) {
+    // Sem chuva e pressão estável (ou sem sensor de pressão): aumenta o intervalo
+    // gradualmente a partir do último, para voltar rápido ao base se algo mudar
+    uint16_t start = lastMinutes > config.baseMinutes ? lastMinutes : config.baseMinutes;
+    uint32_t grown = (uint32_t)start * STABLE_GROWTH_NUM / STABLE_GROWTH_DEN;
+    decision.minutes = grown > 0xFFFF ? 0xFFFF : (uint16_t)grown;
+    decision.reason = SLEEP_REASON_STABLE;
+  } else {
+    decision.minutes = config.baseMinutes;
+    decision.reason = SLEEP_REASON_BASE;
+  }
+
+  if (decision.minutes < minMinutes) decision.minutes = minMinutes;
+  if (decision.minutes > maxMinutes) decision.minutes = maxMinutes;
+
+  state.lastMinutes = decision.minutes;
+  state.valid = true;
+  return decision;
+}
+
+time_t sleepAlignedWake(time_t now, uint16_t minutes, uint16_t minLeadSeconds) {
+  // Grade: mdc(minutes, 60) minutos
+  uint32_t a = minutes > 0 ? minutes : 1;
+  uint32_t b = 60;
+  while (b != 0) {
+    uint32_t r = a % b;
+    a = b;
+    b = r;
+  }
+  time_t grid = (time_t)a * 60;
+
+  time_t target = now + (time_t)(minutes > 0 ? minutes : 1) * 60;
+  time_t wake = (target + grid / 2) / grid * grid;
+  while (wake < now + minLeadSeconds) {
+    wake += grid;
+  }
+  return wake;
+}
+
+const char* sleepReasonName(SleepReason reason) {
+  switch (reason) {
+    case SLEEP_REASON_BASE: return "base";
+    case SLEEP_REASON_RAIN: return "rain";
+    case SLEEP_REASON_PRESSURE: return "pressure";
+    case SLEEP_REASON_STABLE: return "stable";
+    case SLEEP_REASON_BATTERY_LOW: return "battery_low";
+    case SLEEP_REASON_BATTERY_CRITICAL: return "battery_critical";
+    default: return "?";
+  }
+}
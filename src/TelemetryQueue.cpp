@@ -0,0 +1,127 @@
+#include "TelemetryQueue.h"
+#include <string.h>
+
+#define TELEMETRY_SPILL_MAGIC 0x544C5131UL
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+    }
+  }
+  return ~crc;
+}
+
+void telemetryQueueReset(TelemetryQueue& queue) {
+  memset(&queue, 0, sizeof(queue));
+}
+
+void telemetrySpillReset(TelemetrySpill& spill) {
+  memset(&spill, 0, sizeof(spill));
+  spill.magic = TELEMETRY_SPILL_MAGIC;
+}
+
+uint32_t telemetryQueuePending(const TelemetryQueue& queue) {
+  return (uint32_t)queue.spilled + queue.count;
+}
+
+bool telemetryQueueFull(const TelemetryQueue& queue) {
+  return queue.count == TELEMETRY_QUEUE_FRAMES;
+}
+
+void telemetryQueuePush(TelemetryQueue& queue, const TelemetryFrame& frame) {
+  if (telemetryQueueFull(queue)) {
+    memmove(queue.frames, queue.frames + 1, (queue.count - 1) * sizeof(TelemetryFrame));
+    queue.count--;
+    queue.dropped++;
+  }
+  queue.frames[queue.count++] = frame;
+}
+
+uint16_t telemetryQueueSpill(TelemetryQueue& queue, TelemetrySpill& spill) {
+  uint16_t dropped = 0;
+  for (uint8_t i = 0; i < queue.count; i++) {
+    if (spill.count == TELEMETRY_SPILL_FRAMES) {
+      spill.head = (spill.head + 1) % TELEMETRY_SPILL_FRAMES;
+      spill.count--;
+      dropped++;
+    }
+    spill.frames[(spill.head + spill.count) % TELEMETRY_SPILL_FRAMES] = queue.frames[i];
+    spill.count++;
+  }
+  queue.count = 0;
+  queue.spilled = spill.count;
+  queue.dropped += dropped;
+  return dropped;
+}
+
+const TelemetryFrame* telemetryQueueAt(const TelemetryQueue& queue, const TelemetrySpill& spill, uint32_t i) {
+  if (i < queue.spilled) {
+    return &spill.frames[(spill.head + i) % TELEMETRY_SPILL_FRAMES];
+  }
+  i -= queue.spilled;
+  return i < queue.count ? &queue.frames[i] : nullptr;
+}
+
+void telemetryQueueDrop(TelemetryQueue& queue, TelemetrySpill& spill, uint32_t count) {
+  uint32_t fromSpill = count < queue.spilled ? count : queue.spilled;
+  if (fromSpill > 0) {
+    spill.head = (spill.head + fromSpill) % TELEMETRY_SPILL_FRAMES;
+    spill.count -= fromSpill;
+    queue.spilled = spill.count;
+  }
+
+  uint32_t fromQueue = count - fromSpill < queue.count ? count - fromSpill : queue.count;
+  queue.count -= fromQueue;
+  memmove(queue.frames, queue.frames + fromQueue, queue.count * sizeof(TelemetryFrame));
+}
+
+uint32_t telemetryQueueRebase(TelemetryQueue& queue, TelemetrySpill& spill, int64_t offsetSeconds) {
+  for (uint8_t i = 0; i < queue.count; i++) {
+    TelemetryFrame& frame = queue.frames[i];
+    if (frame.flags & TELEMETRY_FRAME_UNSYNCED) {
+      frame.timestamp = (uint32_t)(frame.timestamp + offsetSeconds);
+      frame.flags &= ~TELEMETRY_FRAME_UNSYNCED;
+    }
+  }
+
+  uint32_t changed = 0;
+  for (uint16_t i = 0; i < queue.spilled; i++) {
+    TelemetryFrame& frame = spill.frames[(spill.head + i) % TELEMETRY_SPILL_FRAMES];
+    if (frame.flags & TELEMETRY_FRAME_UNSYNCED) {
+      frame.timestamp = (uint32_t)(frame.timestamp + offsetSeconds);
+      frame.flags &= ~TELEMETRY_FRAME_UNSYNCED;
+      changed++;
+    }
+  }
+  return changed;
+}
+
+uint32_t telemetrySpillDropUnsynced(TelemetryQueue& queue, TelemetrySpill& spill) {
+  uint16_t kept = 0;
+  for (uint16_t i = 0; i < spill.count; i++) {
+    const TelemetryFrame& frame = spill.frames[(spill.head + i) % TELEMETRY_SPILL_FRAMES];
+    if (!(frame.flags & TELEMETRY_FRAME_UNSYNCED)) {
+      spill.frames[(spill.head + kept) % TELEMETRY_SPILL_FRAMES] = frame;
+      kept++;
+    }
+  }
+  uint32_t dropped = spill.count - kept;
+  spill.count = kept;
+  queue.spilled = kept;
+  queue.dropped += dropped;
+  return dropped;
+}
+
+void telemetrySpillSeal(TelemetrySpill& spill) {
+  spill.magic = TELEMETRY_SPILL_MAGIC;
+  spill.crc = crc32((const uint8_t*)&spill, offsetof(TelemetrySpill, crc));
+}
+
+bool telemetrySpillValid(const TelemetrySpill& spill) {
+  return spill.magic == TELEMETRY_SPILL_MAGIC && spill.count <= TELEMETRY_SPILL_FRAMES &&
+         spill.head < TELEMETRY_SPILL_FRAMES &&
+         spill.crc == crc32((const uint8_t*)&spill, offsetof(TelemetrySpill, crc));
+}
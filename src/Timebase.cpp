@@ -0,0 +1,87 @@
+#include "Timebase.h"
+#include <string.h>
+
+#define TIMEBASE_MAGIC 0x54494D45UL
+#define PPB 1000000000LL
+
+void timebaseReset(Timebase& timebase) {
+  memset(&timebase, 0, sizeof(timebase));
+  timebase.magic = TIMEBASE_MAGIC;
+}
+
+bool timebaseValid(const Timebase& timebase) {
+  return timebase.magic == TIMEBASE_MAGIC;
+}
+
+bool timebaseSynced(const Timebase& timebase) {
+  return timebaseValid(timebase) && timebase.anchorEpochUs != 0;
+}
+
+void timebaseSleep(Timebase& timebase, int64_t clockUs) {
+  timebase.sleepStartClockUs = clockUs;
+}
+
+void timebaseWake(Timebase& timebase, int64_t clockUs) {
+  if (timebase.sleepStartClockUs != 0 && clockUs > timebase.sleepStartClockUs) {
+    timebase.sleptClockUs += clockUs - timebase.sleepStartClockUs;
+  }
+  timebase.sleepStartClockUs = 0;
+}
+
+// Quanto o relógio adiantou no sono desde a âncora, pelo desvio aprendido
+static int64_t sleepErrorUs(const Timebase& timebase) {
+  return timebase.sleptClockUs * timebase.driftPpb / (PPB + timebase.driftPpb);
+}
+
+int64_t timebaseNowUs(const Timebase& timebase, int64_t clockUs) {
+  if (!timebaseSynced(timebase)) {
+    return clockUs;
+  }
+  return timebase.anchorEpochUs + (clockUs - timebase.anchorClockUs) - sleepErrorUs(timebase);
+}
+
+time_t timebaseNow(const Timebase& timebase, int64_t clockUs) {
+  return (time_t)(timebaseNowUs(timebase, clockUs) / 1000000LL);
+}
+
+int64_t timebaseSleepUs(const Timebase& timebase, int64_t clockUs, int64_t wakeEpochUs) {
+  int64_t realUs = wakeEpochUs - timebaseNowUs(timebase, clockUs);
+  if (realUs <= 0) {
+    return 0;
+  }
+  return realUs + realUs * timebase.driftPpb / PPB;
+}
+
+void timebaseSync(Timebase& timebase, int64_t clockBeforeUs, int64_t clockAfterUs, int64_t epochUs) {
+  if (!timebaseSynced(timebase)) {
+    // Sem âncora a base era o próprio relógio
+    timebase.unsyncedOffsetUs = epochUs - clockBeforeUs;
+  } else {
+    // O relógio adiantou errorUs em relação ao NTP desde a âncora, todo durante o sono:
+    // desvio = errorUs / tempo real dormido
+    int64_t errorUs = (clockBeforeUs - timebase.anchorClockUs) - (epochUs - timebase.anchorEpochUs);
+    int64_t sleptUs = timebase.sleptClockUs - errorUs;
+    if (sleptUs >= (int64_t)TIMEBASE_MIN_DRIFT_SLEEP_MINUTES * 60 * 1000000LL) {
+      int64_t measured = errorUs * PPB / sleptUs;
+      int64_t limit = (int64_t)TIMEBASE_MAX_DRIFT_PPM * 1000;
+      if (measured >= -limit && measured <= limit) {
+        // A primeira medida é usada inteira; as seguintes entram na média exponencial
+        if (timebase.driftSamples == 0) {
+          timebase.driftPpb = (int32_t)measured;
+        } else {
+          timebase.driftPpb += (int32_t)((measured - timebase.driftPpb) / TIMEBASE_DRIFT_SMOOTHING);
+        }
+        if (timebase.driftSamples < UINT16_MAX) {
+          timebase.driftSamples++;
+        }
+      }
+    }
+  }
+
+  timebase.anchorClockUs = clockAfterUs;
+  timebase.anchorEpochUs = epochUs;
+  timebase.sleptClockUs = 0;
+  if (timebase.syncs < UINT16_MAX) {
+    timebase.syncs++;
+  }
+}
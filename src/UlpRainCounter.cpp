@@ -0,0 +1,219 @@
+#include "UlpRainCounter.h"
+#include <string.h>
+
+#ifdef USE_ULP_RAIN_COUNTER
+  #include <Arduino.h>
+  #include "Log.h"
+  #include <esp32/ulp.h>
+  #include <driver/rtc_io.h>
+  #include <soc/rtc_cntl_reg.h>
+  #include <soc/rtc_io_reg.h>
+#endif
+
+// Offsets das variáveis relativos ao início da área de dados (registrador R3 do programa)
+#define REL(var) ((var) - ULP_RAIN_PROGRAM_WORDS)
+
+uint16_t ulpRainHarvest(volatile uint32_t* mem, time_t now, UlpRainTipCallback onTip) {
+  uint16_t total = mem[ULP_RAIN_VAR_TOTAL] & 0xFFFF;
+  uint16_t minute = mem[ULP_RAIN_VAR_MINUTE] & 0xFFFF;
+  uint16_t currentBin = mem[ULP_RAIN_VAR_BINS + (minute & (ULP_RAIN_BINS - 1))] & 0xFFFF;
+  uint16_t lastTotal = mem[ULP_RAIN_VAR_LAST_TOTAL] & 0xFFFF;
+  uint16_t lastMinute = mem[ULP_RAIN_VAR_LAST_MINUTE] & 0xFFFF;
+  uint16_t lastBinCount = mem[ULP_RAIN_VAR_LAST_BIN] & 0xFFFF;
+
+  uint16_t newTips = total - lastTotal;
+  uint16_t elapsed = minute - lastMinute;
+  uint16_t span = elapsed < ULP_RAIN_BINS - 1 ? elapsed : ULP_RAIN_BINS - 1;
+
+  // Distribui as basculadas novas pelos minutos, do mais recente para o mais antigo;
+  // o total é a referência e os bins só dão a posição no tempo
+  uint16_t perMinute[ULP_RAIN_BINS];
+  uint16_t remaining = newTips;
+  for (uint16_t age = 0; age <= span; age++) {
+    uint16_t m = minute - age;
+    uint16_t count = mem[ULP_RAIN_VAR_BINS + (m & (ULP_RAIN_BINS - 1))] & 0xFFFF;
+    if (age == elapsed) {
+      // Bin parcialmente colhido na chamada anterior
+      count = count > lastBinCount ? count - lastBinCount : 0;
+    }
+    perMinute[age] = count < remaining ? count : remaining;
+    remaining -= perMinute[age];
+  }
+
+  // Basculadas cujo bin já foi sobrescrito ficam no minuto mais antigo conhecido
+  perMinute[span] += remaining;
+
+  // Entrega em ordem cronológica
+  for (int age = span; age >= 0; age--) {
+    for (uint16_t i = 0; i < perMinute[age]; i++) {
+      onTip(now - (time_t)age * 60);
+    }
+  }
+
+  mem[ULP_RAIN_VAR_LAST_TOTAL] = total;
+  mem[ULP_RAIN_VAR_LAST_MINUTE] = minute;
+  mem[ULP_RAIN_VAR_LAST_BIN] = currentBin;
+  return newTips;
+}
+
+UlpRainCounterSim::UlpRainCounterSim() {
+  memset(memory, 0, sizeof(memory));
+}
+
+void UlpRainCounterSim::reset(uint8_t initialLevel) {
+  memset(memory, 0, sizeof(memory));
+  memory[ULP_RAIN_VAR_MAGIC] = ULP_RAIN_MAGIC;
+  memory[ULP_RAIN_VAR_LEVEL] = initialLevel;
+}
+
+// Mesma sequência de operações do programa montado em UlpRainCounter::start()
+void UlpRainCounterSim::run(uint8_t level) {
+  uint32_t* data = &memory[ULP_RAIN_PROGRAM_WORDS];
+
+  // Contagem de amostras e virada de minuto
+  data[REL(ULP_RAIN_VAR_TICKS)] = (data[REL(ULP_RAIN_VAR_TICKS)] + 1) & 0xFFFF;
+  if (data[REL(ULP_RAIN_VAR_TICKS)] >= ULP_RAIN_TICKS_PER_MINUTE) {
+    data[REL(ULP_RAIN_VAR_TICKS)] = 0;
+    data[REL(ULP_RAIN_VAR_MINUTE)] = (data[REL(ULP_RAIN_VAR_MINUTE)] + 1) & 0xFFFF;
+    data[REL(ULP_RAIN_VAR_BINS) + (data[REL(ULP_RAIN_VAR_MINUTE)] & (ULP_RAIN_BINS - 1))] = 0;
+  }
+
+  // Debounce
+  if (level == data[REL(ULP_RAIN_VAR_LEVEL)]) {
+    data[REL(ULP_RAIN_VAR_COUNT)] = 0;
+    return;
+  }
+  data[REL(ULP_RAIN_VAR_COUNT)] = (data[REL(ULP_RAIN_VAR_COUNT)] + 1) & 0xFFFF;
+  if (data[REL(ULP_RAIN_VAR_COUNT)] < ULP_RAIN_DEBOUNCE_SAMPLES) {
+    return;
+  }
+  data[REL(ULP_RAIN_VAR_LEVEL)] = level;
+  data[REL(ULP_RAIN_VAR_COUNT)] = 0;
+
+  // Só a borda para o nível de wake é uma basculada
+  if (level != RAIN_GAUGE_WAKE_LEVEL) {
+    return;
+  }
+  data[REL(ULP_RAIN_VAR_TOTAL)] = (data[REL(ULP_RAIN_VAR_TOTAL)] + 1) & 0xFFFF;
+  uint32_t bin = REL(ULP_RAIN_VAR_BINS) + (data[REL(ULP_RAIN_VAR_MINUTE)] & (ULP_RAIN_BINS - 1));
+  data[bin] = (data[bin] + 1) & 0xFFFF;
+}
+
+#ifdef USE_ULP_RAIN_COUNTER
+
+// Instância global
+UlpRainCounter ulpRainCounter;
+
+bool UlpRainCounter::isLoaded() {
+  return (RTC_SLOW_MEM[ULP_RAIN_VAR_MAGIC] & 0xFFFF) == ULP_RAIN_MAGIC;
+}
+
+void UlpRainCounter::start() {
+  // Pino do pluviômetro como entrada RTC (pull-up externo, ver README)
+  rtc_gpio_init(RAIN_GAUGE_INTERRUPT_PIN);
+  rtc_gpio_set_direction(RAIN_GAUGE_INTERRUPT_PIN, RTC_GPIO_MODE_INPUT_ONLY);
+  int io = rtc_io_number_get(RAIN_GAUGE_INTERRUPT_PIN);
+
+  // Boot a frio: zera contadores e referência de colheita, partindo do nível
+  // atual do pino para não contar uma borda falsa. Nos demais ciclos os contadores
+  // são preservados e o programa (idêntico) apenas é recarregado.
+  if (!isLoaded()) {
+    for (int i = ULP_RAIN_PROGRAM_WORDS; i < ULP_RAIN_MEMORY_WORDS; i++) {
+      RTC_SLOW_MEM[i] = 0;
+    }
+    RTC_SLOW_MEM[ULP_RAIN_VAR_LEVEL] = rtc_gpio_get_level(RAIN_GAUGE_INTERRUPT_PIN);
+  }
+
+  enum { L_SAMPLE, L_STABLE, L_DONE, LABELS };
+  const ulp_insn_t program[] = {
+    I_MOVI(R3, ULP_RAIN_PROGRAM_WORDS),
+
+    // Contagem de amostras e virada de minuto (zera o bin do novo minuto)
+    I_LD(R0, R3, REL(ULP_RAIN_VAR_TICKS)),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, REL(ULP_RAIN_VAR_TICKS)),
+    M_BL(L_SAMPLE, ULP_RAIN_TICKS_PER_MINUTE),
+    I_MOVI(R0, 0),
+    I_ST(R0, R3, REL(ULP_RAIN_VAR_TICKS)),
+    I_LD(R0, R3, REL(ULP_RAIN_VAR_MINUTE)),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, REL(ULP_RAIN_VAR_MINUTE)),
+    I_ANDI(R0, R0, ULP_RAIN_BINS - 1),
+    I_ADDR(R2, R3, R0),
+    I_MOVI(R1, 0),
+    I_ST(R1, R2, REL(ULP_RAIN_VAR_BINS)),
+
+    // Debounce: o novo nível precisa se manter por ULP_RAIN_DEBOUNCE_SAMPLES amostras
+    M_LABEL(L_SAMPLE),
+    I_RD_REG(RTC_GPIO_IN_REG, RTC_GPIO_IN_NEXT_S + io, RTC_GPIO_IN_NEXT_S + io),
+    I_LD(R1, R3, REL(ULP_RAIN_VAR_LEVEL)),
+    I_SUBR(R2, R0, R1),
+    M_BXZ(L_STABLE),
+    I_LD(R2, R3, REL(ULP_RAIN_VAR_COUNT)),
+    I_ADDI(R2, R2, 1),
+    I_ST(R2, R3, REL(ULP_RAIN_VAR_COUNT)),
+    I_MOVR(R1, R0),
+    I_MOVR(R0, R2),
+    M_BL(L_DONE, ULP_RAIN_DEBOUNCE_SAMPLES),
+    I_ST(R1, R3, REL(ULP_RAIN_VAR_LEVEL)),
+    I_MOVI(R2, 0),
+    I_ST(R2, R3, REL(ULP_RAIN_VAR_COUNT)),
+    I_MOVR(R0, R1),
+
+    // Só a borda para o nível de wake é uma basculada
+#if RAIN_GAUGE_WAKE_LEVEL
+    M_BL(L_DONE, 1),
+#else
+    M_BGE(L_DONE, 1),
+#endif
+    I_LD(R0, R3, REL(ULP_RAIN_VAR_TOTAL)),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R3, REL(ULP_RAIN_VAR_TOTAL)),
+    I_LD(R0, R3, REL(ULP_RAIN_VAR_MINUTE)),
+    I_ANDI(R0, R0, ULP_RAIN_BINS - 1),
+    I_ADDR(R2, R3, R0),
+    I_LD(R0, R2, REL(ULP_RAIN_VAR_BINS)),
+    I_ADDI(R0, R0, 1),
+    I_ST(R0, R2, REL(ULP_RAIN_VAR_BINS)),
+    M_BX(L_DONE),
+
+    M_LABEL(L_STABLE),
+    I_MOVI(R2, 0),
+    I_ST(R2, R3, REL(ULP_RAIN_VAR_COUNT)),
+
+    M_LABEL(L_DONE),
+    I_HALT()
+  };
+
+  // Rótulos e o M_BRANCH de cada M_B* são entradas de macro, que não viram instruções
+  enum { BRANCHES = 5 };
+  static_assert(sizeof(program) / sizeof(program[0]) - LABELS - BRANCHES <= ULP_RAIN_PROGRAM_WORDS,
+                "programa ULP invade as variáveis ULP_RAIN_VAR_*");
+
+  size_t size = sizeof(program) / sizeof(program[0]);
+  if (ulp_process_macros_and_load(0, program, &size) != ESP_OK) {
+    LOG_E("Falha ao carregar o programa do contador ULP");
+    return;
+  }
+
+  RTC_SLOW_MEM[ULP_RAIN_VAR_MAGIC] = ULP_RAIN_MAGIC;
+  ulp_set_wakeup_period(0, ULP_RAIN_SAMPLE_PERIOD_US);
+  ulp_run(0);
+}
+
+uint16_t UlpRainCounter::harvest(time_t now, UlpRainTipCallback onTip) {
+  if (!isLoaded()) {
+    return 0;
+  }
+
+  // Para o timer e espera a execução corrente (poucas dezenas de instruções) terminar
+  CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  delayMicroseconds(100);
+
+  uint16_t tips = ulpRainHarvest(RTC_SLOW_MEM, now, onTip);
+
+  SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+  return tips;
+}
+
+#endif // USE_ULP_RAIN_COUNTER
@@ -0,0 +1,106 @@
+#include "WakeProfiler.h"
+#include "Log.h"
+#include <esp_timer.h>
+
+// Histórico de perfis - persiste durante o deep sleep
+RTC_DATA_ATTR WakeProfileLog wakeProfileLog;
+
+// Instância global
+WakeProfiler wakeProfiler;
+
+WakeProfiler::WakeProfiler() {
+  memset(&_current, 0, sizeof(_current));
+  _phase = PHASE_BOOT;
+  _phaseStartUs = 0;
+  _active = false;
+  _hasPrevious = false;
+}
+
+void WakeProfiler::begin() {
+  memset(&_current, 0, sizeof(_current));
+
+  // Guarda uma cópia do ciclo anterior antes que o buffer seja sobrescrito
+  _hasPrevious = wakeProfileLog.count > 0;
+  if (_hasPrevious) {
+    _previous = *history(0);
+  }
+
+  // esp_timer conta a partir do boot, então tudo até aqui pertence a PHASE_BOOT
+  _phase = PHASE_BOOT;
+  _phaseStartUs = 0;
+  _active = true;
+  enter(PHASE_CONFIG);
+}
+
+void WakeProfiler::setWakeReason(uint8_t wakeReason) {
+  _current.wakeReason = wakeReason;
+}
+
+void WakeProfiler::enter(WakePhase phase) {
+  if (!_active) return;
+
+  int64_t now = esp_timer_get_time();
+  _current.phaseUs[_phase] += (uint32_t)(now - _phaseStartUs);
+  _phase = phase;
+  _phaseStartUs = now;
+}
+
+void WakeProfiler::finish() {
+  if (!_active) return;
+
+  enter(PHASE_SLEEP);
+  _active = false;
+  _current.totalUs = (uint32_t)esp_timer_get_time();
+
+  wakeProfileLog.entries[wakeProfileLog.head] = _current;
+  wakeProfileLog.head = (wakeProfileLog.head + 1) % WAKE_PROFILE_HISTORY;
+  if (wakeProfileLog.count < WAKE_PROFILE_HISTORY) {
+    wakeProfileLog.count++;
+  }
+  wakeProfileLog.cycles++;
+}
+
+const WakeProfile* WakeProfiler::previous() const {
+  return _hasPrevious ? &_previous : nullptr;
+}
+
+uint8_t WakeProfiler::historyCount() const {
+  return wakeProfileLog.count;
+}
+
+const WakeProfile* WakeProfiler::history(uint8_t age) const {
+  if (age >= wakeProfileLog.count) return nullptr;
+  uint8_t index = (wakeProfileLog.head + WAKE_PROFILE_HISTORY - 1 - age) % WAKE_PROFILE_HISTORY;
+  return &wakeProfileLog.entries[index];
+}
+
+void WakeProfiler::printHistory() const {
+  #if LOG_LEVEL >= LOG_LEVEL_INFO
+    LOG_I("Perfil dos últimos %u ciclos (total de ciclos: %lu)",
+          wakeProfileLog.count, (unsigned long)wakeProfileLog.cycles);
+    for (uint8_t age = 0; age < wakeProfileLog.count; age++) {
+      const WakeProfile* profile = history(age);
+      char line[LOG_LINE_MAX];
+      int length = snprintf(line, sizeof(line), "  -%u [wake %u] total %lu ms:", age + 1,
+                            profile->wakeReason, (unsigned long)(profile->totalUs / 1000));
+      for (uint8_t p = 0; p < PHASE_COUNT && length < (int)sizeof(line); p++) {
+        length += snprintf(line + length, sizeof(line) - length, " %s=%lu", phaseName((WakePhase)p),
+                           (unsigned long)(profile->phaseUs[p] / 1000));
+      }
+      LOG_I("%s", line);
+    }
+  #endif
+}
+
+const char* WakeProfiler::phaseName(WakePhase phase) {
+  switch (phase) {
+    case PHASE_BOOT: return "boot";
+    case PHASE_CONFIG: return "config";
+    case PHASE_WIFI: return "wifi";
+    case PHASE_NTP: return "ntp";
+    case PHASE_SENSORS: return "sensors";
+    case PHASE_SEND: return "send";
+    case PHASE_SLEEP: return "sleep";
+    default: return "?";
+  }
+}
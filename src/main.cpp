@@ -19,14 +19,48 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
-#include <Wire.h>
 #include <time.h>
+#include <sys/time.h>
+#include <esp_sntp.h>
+#include <driver/rtc_io.h>
+#include <esp_system.h>
+#include <esp_partition.h>
 #include "config.h"
 #include "ConfigManager.h"
+#include "WakeProfiler.h"
+#include "UlpRainCounter.h"
+#include "SleepScheduler.h"
+#include "RuntimeBudget.h"
+#include "Log.h"
+#include "EnergyModel.h"
+#include "RainHistory.h"
+#include "RainRollup.h"
+#include "RainLog.h"
+#include "RainRate.h"
+#include "RainEvent.h"
+#include "TelemetryQueue.h"
+#include "Timebase.h"
+#include "SensorSnapshot.h"
+#include "SensorRetry.h"
+#include "SensorDrivers.h"
+#include "SensorFilter.h"
 
 // Inclui suporte a Meshtastic se a flag estiver definida
 #ifdef USE_MESHTASTIC
   #include "meshtastic-protobuf.h"
+  
+  // Campos além dos de base no Meshtastic, em grupos que vão inteiros em um pacote, na
+  // ordem em que entram no pacote principal e nos seguintes
+  enum MeshtasticGroup {
+    MESH_RAIN_TOTALS,               // rain_7d, rain_30d e rain_mtd
+    MESH_RAIN_RATE,                 // rain_rate e rain_peak_*
+    MESH_SLEEP,                     // Decisão do agendador adaptativo
+    MESH_RAW,                       // Leituras brutas
+    MESH_ENERGY,                    // Consumo estimado
+    MESH_PROFILE,                   // Perfil de tempo do ciclo anterior
+    MESH_BUDGET,                    // Estouros de prazo e descartes
+    MESH_GROUP_COUNT
+  };
 #endif
 
 // Inclui suporte a MQTT se a flag estiver definida
@@ -36,37 +70,84 @@
   PubSubClient mqttClient(wifiClient);
 #endif
 
-// Sensor-specific includes and initialization
-#ifdef USE_DHT22
-    #include <DHT.h>
-    DHT dht(DHT_PIN, DHT22);
-#endif
-
-#ifdef USE_AHT20
-    #include <Adafruit_AHTX0.h>
-    Adafruit_AHTX0 aht;
-#endif
-
-#ifdef USE_BMP280
-    #include <Adafruit_BMP280.h>
-    Adafruit_BMP280 bmp;
-#endif
-
-// Estrutura para armazenar um registro de chuva
-struct RainRecord {
-  uint32_t timestamp;  // Timestamp em milissegundos desde o início (ou em segundos desde o epoch)
-  float amount;        // Quantidade de chuva em mm
-};
-
 // Define RTC variables that persist through deep sleep
 RTC_DATA_ATTR int rainCounter = 0;    // Rain counter
 RTC_DATA_ATTR bool isFirstRun = true; // Flag for first run after power-on
 RTC_DATA_ATTR bool needsConfiguration = false; // Flag to enter configuration mode
-RTC_DATA_ATTR uint32_t lastResetTime = 0;  // Último tempo em que o sistema foi resetado (em segundos)
-RTC_DATA_ATTR time_t lastNTPSync = 0;      // Última vez que sincronizamos com NTP (timestamp Unix)
-RTC_DATA_ATTR RainRecord rainHistory[MAX_RAIN_RECORDS]; // Histórico de registros de chuva
-RTC_DATA_ATTR int rainHistoryCount = 0;    // Número atual de registros no histórico
+RTC_DATA_ATTR RainHistory rainHistory;      // Basculadas por intervalo de 5 min nas últimas 24 h
+RTC_DATA_ATTR RainRollup rainRollup;        // Totais por hora, dia e mês para janelas de até um ano
+RTC_DATA_ATTR RainRate rainRate;            // Últimas basculadas e picos de intensidade das últimas 24 h
+RTC_DATA_ATTR RainEventTable rainEvents;    // Evento de chuva aberto e eventos encerrados ainda não publicados
+RTC_DATA_ATTR uint32_t rainCheckpointHour = 0;  // Hora local (rainRollup.hourBin) da última cópia no flash
+RTC_DATA_ATTR uint32_t rainCheckpointTips = 0;  // rainRollup.totalTips na última cópia no flash
+RTC_DATA_ATTR RainLog rainLog;              // Basculadas ainda não gravadas no log de chuva em flash
 RTC_DATA_ATTR float totalRainfall = 0.0;   // Total acumulado de chuva (mm)
+RTC_DATA_ATTR TelemetryQueue telemetryQueue;  // Leituras não enviadas (as mais antigas ficam no flash)
+
+// Parâmetros do caminho rápido de basculadas, copiados da configuração a cada ciclo
+// completo para que um wake do pluviômetro não precise montar o SPIFFS
+struct RainFastPathCache {
+  bool valid;
+  float rainMmPerTip;
+  uint16_t flushTips;         // Basculadas pendentes que forçam um ciclo completo
+  uint16_t flushMinutes;      // Latência máxima (min) de uma basculada ainda não transmitida
+  uint16_t eventDryMinutes;   // Pausa seca (min) que encerra um evento de chuva
+};
+RTC_DATA_ATTR RainFastPathCache rainFastPath = {false, 0.0, 0, 0, 0};
+RTC_DATA_ATTR int pendingRainTips = 0;           // Basculadas registradas desde o último ciclo completo
+RTC_DATA_ATTR time_t firstPendingTipTime = 0;    // Timestamp da primeira basculada pendente
+RTC_DATA_ATTR int64_t scheduledTimerWakeUs = 0;  // Horário (relógio RTC, us) do próximo wake por timer
+
+// Dados da última conexão WiFi bem-sucedida, para reconectar sem varredura de canais nem DHCP
+struct WiFiFastConnectCache {
+  bool valid;
+  uint32_t ssidHash;        // Invalida o cache se o SSID configurado mudar
+  uint8_t bssid[6];
+  int32_t channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t netmask;
+  uint32_t dns;
+  uint16_t fastSuccesses;   // Conexões rápidas bem-sucedidas desde o power-on
+  uint16_t fastFailures;    // Conexões rápidas que precisaram da varredura completa
+};
+RTC_DATA_ATTR WiFiFastConnectCache wifiCache = {};
+
+// Tendência de pressão e último intervalo do agendador adaptativo
+RTC_DATA_ATTR SleepSchedulerState sleepSchedulerState = {};
+
+// Histórico de leituras de cada sensor de EnabledSensors, que decide as novas tentativas
+// (ver SensorRetry.h)
+#define SENSOR_SLOTS (EnabledSensors::count > 0 ? EnabledSensors::count : 1)
+RTC_DATA_ATTR SensorHealth sensorHealth[SENSOR_SLOTS] = {};
+
+// Estimativas filtradas e últimas leituras brutas de cada grandeza (ver SensorFilter.h)
+RTC_DATA_ATTR SensorFilterChannel temperatureFilter = {};
+RTC_DATA_ATTR SensorFilterChannel humidityFilter = {};
+RTC_DATA_ATTR SensorFilterChannel pressureFilter = {};
+
+const SensorFilterParams temperatureFilterParams = {
+  100, SENSOR_FILTER_TEMPERATURE_NOISE, SENSOR_FILTER_TEMPERATURE_DRIFT
+};
+const SensorFilterParams humidityFilterParams = {
+  100, SENSOR_FILTER_HUMIDITY_NOISE, SENSOR_FILTER_HUMIDITY_DRIFT
+};
+const SensorFilterParams pressureFilterParams = {
+  1000, SENSOR_FILTER_PRESSURE_NOISE, SENSOR_FILTER_PRESSURE_DRIFT
+};
+
+// Consumo acumulado desde a instalação da bateria. RTC_NOINIT_ATTR para sobreviver também
+// ao ESP.restart() do modo de configuração; validado pelo magic e zerado no power-on.
+RTC_NOINIT_ATTR EnergyAccount energyAccount;
+
+// Âncora NTP e desvio do relógio RTC; RTC_NOINIT_ATTR porque o relógio do sistema também
+// sobrevive ao restart. Zerada no power-on, quando o relógio recomeça.
+RTC_NOINIT_ATTR Timebase timebase;
+
+const EnergyModelConfig energyModel = {
+  ENERGY_DEEP_SLEEP_MA, ENERGY_CPU_BASE_MA, ENERGY_CPU_MA_PER_MHZ,
+  ENERGY_WIFI_RX_MA, ENERGY_WIFI_TX_MA, ENERGY_WIFI_TX_DUTY, ENERGY_BLE_MA
+};
 
 // Define wake-up sources
 #define TIMER_WAKEUP 1
@@ -76,8 +157,22 @@ RTC_DATA_ATTR int wakeupReason = 0;
 
 // Variables for runtime management
 unsigned long startTime; // To track how long the device has been running
-float rainLastHour = 0.0;
-float rainLast24Hours = 0.0;
+unsigned long wifiStartTime = 0;          // Momento em que a associação WiFi foi iniciada
+int64_t wifiOnUs = 0;                     // esp_timer ao ligar o WiFi (0 = não ligado)
+int64_t wifiOffUs = 0;                    // esp_timer ao desligar o WiFi (0 = ainda ligado)
+bool wifiFastAttempt = false;             // Conexão atual usa BSSID/canal/IP do cache
+bool wifiPortalPending = false;           // WiFi falhou no boot a frio: portal depois da fila
+volatile bool ntpSyncPending = false;     // Sincronização NTP devida neste wake e ainda não concluída
+int64_t ntpStartClockUs = 0;              // Relógio do sistema quando a sincronização foi iniciada...
+int64_t ntpStartTimerUs = 0;              // ...e esp_timer no mesmo instante, para o relógio logo antes do ajuste
+TelemetrySpill telemetrySpill;            // Leituras não enviadas no flash; lido só quando necessário
+bool telemetrySpillLoaded = false;
+bool telemetrySpillDirty = false;         // Mudou neste wake e ainda não foi gravado
+uint8_t telemetryBatchesSent = 0;         // Lotes da fila enviados neste wake
+SleepDecision sleepDecision;              // Próximo intervalo de sono escolhido neste ciclo
+SensorReadings *sensorTarget = nullptr;   // Leituras ainda em aquisição; nullptr quando todos os sensores terminaram
+SensorRetry sensorRetry[SENSOR_SLOTS];    // Tentativas de cada sensor neste wake
+bool sleepDecisionReady = false;          // false: saídas antecipadas usam o intervalo configurado
 
 // Define battery monitoring variables
 #define BATTERY_ADC_PIN 35  // GPIO35 (ADC1_CH7)
@@ -85,53 +180,115 @@ float rainLast24Hours = 0.0;
 #define ADC_WIDTH ADC_WIDTH_BIT_12  // Resolução de 12 bits (0-4095)
 
 // Function prototypes
+bool handleRainTipFastPath();
+void onUlpRainTip(time_t timestamp);
+void storeRainTip(time_t timestamp);
+int64_t rtcTimeUs();
+void armWakeSources(uint64_t sleepTimeUs);
 void setupWiFi();
+bool waitForWiFi();
+void runWiFiFailurePortal();
+void fallbackToFullWiFiScan();
+void saveWiFiFastConnect();
+uint32_t hashString(const char* text);
+void onWiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info);
+void onNTPSync(struct timeval *tv);
+bool ntpSyncDue();
+void startNTPSync();
+void waitForNTPSync(uint32_t timeoutMs);
 void setupSensors();
-bool readSensorData(float &temperature, float &humidity);
+void startSensorRead(SensorReadings &readings);
+bool pollSensorRead();
+void finishSensorRead();
+SensorSnapshot takeSensorSnapshot(const SensorReadings &readings);
+void readRainSnapshot(SensorSnapshot &snapshot);
+void filterSensorReadings(SensorSnapshot &snapshot);
 void addRainRecord(float amount);
 float getRainLastHour();
 float getRainLast24Hours();
 void manageRainHistory();
-
-#ifdef USE_DHT22
-bool readDHT22(float &temperature, float &humidity);
-#endif
-
-#ifdef USE_AHT20
-bool readAHT20(float &temperature, float &humidity);
-#endif
-
-#ifdef USE_BMP280
-bool readBMP280(float &temperature, float &humidity);
-#endif
+void updateRainRollupTotals(SensorSnapshot &snapshot);
+void updateRainIntensity(SensorSnapshot &snapshot);
+void addRainTotals(JsonDocument &doc, const SensorSnapshot &snapshot);
+void addRainIntensity(JsonDocument &doc, const SensorSnapshot &snapshot);
+void addSensorReadings(JsonDocument &doc, const SensorSnapshot &snapshot);
+void addRawReadings(JsonDocument &doc, const SensorSnapshot &snapshot);
+const char* sensorNames();
+void restoreRainRollup();
+void checkpointRainRollup(bool force);
+bool openRainLog(RainLogFlash &flash);
+void rebuildRainFromLog();
+void commitRainLog(bool force);
+String rainEventJson(const RainEvent &event);
+void loadTelemetrySpill();
+void saveTelemetrySpill();
+void spillTelemetryQueue();
+void queueTelemetry(const SensorSnapshot &snapshot);
+void rebaseTelemetryQueue();
+void dropUnsyncedTelemetry();
+uint32_t nextTelemetryBatch(String &json, size_t maxBytes);
+void addBacklogValue(JsonArray row, bool present, double value);
+void ackTelemetryBatch(uint32_t count);
+void finishTelemetryDrain();
 
 #ifdef USE_MESHTASTIC
-void sendDataToMeshtastic(float temperature, float humidity, float rainAmount);
+bool sendDataToMeshtastic(const SensorSnapshot &snapshot);
+bool putMeshtasticData(const String &url, const String &dataString);
+void addMeshtasticGroup(JsonDocument &doc, const SensorSnapshot &snapshot, uint8_t group);
+uint8_t packMeshtasticGroups(JsonDocument &doc, const SensorSnapshot &snapshot,
+                             uint8_t group, bool headerOnly, String &dataString);
 #endif
 
 #ifdef USE_MQTT
-bool sendDataToMQTT(float temperature, float humidity, float rainAmount);
+bool sendDataToMQTT(const SensorSnapshot &snapshot);
 #endif
 void printWakeupReason();
+void planNextWake(const SensorSnapshot &snapshot);
 void setupDeepSleep();
 void setCpuFrequency();
-bool shouldEnterSleep();
 float getBatteryVoltage();
 int batteryLevel(float voltage);
-void syncTimeWithNTP();
 time_t getLocalTime();
+void addWakeProfile(JsonDocument &doc);
+void addSleepDecision(JsonDocument &doc);
+void addBudgetStats(JsonDocument &doc);
+void addRuntimeEstimate(JsonDocument &doc, const SensorSnapshot &snapshot);
+void addEnergyEstimate(JsonDocument &doc);
+void accountEnergy(uint64_t sleepUs, bool configMode);
 
 void setup() {
+  // Fim do deep sleep: o tempo dormido é o que o desvio do relógio RTC afeta
+  if (timebaseValid(timebase)) {
+    timebaseWake(timebase, rtcTimeUs());
+  }
+  
+  // Wake do pluviômetro: registra a basculada e volta a dormir sem rádio
+  // quando não há nada a transmitir com urgência
+  bool rainTipRecorded = handleRainTipFastPath();
+  
   // Record the start time
   startTime = millis();
+  wakeProfiler.begin();
+  runtimeBudget.begin(startTime);
+  
+  // A serial só é aberta com um host conectado; sem host as mensagens ficam na memória RTC
+  logBegin();
   
-  // Initialize serial communication
-  Serial.begin(115200);
+  // Bateria nova (power-on ou brownout) ou memória RTC sem acumulado válido
+  esp_reset_reason_t resetReason = esp_reset_reason();
+  if (resetReason == ESP_RST_POWERON || resetReason == ESP_RST_BROWNOUT ||
+      !energyAccountValid(energyAccount)) {
+    energyAccountReset(energyAccount);
+  }
   
-  // Short delay to allow serial to initialize
-  delay(1000);
+  // O relógio do sistema também recomeça: a base de tempo perde a âncora NTP
+  bool clockRestarted = resetReason == ESP_RST_POWERON || resetReason == ESP_RST_BROWNOUT ||
+                        !timebaseValid(timebase);
+  if (clockRestarted) {
+    timebaseReset(timebase);
+  }
   
-  Serial.println("\n\nESP32 Weather Station Starting...");
+  LOG_I("ESP32 Weather Station Starting...");
   
   // Set ADC resolution to battery monitoring
   analogReadResolution(12);  // Define resolução de 12 bits
@@ -139,22 +296,41 @@ void setup() {
 
   // Initialize ConfigManager
   if (!configManager.begin()) {
-    Serial.println("Failed to initialize ConfigManager!");
+    LOG_E("Failed to initialize ConfigManager!");
     // Continue with default values
   }
   
+  // Boot a frio (power-on, brownout ou restart): a memória RTC foi zerada e a chuva é
+  // reconstruída da cópia dos totais longos e do log no flash; as leituras não enviadas
+  // que já estavam no flash continuam na fila
+  if (isFirstRun) {
+    restoreRainRollup();
+    rebuildRainFromLog();
+    loadTelemetrySpill();
+    if (clockRestarted) {
+      dropUnsyncedTelemetry();
+    }
+  }
+  
   // Determine wake-up reason
   printWakeupReason();
+  wakeProfiler.setWakeReason(wakeupReason);
   
   // Get current configuration
   WeatherStationConfig* config = configManager.getConfig();
   
-  // Connect to WiFi and sync time
-  setupWiFi();
+  // Atualiza os parâmetros usados pelo caminho rápido nos próximos wakes
+  rainFastPath.rainMmPerTip = config->rainMmPerTip;
+  rainFastPath.flushTips = config->rainFlushTips;
+  rainFastPath.flushMinutes = config->rainFlushMinutes;
+  rainFastPath.eventDryMinutes = config->rainEventDryMinutes;
+  rainFastPath.valid = true;
 
   // Check if device should enter config mode
   if (needsConfiguration || configManager.checkConfigButtonPressed()) {
-    Serial.println("Entering configuration mode...");
+    logAttachSerial();
+    LOG_I("Entering configuration mode...");
+    wakeProfiler.printHistory();
     
     #ifdef USE_CONFIG_PORTAL
       // Start configuration interfaces
@@ -174,141 +350,175 @@ void setup() {
       // Clean up
       configManager.stopConfigPortal();
       configManager.stopBLEServer();
+      accountEnergy(0, true);
+      
+      LOG_I("Exiting configuration mode");
       
-      Serial.println("Exiting configuration mode");
+      // A memória RTC não sobrevive ao restart
+      commitRainLog(true);
+      checkpointRainRollup(true);
+      spillTelemetryQueue();
       
       // Return to normal operation
       ESP.restart();
       return;
     #else
-      Serial.println("Configuration portal not enabled in this build");
+      LOG_W("Configuration portal not enabled in this build");
     #endif
   }
   
   // Set CPU frequency to value from configuration
   setCpuFrequency();
   
-  // If this is the first run after power-on, initialize rain counter
+  // O contador de chuva do primeiro ciclo já veio do log no flash
   if (isFirstRun) {
-    Serial.println("First run after power-on, initializing rain counter");
-    rainCounter = 0;
+    LOG_I("First run after power-on");
     isFirstRun = false;
   }
   
+  // Inicia a associação WiFi em segundo plano; DHCP e NTP seguem sozinhos
+  // enquanto os sensores são lidos, e só esperamos pela rede antes do envio
+  setupWiFi();
+  wakeProfiler.enter(PHASE_SENSORS);
+  runtimeBudget.enter(BUDGET_SENSORS);
+  
   // Initialize sensors
   setupSensors();
   
-  // Read sensor data
-  float temperature = 0.0;
-  float humidity = 0.0;
-  float rainAmount = 0.0;
-  
-  // Check if we should enter sleep
-  if (shouldEnterSleep()) {
-    setupDeepSleep();
-    Serial.println("Maximum runtime exceeded, entering deep sleep...");
-    esp_deep_sleep_start();
-    return; // This will never be reached
+  // Leituras dos sensores e da bateria deste wake. Novas tentativas de um sensor que
+  // falhou correm durante as esperas pelo WiFi e pelo NTP
+  SensorReadings readings = {};
+  startSensorRead(readings);
+  
+  // Cada fase tem prazo próprio; aqui só resta verificar se o orçamento total acabou.
+  // Sem tempo, a espera pela rede e o envio ficam para o próximo wake, mas a chuva é
+  // registrada, o snapshot é montado e a leitura vai para a fila
+  bool outOfTime = runtimeBudget.exhausted();
+  if (outOfTime) {
+    LOG_W("Maximum runtime exceeded after sensor reading, queueing the reading");
   }
   
-  // Read temperature and humidity
-  bool sensorReadSuccess = readSensorData(temperature, humidity);
-  
-  // Check again if we should enter sleep after sensor reading
-  if (shouldEnterSleep()) {
-    setupDeepSleep();
-    Serial.println("Maximum runtime exceeded after sensor reading, entering deep sleep...");
-    esp_deep_sleep_start();
-    return; // This will never be reached
+  // Aguarda a conexão iniciada em setupWiFi() (e o NTP) antes de registrar a chuva,
+  // para que os registros usem o timestamp sincronizado
+  if (!outOfTime && waitForWiFi()) {
+    wakeProfiler.enter(PHASE_NTP);
+    runtimeBudget.enter(BUDGET_NTP);
+    waitForNTPSync(runtimeBudget.remaining());
   }
+  wakeProfiler.enter(PHASE_SENSORS);
+  runtimeBudget.leave();
+  
+  #ifdef USE_ULP_RAIN_COUNTER
+    // Basculadas contadas pelo ULP enquanto as CPUs dormiam, com timestamp por minuto
+    uint16_t ulpTips = ulpRainCounter.harvest(getLocalTime(), onUlpRainTip);
+    if (ulpTips > 0) {
+      rainCounter += ulpTips;
+      LOG_I("Basculadas contadas pelo ULP: %u", ulpTips);
+    }
+  #endif
   
   // Calculate rain amount
   float newRainAmount = 0.0;
-  if (wakeupReason == EXTERNAL_WAKEUP) {
+  if (wakeupReason == EXTERNAL_WAKEUP && !rainTipRecorded) {
     // Se acordou por interrupção, incrementa o contador de chuva
     rainCounter++;
-    Serial.println("Rain detected! Counter: " + String(rainCounter));
+    LOG_I("Rain detected! Counter: %lu", (unsigned long)rainCounter);
     
     // Calcula a quantidade equivalente deste registro e adiciona ao histórico
     newRainAmount = config->rainMmPerTip;
     addRainRecord(newRainAmount);
   }
   
-  // Gerencia o histórico de registros de chuva (elimina registros muito antigos)
+  // As basculadas acumuladas pelo caminho rápido são transmitidas neste ciclo
+  if (pendingRainTips > 0) {
+    LOG_I("Basculadas registradas sem rádio desde o último envio: %u", pendingRainTips);
+    pendingRainTips = 0;
+  }
+  
+  // Avança o histórico de chuva até agora (zera os intervalos que saíram das 24 h)
   // Isto é feito em todas as execuções, não apenas quando chove
   manageRainHistory();
   
-  // Calcula quantidade total de chuva com calibração da configuração
-  rainAmount = rainCounter * config->rainMmPerTip;
-  
-  // Calcula chuva na última hora e nas últimas 24 horas
-  // Estas funções agora retornam valores atualizados independentemente da causa do wakeup
-  /* float rainLastHour = getRainLastHour();
-  float rainLast24Hours = getRainLast24Hours();
-  
-  Serial.print("Chuva total acumulada: ");
-  Serial.print(rainAmount);
-  Serial.println(" mm");
-  Serial.print("Chuva na última hora: ");
-  Serial.print(rainLastHour);
-  Serial.println(" mm");
-  Serial.print("Chuva nas últimas 24 horas: ");
-  Serial.print(rainLast24Hours);
-  Serial.println(" mm"); */
-  
-  // Check if we should enter sleep
-  if (shouldEnterSleep()) {
-    setupDeepSleep();
-    Serial.println("Maximum runtime exceeded after WiFi connection, entering deep sleep...");
-    esp_deep_sleep_start();
-    return; // This will never be reached
-  }
-  
-  // Atualiza os cálculos de chuva após ter o timestamp NTP sincronizado
-  if (WiFi.status() == WL_CONNECTED) {
-    // Recalcula os valores de chuva com o timestamp atualizado
-    rainLastHour = getRainLastHour();
-    rainLast24Hours = getRainLast24Hours();    
-    /* Serial.println("Valores de chuva recalculados após sincronização NTP:");
-    Serial.print("Chuva na última hora: ");
-    Serial.print(rainLastHour);
-    Serial.println(" mm");
-    Serial.print("Chuva nas últimas 24 horas: ");
-    Serial.print(rainLast24Hours);
-    Serial.println(" mm"); */
+  // Grava no log as basculadas pendentes quando houver uma página ou a mais antiga
+  // passar de RAIN_LOG_MAX_DELAY_MINUTES
+  commitRainLog(false);
+  
+  // A espera pela rede pode ter consumido o resto do orçamento
+  if (!outOfTime && runtimeBudget.exhausted()) {
+    outOfTime = true;
+    LOG_W("Maximum runtime exceeded after WiFi connection, queueing the reading");
   }
   
+  // Tentativas de sensores que ainda faltam, até o prazo da fase de sensores
+  finishSensorRead();
+  
+  // O snapshot do wake, montado uma única vez: leituras filtradas, janelas de chuva e
+  // horário pela base de tempo, com ou sem WiFi neste wake. Todos os envios publicam os
+  // mesmos valores
+  const SensorSnapshot snapshot = takeSensorSnapshot(readings);
+  checkpointRainRollup(false);
+  
+  // Escolhe o próximo intervalo antes do envio para que a decisão vá na telemetria
+  planNextWake(snapshot);
+  
   // Send data via MQTT or Meshtastic based on build configuration
-  if (WiFi.status() == WL_CONNECTED) {
+  // O tempo restante da fase de envio é o timeout de cada conexão
+  wakeProfiler.enter(PHASE_SEND);
+  runtimeBudget.enter(BUDGET_SEND);
+  bool sent = false;
+  bool online = !outOfTime && WiFi.status() == WL_CONNECTED;
+  if (online && runtimeBudget.remaining() < BUDGET_MIN_SEND_MS) {
+    LOG_W("Not enough runtime left to send data");
+  } else if (online) {
     #ifdef USE_MQTT
       // Use MQTT if enabled in build
-      if (sendDataToMQTT(temperature, humidity, rainAmount)) {
-        Serial.println("Data successfully sent via MQTT");
+      sent = sendDataToMQTT(snapshot);
+      if (sent) {
+        LOG_I("Data successfully sent via MQTT");
       } else {
         // Fall back to Meshtastic if MQTT fails and Meshtastic is available
-        Serial.println("MQTT failed");
+        LOG_W("MQTT failed");
         #ifdef USE_MESHTASTIC
-          Serial.println("Falling back to Meshtastic");
-          sendDataToMeshtastic(temperature, humidity, rainAmount);
+          if (runtimeBudget.allowOptional(BUDGET_MIN_SEND_MS)) {
+            LOG_I("Falling back to Meshtastic");
+            sent = sendDataToMeshtastic(snapshot);
+          } else {
+            LOG_W("Not enough runtime left for Meshtastic fallback");
+          }
         #else
-          Serial.println("No fallback available");
+          LOG_W("No fallback available");
         #endif
       }
     #else
       // Use Meshtastic by default
-      sendDataToMeshtastic(temperature, humidity, rainAmount);
+      sent = sendDataToMeshtastic(snapshot);
     #endif
-    
-    // Disconnect WiFi before sleep to save power
+  }
+  runtimeBudget.leave();
+  
+  // Leitura não enviada (sem WiFi, sem tempo ou falha no envio): fica na fila e segue
+  // junto com o próximo envio bem-sucedido
+  if (!sent) {
+    queueTelemetry(snapshot);
+  }
+  
+  if (wifiPortalPending) {
+    runWiFiFailurePortal();
+  }
+  
+  // Disconnect WiFi before sleep to save power
+  if (WiFi.status() == WL_CONNECTED) {
     WiFi.disconnect(true);
     WiFi.mode(WIFI_OFF);
+    wifiOffUs = esp_timer_get_time();
   }
   
   // Configure deep sleep
   setupDeepSleep();
   
   // Enter deep sleep
-  Serial.println("Task completed, entering deep sleep...");
+  LOG_I("Task completed, entering deep sleep...");
+  wakeProfiler.finish();
   esp_deep_sleep_start();
 }
 
@@ -321,33 +531,12 @@ void setCpuFrequency() {
   WeatherStationConfig* config = configManager.getConfig();
   uint16_t cpuFreq = config->cpuFreqMHz;
   
-  Serial.print("Setting CPU frequency to ");
-  Serial.print(cpuFreq);
-  Serial.print("MHz...");
   if (setCpuFrequencyMhz(cpuFreq)) {
-    Serial.println("Success!");
+    LOG_I("CPU frequency set to %u MHz", cpuFreq);
   } else {
-    Serial.println("Failed!");
-  }
-  Serial.print("Current CPU frequency: ");
-  Serial.println(getCpuFrequencyMhz());
-}
-
-// Check if the maximum runtime has been exceeded
-bool shouldEnterSleep() {
-  unsigned long currentTime = millis();
-  unsigned long runTime = currentTime - startTime;
-  
-  if (runTime >= MAX_RUNTIME_MS) {
-    Serial.print("Runtime: ");
-    Serial.print(runTime);
-    Serial.print("ms exceeds maximum allowed runtime of ");
-    Serial.print(MAX_RUNTIME_MS);
-    Serial.println("ms");
-    return true;
+    LOG_E("Failed to set CPU frequency to %u MHz, running at %lu MHz",
+          cpuFreq, (unsigned long)getCpuFrequencyMhz());
   }
-  
-  return false;
 }
 
 // Print wake-up reason and set global variable
@@ -356,527 +545,871 @@ void printWakeupReason() {
   
   switch(wakeup_reason) {
     case ESP_SLEEP_WAKEUP_EXT0:
-      Serial.println("Wakeup caused by external signal using RTC_IO (rain gauge)");
+      LOG_I("Wakeup caused by external signal using RTC_IO (rain gauge)");
       wakeupReason = EXTERNAL_WAKEUP;
       break;
     case ESP_SLEEP_WAKEUP_EXT1:
-      Serial.println("Wakeup caused by external signal using RTC_CNTL (config button)");
+      LOG_I("Wakeup caused by external signal using RTC_CNTL (config button)");
       wakeupReason = BUTTON_WAKEUP;
       needsConfiguration = true;
       break;
     case ESP_SLEEP_WAKEUP_TIMER:
-      Serial.println("Wakeup caused by timer");
+      LOG_I("Wakeup caused by timer");
       wakeupReason = TIMER_WAKEUP;
       break;
     default:
-      Serial.printf("Wakeup was not caused by deep sleep: %d\n", wakeup_reason);
+      LOG_I("Wakeup was not caused by deep sleep: %d", wakeup_reason);
       wakeupReason = 0;
       break;
   }
 }
 
-// Connect to WiFi
+// Inicia a conexão WiFi sem bloquear - a associação e o DHCP ocorrem em segundo plano
 void setupWiFi() {
-  Serial.println("Connecting to WiFi...");
   
   // Get WiFi credentials from config
   WeatherStationConfig* config = configManager.getConfig();
   
+  // Dispara o NTP assim que o DHCP entregar um endereço, sem esperar pelo loop principal.
+  // A sincronização fica pendente desde já: waitForWiFi() pode ver a conexão antes de a
+  // tarefa de eventos tratar o GOT_IP, e waitForNTPSync() precisa esperar por ele
+  ntpSyncPending = ntpSyncDue();
+  WiFi.onEvent(onWiFiGotIP, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  
+  // Evita gravar as credenciais na flash a cada wake
+  WiFi.persistent(false);
   WiFi.mode(WIFI_STA);
-  WiFi.begin(config->wifiSsid, config->wifiPassword);
+  wifiOnUs = esp_timer_get_time();
+  
+  if (wifiCache.valid && wifiCache.ssidHash == hashString(config->wifiSsid)) {
+    // Conexão rápida: IP estático da última concessão e BSSID/canal conhecidos,
+    // sem varredura de canais nem DHCP
+    WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway),
+                IPAddress(wifiCache.netmask), IPAddress(wifiCache.dns));
+    WiFi.begin(config->wifiSsid, config->wifiPassword, wifiCache.channel, wifiCache.bssid);
+    wifiFastAttempt = true;
+    LOG_I("Connecting to %s (fast reconnect on channel %u)", config->wifiSsid, wifiCache.channel);
+  } else {
+    WiFi.begin(config->wifiSsid, config->wifiPassword);
+    LOG_I("Connecting to %s", config->wifiSsid);
+  }
+  wifiStartTime = millis();
+}
+
+// Abandona a conexão rápida e refaz a associação com varredura de canais e DHCP
+void fallbackToFullWiFiScan() {
+  WeatherStationConfig* config = configManager.getConfig();
   
-  Serial.print("Connecting to: ");
-  Serial.println(config->wifiSsid);
+  LOG_W("Fast reconnect failed, falling back to full scan");
+  wifiCache.fastFailures++;
+  wifiCache.valid = false;
+  wifiFastAttempt = false;
   
-  unsigned long startAttemptTime = millis();
+  WiFi.disconnect();
+  WiFi.config(IPAddress(), IPAddress(), IPAddress());  // Volta ao DHCP
+  WiFi.begin(config->wifiSsid, config->wifiPassword);
+}
+
+// Guarda BSSID, canal e a concessão DHCP atual para a conexão rápida do próximo wake
+void saveWiFiFastConnect() {
+  WeatherStationConfig* config = configManager.getConfig();
   
-  while (WiFi.status() != WL_CONNECTED && 
-         millis() - startAttemptTime < WIFI_TIMEOUT) {
-    Serial.print(".");
-    delay(100);
+  memcpy(wifiCache.bssid, WiFi.BSSID(), sizeof(wifiCache.bssid));
+  wifiCache.channel = WiFi.channel();
+  wifiCache.ip = WiFi.localIP();
+  wifiCache.gateway = WiFi.gatewayIP();
+  wifiCache.netmask = WiFi.subnetMask();
+  wifiCache.dns = WiFi.dnsIP(0);
+  wifiCache.ssidHash = hashString(config->wifiSsid);
+  wifiCache.valid = true;
+}
+
+// Hash FNV-1a de 32 bits
+uint32_t hashString(const char* text) {
+  uint32_t hash = 2166136261UL;
+  while (*text) {
+    hash ^= (uint8_t)*text++;
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+// Chamado pela tarefa de eventos do WiFi quando o DHCP conclui
+void onWiFiGotIP(WiFiEvent_t event, WiFiEventInfo_t info) {
+  if (ntpSyncPending) {
+    startNTPSync();
+  }
+}
+
+// Aguarda a conexão iniciada por setupWiFi(), até WIFI_TIMEOUT desde o seu início
+// ou o fim do orçamento de tempo, o que vier primeiro
+bool waitForWiFi() {
+  wakeProfiler.enter(PHASE_WIFI);
+  unsigned long wifiElapsed = millis() - wifiStartTime;
+  runtimeBudget.enter(BUDGET_WIFI, wifiElapsed < BUDGET_WIFI_MS ? BUDGET_WIFI_MS - wifiElapsed : 0);
+  
+  while (WiFi.status() != WL_CONNECTED && !runtimeBudget.expired()) {
+    // O AP pode ter mudado de canal ou a concessão expirado: volta à conexão completa
+    if (wifiFastAttempt && millis() - wifiStartTime >= WIFI_FAST_CONNECT_TIMEOUT) {
+      fallbackToFullWiFiScan();
+    }
+    
+    // Enquanto a associação não termina, faz as novas tentativas dos sensores que falharam
+    delay(pollSensorRead() ? 100 : SENSOR_POLL_MS);
   }
   
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.println();
-    Serial.print("Connected! IP address: ");
-    Serial.println(WiFi.localIP());
+    LOG_I("Connected! IP address: %s, ready %lu ms after start%s",
+          WiFi.localIP().toString().c_str(), millis() - wifiStartTime,
+          wifiFastAttempt ? " (fast reconnect)" : "");
     
-    // Sincronizar o relógio com NTP após conectar WiFi
-    syncTimeWithNTP();
+    if (wifiFastAttempt) {
+      wifiCache.fastSuccesses++;
+    } else {
+      saveWiFiFastConnect();
+    }
+    return true;
+  }
+  
+  // Falha mesmo após a varredura completa: o cache não vale mais
+  wifiCache.valid = false;
+  
+  // Em wakes do timer e do pluviômetro a leitura vai para a fila e o próximo wake tenta
+  // de novo. O portal só abre no boot a frio, e depois que a leitura estiver na fila
+  if (wakeupReason == TIMER_WAKEUP || wakeupReason == EXTERNAL_WAKEUP) {
+    LOG_E("Connection failed! Queueing the reading for the next wake");
   } else {
-    Serial.println();
-    Serial.println("Connection failed! Starting configuration portal...");
-    
-    #ifdef USE_CONFIG_PORTAL
-      // Disconnect failed WiFi connection
-      WiFi.disconnect(true);
-      
-      // Start configuration interfaces
-      configManager.startBLEServer();
-      configManager.startConfigPortal();
-      
-      unsigned long configStartTime = millis();
-      
-      // Stay in config mode for CONFIG_PORTAL_TIMEOUT seconds or until button pressed again
-      while (millis() - configStartTime < (CONFIG_PORTAL_TIMEOUT * 1000) && 
-             !configManager.checkConfigButtonPressed()) {
-        // Handle config portal
-        configManager.handlePortal();
-        delay(100);
-      }
-      
-      // Clean up
-      configManager.stopConfigPortal();
-      configManager.stopBLEServer();
-      
-      Serial.println("Exiting configuration mode after WiFi failure");
-      
-      // Restart device to try with new settings
-      ESP.restart();
-    #else
-      Serial.println("Configuration portal not enabled in this build");
-    #endif
+    LOG_E("Connection failed! Configuration portal opens after queueing the reading");
+    wifiPortalPending = true;
   }
+  return false;
 }
 
-#ifdef USE_DHT22
-// Read temperature and humidity from DHT22 sensor
-bool readDHT22(float &temperature, float &humidity) {
-  Serial.println("Reading DHT22 sensor...");
-  
-  // Read values multiple times for reliability
-  for (int i = 0; i < 3; i++) {
-    humidity = dht.readHumidity();
-    temperature = dht.readTemperature();
+// Portal de configuração depois de uma falha de WiFi no boot a frio; a leitura deste
+// wake já está na fila
+void runWiFiFailurePortal() {
+  #ifdef USE_CONFIG_PORTAL
+    // Disconnect failed WiFi connection
+    WiFi.disconnect(true);
+    
+    // Start configuration interfaces
+    configManager.startBLEServer();
+    configManager.startConfigPortal();
     
-    if (!isnan(humidity) && !isnan(temperature)) {
-      Serial.print("Temperature: ");
-      Serial.print(temperature);
-      Serial.println(" °C");
-      Serial.print("Humidity: ");
-      Serial.print(humidity);
-      Serial.println(" %");
-      return true;
+    unsigned long configStartTime = millis();
+    
+    // Stay in config mode for CONFIG_PORTAL_TIMEOUT seconds or until button pressed again
+    while (millis() - configStartTime < (CONFIG_PORTAL_TIMEOUT * 1000) && 
+           !configManager.checkConfigButtonPressed()) {
+      // Handle config portal
+      configManager.handlePortal();
+      delay(100);
     }
     
-    Serial.println("Failed to read from DHT sensor, retrying...");
-    delay(2000);
-  }
-  
-  Serial.println("All attempts to read DHT sensor failed!");
-  return false;
+    // Clean up
+    configManager.stopConfigPortal();
+    configManager.stopBLEServer();
+    accountEnergy(0, true);
+    
+    LOG_I("Exiting configuration mode after WiFi failure");
+    
+    // A memória RTC não sobrevive ao restart
+    commitRainLog(true);
+    checkpointRainRollup(true);
+    spillTelemetryQueue();
+    
+    // Restart device to try with new settings
+    ESP.restart();
+  #else
+    LOG_W("Configuration portal not enabled in this build");
+  #endif
 }
-#endif
 
 #ifdef USE_MESHTASTIC
-// Send data to Meshtastic node using the toRadio API endpoint with proper protobuf structure
-void sendDataToMeshtastic(float temperature, float humidity, float rainAmount) {
-  Serial.println("Preparing data for Meshtastic node...");
+// Send data to Meshtastic node using the toRadio API endpoint with proper protobuf structure.
+// Retorna true se o nó aceitou a leitura.
+bool sendDataToMeshtastic(const SensorSnapshot &snapshot) {
+  LOG_D("Preparing data for Meshtastic node...");
   
   // Get Meshtastic configuration
   WeatherStationConfig* config = configManager.getConfig();
   
   // Create JSON document for the weather data
-  StaticJsonDocument<256> dataDoc;
-  
-  // Include temperature data
-  dataDoc["temperature"] = temperature;
-  
-  // Include sensor-specific data
-  #ifdef USE_DHT22
-    dataDoc["humidity"] = humidity;
-    dataDoc["sensor"] = "DHT22";
-  #endif
+  StaticJsonDocument<512> dataDoc;
   
-  // When both I2C sensors are used, we get more complete data
-  #if defined(USE_AHT20) && defined(USE_BMP280)
-    dataDoc["humidity"] = humidity;
-    float pressure = bmp.readPressure() / 100.0F; // Convert Pa to hPa
-    dataDoc["pressure"] = pressure;
-    dataDoc["sensor"] = "AHT20+BMP280";
-  #elif defined(USE_AHT20)
-    dataDoc["humidity"] = humidity;
-    dataDoc["sensor"] = "AHT20";
-  #elif defined(USE_BMP280)
-    dataDoc["pressure"] = bmp.readPressure() / 100.0F; // Convert Pa to hPa
-    dataDoc["sensor"] = "BMP280";
-  #endif
+  // Temperature and the other quantities of the enabled sensors
+  addSensorReadings(dataDoc, snapshot);
   
   // Include rain data and node identification
-  dataDoc["rain"] = rainAmount;
-  dataDoc["rain_1h"] = getRainLastHour();
-  dataDoc["rain_24h"] = getRainLast24Hours();
+  dataDoc["rain"] = snapshot.rain;
+  dataDoc["rain_1h"] = snapshot.rainLastHour;
+  dataDoc["rain_24h"] = snapshot.rainLast24Hours;
   dataDoc["node_name"] = config->deviceName;
   
-  // Adiciona apenas timestamp NTP (Unix) se disponível
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    time_t currentTime = getLocalTime();
-    dataDoc["timestamp"] = currentTime;  // Timestamp Unix (segundos desde 1970)
+  // Timestamp Unix pela base de tempo, mesmo sem NTP neste wake, desde que já tenha
+  // havido uma sincronização
+  if (snapshot.wallClock) {
+    dataDoc["timestamp"] = snapshot.timestamp;  // Timestamp Unix (segundos desde 1970)
   }
   
   // Add battery data
-  dataDoc["voltage"] = getBatteryVoltage();
-  dataDoc["BatteryLevel"] = batteryLevel(getBatteryVoltage());
-  
-  // Serialize weather data JSON to string
-  String dataString;
-  serializeJson(dataDoc, dataString);
-  
-  Serial.print("Weather data: ");
-  Serial.println(dataString);
-  
-  // ===== Usar estrutura protobuf para Meshtastic =====
+  dataDoc["voltage"] = round(snapshot.batteryVoltage * 100) / 100;
+  dataDoc["BatteryLevel"] = snapshot.batteryLevel;
   
-  // Criamos um pacote meteorológico usando o helper de nossa biblioteca
-  // 0 = ID de nó automático (usa o ID configurado no próprio dispositivo)
-  MeshPacket meshPacket = createWeatherDataPacket(dataString, 0);
+  // Autonomia projetada
+  addRuntimeEstimate(dataDoc, snapshot);
   
-  // Adicionar log para debug
-  Serial.print("Criado pacote de dados meteorológicos com ID: ");
-  Serial.println(meshPacket.id);
-  Serial.print("Tamanho dos dados: ");
-  Serial.print(meshPacket.payload.size);
-  Serial.print(" bytes de ");
-  Serial.print(sizeof(meshPacket.payload.data));
-  Serial.println(" disponíveis");
+  // Os campos acima vão sempre inteiros; os demais grupos entram enquanto couberem no
+  // pacote de MAX_DATA_PAYLOAD_SIZE bytes e o resto segue em pacotes seguintes
+  String dataString;
+  uint8_t group = packMeshtasticGroups(dataDoc, snapshot, 0, false, dataString);
   
-  // Converter a estrutura MeshPacket em JSON para a API HTTP do Meshtastic
-  String toRadioJson = createMeshtasticToRadioJson(meshPacket);
+  LOG_D("Weather data: %s", dataString.c_str());
   
   // Send data to Meshtastic node
-  Serial.println("Sending data to Meshtastic node...");
-  
-  HTTPClient http;
   String url = "http://" + String(config->meshtasticNodeIP) + ":" + 
                String(config->meshtasticNodePort) + MESHTASTIC_API_ENDPOINT;
   
-  Serial.print("Sending to URL: ");
-  Serial.println(url);
-  Serial.print("ToRadio payload (protobuf): ");
-  Serial.println(toRadioJson);
+  LOG_I("Sending data to Meshtastic node at %s", url.c_str());
   
   // Verificar se consegue conectar ao host Meshtastic
   bool hostReachable = false;
   
-  Serial.print("Verificando conexão com o host Meshtastic: ");
-  Serial.println(config->meshtasticNodeIP);
   
   IPAddress host;
-  if (host.fromString(config->meshtasticNodeIP)) {
-    // Tentar conexão TCP direta para verificar acessibilidade
+  if (!host.fromString(config->meshtasticNodeIP)) {
+    LOG_E("Endereço IP inválido: %s", config->meshtasticNodeIP);
+  } else if (!runtimeBudget.allowOptional(2 * BUDGET_MIN_SEND_MS)) {
+    // A verificação é opcional: com pouco tempo, vai direto ao envio
+    LOG_W("Pouco tempo restante, pulando verificação do host");
+    hostReachable = true;
+  } else {
+    // Tentar conexão TCP direta para verificar acessibilidade, com metade do tempo restante
     WiFiClient client;
-    if (client.connect(config->meshtasticNodeIP, config->meshtasticNodePort)) {
-      Serial.println("Conexão TCP bem-sucedida, host está acessível!");
+    if (client.connect(config->meshtasticNodeIP, config->meshtasticNodePort,
+                       runtimeBudget.remaining() / 2)) {
+      LOG_D("Conexão TCP bem-sucedida, host está acessível!");
       client.stop();
       hostReachable = true;
     } else {
-      Serial.println("Falha na conexão TCP. Host inacessível.");
+      LOG_W("Falha na conexão TCP. Host inacessível.");
     }
-  } else {
-    Serial.println("Endereço IP inválido!");
   }
   
   // Só tenta enviar se o host estiver acessível
+  if (!hostReachable) {
+    LOG_E("Não foi possível enviar dados - host Meshtastic inacessível; "
+          "verifique o endereço IP e a porta do nó Meshtastic nas configurações");
+    return false;
+  }
+  
+  if (!putMeshtasticData(url, dataString)) {
+    return false;
+  }
+  
+  // Grupos que não couberam no pacote principal, com o nome do nó e o timestamp para
+  // associá-los à leitura, enquanto houver tempo
+  while (group < MESH_GROUP_COUNT && runtimeBudget.allowOptional(BUDGET_MIN_SEND_MS)) {
+    dataDoc.clear();
+    dataDoc["node_name"] = config->deviceName;
+    if (snapshot.wallClock) {
+      dataDoc["timestamp"] = snapshot.timestamp;
+    }
+    group = packMeshtasticGroups(dataDoc, snapshot, group, true, dataString);
+    if (dataString.length() > 0 && !putMeshtasticData(url, dataString)) {
+      break;
+    }
+  }
+  if (group < MESH_GROUP_COUNT) {
+    LOG_W("Campos do Meshtastic não enviados neste wake (grupos %u a %u)",
+          group, MESH_GROUP_COUNT - 1);
+  }
+  
+  // Resumos dos eventos de chuva encerrados, um pacote cada, só depois do envio
+  // principal e enquanto houver tempo; cada um sai da fila quando é aceito pelo nó
+  const RainEvent* event;
+  while ((event = rainEventOldest(rainEvents)) != nullptr &&
+         runtimeBudget.allowOptional(BUDGET_MIN_SEND_MS)) {
+    String eventString = rainEventJson(*event);
+    LOG_D("Rain event: %s", eventString.c_str());
+    if (!putMeshtasticData(url, eventString)) {
+      break;
+    }
+    rainEventPop(rainEvents);
+  }
+  
+  // Leituras que ficaram na fila, várias por pacote
+  String batch;
+  uint32_t batchCount;
+  while ((batchCount = nextTelemetryBatch(batch, MAX_DATA_PAYLOAD_SIZE - 1)) > 0) {
+    if (!putMeshtasticData(url, batch)) {
+      break;
+    }
+    ackTelemetryBatch(batchCount);
+  }
+  finishTelemetryDrain();
+  return true;
+}
+
+// Adiciona ao payload os campos de um grupo de MeshtasticGroup
+void addMeshtasticGroup(JsonDocument &doc, const SensorSnapshot &snapshot, uint8_t group) {
+  switch (group) {
+    case MESH_RAIN_TOTALS:
+      addRainTotals(doc, snapshot);
+      break;
+    case MESH_RAIN_RATE:
+      addRainIntensity(doc, snapshot);
+      break;
+    case MESH_SLEEP:
+      addSleepDecision(doc);
+      break;
+    case MESH_RAW:
+      addRawReadings(doc, snapshot);
+      break;
+    case MESH_ENERGY:
+      addEnergyEstimate(doc);
+      break;
+    case MESH_PROFILE:
+      addWakeProfile(doc);
+      break;
+    case MESH_BUDGET:
+      addBudgetStats(doc);
+      break;
+  }
+}
+
+// Acrescenta a doc os grupos a partir de group enquanto o JSON couber em um pacote
+// Meshtastic e deixa em dataString o maior JSON que coube. Com headerOnly (doc só com o
+// nome e o timestamp), um grupo que não cabe nem sozinho é descartado com um aviso, e
+// dataString fica vazio se nenhum grupo entrou. Retorna o primeiro grupo não incluído
+uint8_t packMeshtasticGroups(JsonDocument &doc, const SensorSnapshot &snapshot,
+                             uint8_t group, bool headerOnly, String &dataString) {
+  dataString = "";
+  serializeJson(doc, dataString);
+  
+  for (; group < MESH_GROUP_COUNT; group++) {
+    addMeshtasticGroup(doc, snapshot, group);
+    String candidate;
+    serializeJson(doc, candidate);
+    if (candidate.length() >= MAX_DATA_PAYLOAD_SIZE) {
+      if (headerOnly) {
+        LOG_W("Grupo %u do Meshtastic com %u bytes não cabe em um pacote, descartado",
+              group, (unsigned)candidate.length());
+        group++;
+      }
+      break;
+    }
+    dataString = candidate;
+    headerOnly = false;
+  }
+  
+  if (headerOnly) {
+    dataString = "";
+  }
+  return group;
+}
+
+// Envia um JSON ao nó Meshtastic como pacote de dados meteorológicos (PUT no endpoint
+// toRadio), limitado ao prazo da fase de envio. Retorna true se o nó aceitou o pacote.
+bool putMeshtasticData(const String &url, const String &dataString) {
+  // ===== Usar estrutura protobuf para Meshtastic =====
+  
+  // Criamos um pacote meteorológico usando o helper de nossa biblioteca
+  // 0 = ID de nó automático (usa o ID configurado no próprio dispositivo)
+  MeshPacket meshPacket = createWeatherDataPacket(dataString, 0);
+  
+  // Adicionar log para debug
+  LOG_D("Criado pacote de dados meteorológicos com ID %lu: %u bytes de %u disponíveis",
+        (unsigned long)meshPacket.id, (unsigned)meshPacket.payload.size,
+        (unsigned)sizeof(meshPacket.payload.data));
+  
+  // Converter a estrutura MeshPacket em JSON para a API HTTP do Meshtastic
+  String toRadioJson = createMeshtasticToRadioJson(meshPacket);
+  LOG_D("ToRadio payload (protobuf): %s", toRadioJson.c_str());
+  
+  HTTPClient http;
   int httpResponseCode = -1;
   
-  if (hostReachable) {
-    // Configurar timeout de conexão maior
-    http.setConnectTimeout(10000); // 10 segundos
-    http.setTimeout(10000);        // 10 segundos para operações
-    
-    // Iniciar a conexão e enviar a requisição
-    if (http.begin(url)) {
-      http.addHeader("Content-Type", "application/json");
+  // Conexão e operações limitadas ao prazo da fase de envio
+  uint32_t timeoutMs = runtimeBudget.remaining();
+  http.setConnectTimeout(timeoutMs);
+  http.setTimeout(timeoutMs > 0xFFFF ? 0xFFFF : timeoutMs);
+  
+  // Iniciar a conexão e enviar a requisição
+  if (http.begin(url)) {
+    http.addHeader("Content-Type", "application/json");
+  
+    // The toRadio endpoint uses PUT request
+    httpResponseCode = http.PUT(toRadioJson);
     
-      // The toRadio endpoint uses PUT request
-      httpResponseCode = http.PUT(toRadioJson);
-      
-      if (httpResponseCode > 0) {
-        Serial.print("HTTP Response code: ");
-        Serial.println(httpResponseCode);
+    if (httpResponseCode > 0) {
+      #if LOG_LEVEL >= LOG_LEVEL_DEBUG
         String payload = http.getString();
-        Serial.println("Response: " + payload);
-        
-        if (httpResponseCode == 200 || httpResponseCode == 204) {
-          Serial.println("Message sent successfully to Meshtastic node!");
-        } else {
-          Serial.println("Unexpected response from Meshtastic node.");
-        }
+        LOG_D("HTTP Response code: %d, response: %s", httpResponseCode, payload.c_str());
+      #endif
+      
+      if (httpResponseCode == 200 || httpResponseCode == 204) {
+        LOG_I("Message sent successfully to Meshtastic node!");
       } else {
-        Serial.print("Error on sending PUT: ");
-        Serial.println(httpResponseCode);
-        // Exibir mais detalhes sobre o erro
-        switch (httpResponseCode) {
-          case -1: Serial.println("CONNECTION REFUSED"); break;
-          case -2: Serial.println("SEND HEADER FAILED"); break;
-          case -3: Serial.println("SEND PAYLOAD FAILED"); break;
-          case -4: Serial.println("NOT CONNECTED"); break;
-          case -5: Serial.println("CONNECTION LOST"); break;
-          case -6: Serial.println("NO STREAM"); break;
-          case -7: Serial.println("NO HTTP SERVER"); break;
-          case -8: Serial.println("TOO LESS RAM"); break;
-          case -9: Serial.println("ENCODING ERROR"); break;
-          case -10: Serial.println("STREAM WRITE ERROR"); break;
-          case -11: Serial.println("CONNECT FAIL"); break;
-          default: Serial.println("UNKNOWN ERROR"); break;
-        }
+        LOG_W("Unexpected response from Meshtastic node: %d", httpResponseCode);
       }
-      
-      http.end();
     } else {
-      Serial.println("Falha ao iniciar conexão HTTP");
+      // HTTPClient já traduz os códigos de erro (CONNECT FAIL, NOT CONNECTED...)
+      LOG_E("Error on sending PUT: %d (%s)", httpResponseCode,
+            HTTPClient::errorToString(httpResponseCode).c_str());
     }
+    
+    http.end();
   } else {
-    Serial.println("Não foi possível enviar dados - host Meshtastic inacessível");
-    Serial.println("Verifique o endereço IP e a porta do nó Meshtastic nas configurações");
+    LOG_E("Falha ao iniciar conexão HTTP");
   }
+  return httpResponseCode == 200 || httpResponseCode == 204;
 }
 #endif // USE_MESHTASTIC
 
 // Configure deep sleep
 void setupDeepSleep() {
-  Serial.println("Configuring deep sleep...");
+  wakeProfiler.enter(PHASE_SLEEP);
   
   // Get sleep time from config
   WeatherStationConfig* config = configManager.getConfig();
   
-  // Configure external wake-up source (rain gauge interrupt)
-  esp_sleep_enable_ext0_wakeup(RAIN_GAUGE_INTERRUPT_PIN, HIGH);
-  Serial.println("External wake-up configured on pin " + String(RAIN_GAUGE_INTERRUPT_PIN));
+  // Intervalo do agendador adaptativo; saídas antecipadas usam o valor configurado
+  uint16_t sleepMinutes = sleepDecisionReady ? sleepDecision.minutes : config->deepSleepTimeMinutes;
+  #ifdef USE_ULP_RAIN_COUNTER
+    if (sleepMinutes > ULP_RAIN_MAX_SLEEP_MINUTES) {
+      sleepMinutes = ULP_RAIN_MAX_SLEEP_MINUTES;
+    }
+  #endif
   
-  // Configure button wake-up (for configuration mode)
-  esp_sleep_enable_ext1_wakeup(1ULL << CONFIG_BUTTON_PIN, ESP_EXT1_WAKEUP_ALL_LOW);
-  Serial.println("Button wake-up configured on pin " + String(CONFIG_BUTTON_PIN));
+  // Com hora de parede o wake cai na grade do relógio (:00, :05...), com o timer corrigido
+  // pelo desvio do relógio RTC; sem NTP ainda, o intervalo é relativo
+  uint64_t sleepTime = sleepMinutes * uS_TO_MIN_FACTOR;
+  time_t wakeAt = 0;
+  if (timebaseSynced(timebase)) {
+    wakeAt = sleepAlignedWake(getLocalTime(), sleepMinutes, SLEEP_ALIGN_MIN_SECONDS);
+    sleepTime = timebaseSleepUs(timebase, rtcTimeUs(), (int64_t)wakeAt * 1000000LL);
+  }
   
-  // Configure timer wake-up
-  uint64_t sleepTime = config->deepSleepTimeMinutes * uS_TO_MIN_FACTOR;
-  esp_sleep_enable_timer_wakeup(sleepTime);
-  Serial.println("Timer wake-up configured for " + String(config->deepSleepTimeMinutes) + " minutes");
-}
-
-// Initialize the appropriate sensor based on build flags
-void setupSensors() {
-  #ifdef USE_DHT22
-    Serial.println("Initializing DHT22 sensor...");
-    dht.begin();
+  // Configura pluviômetro, botão e timer
+  armWakeSources(sleepTime);
+  #ifdef USE_ULP_RAIN_COUNTER
+    // O ULP conta as basculadas durante o sono; as CPUs não acordam a cada uma
+    ulpRainCounter.start();
   #endif
+  LOG_I("Deep sleep for %.1f s, %u min interval, wake at %ld (rain gauge pin %d, button pin %d)",
+        sleepTime / 1e6, sleepMinutes, (long)wakeAt, (int)RAIN_GAUGE_INTERRUPT_PIN, (int)CONFIG_BUTTON_PIN);
+  
+  // Guarda o horário do wake por timer para que os wakes do pluviômetro não o adiem
+  scheduledTimerWakeUs = rtcTimeUs() + sleepTime;
+  
+  // Consumo deste ciclo, incluindo o sono que vai começar
+  accountEnergy(sleepTime, false);
+}
 
-  // Initialize I2C once for both AHT20 and BMP280 if needed
-  #if defined(USE_AHT20) || defined(USE_BMP280)
-    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-  #endif
+// Soma ao acumulado o consumo do ciclo atual: CPU desde o boot, WiFi enquanto ligado,
+// BLE e portal no modo de configuração, e o deep sleep programado
+void accountEnergy(uint64_t sleepUs, bool configMode) {
+  int64_t now = esp_timer_get_time();
+  
+  EnergySample sample;
+  sample.activeUs = (uint32_t)now;
+  sample.wifiUs = 0;
+  sample.bleUs = 0;
+  sample.sleepUs = sleepUs;
+  sample.cpuMHz = getCpuFrequencyMhz();
+  if (wifiOnUs > 0) {
+    sample.wifiUs = (uint32_t)((wifiOffUs > 0 ? wifiOffUs : now) - wifiOnUs);
+  }
+  if (configMode) {
+    // BLE e ponto de acesso do portal ficam ligados durante todo o modo de configuração
+    sample.bleUs = sample.activeUs;
+    sample.wifiUs = sample.activeUs;
+  }
+  
+  energyAccountAdd(energyAccount, energyModel, sample);
+  LOG_I("Consumo do ciclo: %.4f mAh (acumulado %.1f mAh, média %.3f mA)",
+        energyAccount.lastCycleMah, energyAccount.consumedMah, energyAccount.averageMa);
+}
 
-  #ifdef USE_AHT20
-    Serial.println("Initializing AHT20 sensor...");
-    if (!aht.begin()) {
-      Serial.println("Could not find AHT20 sensor! Check wiring");
-    } else {
-      Serial.println("AHT20 sensor found");
+// Escolhe o próximo intervalo de sono a partir da chuva, da pressão e da bateria
+void planNextWake(const SensorSnapshot &snapshot) {
+  WeatherStationConfig* config = configManager.getConfig();
+  
+  SleepSchedulerConfig schedulerConfig;
+  schedulerConfig.baseMinutes = config->deepSleepTimeMinutes;
+  schedulerConfig.minMinutes = config->sleepMinMinutes;
+  schedulerConfig.maxMinutes = config->sleepMaxMinutes;
+  schedulerConfig.lowBatteryVoltage = SLEEP_LOW_BATTERY_VOLTAGE;
+  schedulerConfig.criticalBatteryVoltage = SLEEP_CRITICAL_BATTERY_VOLTAGE;
+  schedulerConfig.fastPressureHpaPerHour = SLEEP_FAST_PRESSURE_HPA_H;
+  schedulerConfig.stablePressureHpaPerHour = SLEEP_STABLE_PRESSURE_HPA_H;
+  #ifdef USE_ULP_RAIN_COUNTER
+    // Colheitas mais espaçadas que os bins do ULP perderiam o minuto das basculadas
+    if (schedulerConfig.maxMinutes > ULP_RAIN_MAX_SLEEP_MINUTES) {
+      schedulerConfig.maxMinutes = ULP_RAIN_MAX_SLEEP_MINUTES;
     }
-  #endif
-
-  #ifdef USE_BMP280
-    Serial.println("Initializing BMP280 sensor...");
-    if (!bmp.begin(BMP280_ADDRESS)) {
-      Serial.println("Could not find BMP280 sensor! Check wiring or try a different address");
-    } else {
-      // Default settings from the datasheet
-      bmp.setSampling(Adafruit_BMP280::MODE_NORMAL,     // Operating Mode
-                      Adafruit_BMP280::SAMPLING_X2,     // Temp. oversampling
-                      Adafruit_BMP280::SAMPLING_X16,    // Pressure oversampling
-                      Adafruit_BMP280::FILTER_X16,      // Filtering
-                      Adafruit_BMP280::STANDBY_MS_500); // Standby time
-      Serial.println("BMP280 sensor found");
+    if (schedulerConfig.minMinutes > ULP_RAIN_MAX_SLEEP_MINUTES) {
+      schedulerConfig.minMinutes = ULP_RAIN_MAX_SLEEP_MINUTES;
     }
   #endif
+  
+  SleepSchedulerInputs inputs;
+  inputs.now = snapshot.timestamp;
+  inputs.rainLastHourMm = snapshot.rainLastHour;
+  inputs.pressureHpa = snapshot.pressureHpa;
+  inputs.batteryVoltage = snapshot.batteryVoltage;
+  
+  sleepDecision = scheduleNextWake(schedulerConfig, sleepSchedulerState, inputs);
+  sleepDecisionReady = true;
+  
+  LOG_I("Próximo wake em %u min (%s, dP/dt=%.2f hPa/h, bateria=%.2f V)",
+        sleepDecision.minutes, sleepReasonName(sleepDecision.reason),
+        sleepDecision.pressureTrend, inputs.batteryVoltage);
 }
 
-// Main function to read sensor data
-bool readSensorData(float &temperature, float &humidity) {
-  bool success = false;
-
-  #ifdef USE_DHT22
-    success = readDHT22(temperature, humidity);
+// Habilita as fontes de wake: pluviômetro (ext0), botão de configuração (ext1) e timer
+void armWakeSources(uint64_t sleepTimeUs) {
+  #ifdef USE_ULP_RAIN_COUNTER
+    // Mantém os periféricos RTC ligados para o ULP ler o pino do pluviômetro
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  #else
+    esp_sleep_enable_ext0_wakeup(RAIN_GAUGE_INTERRUPT_PIN, RAIN_GAUGE_WAKE_LEVEL);
   #endif
+  esp_sleep_enable_ext1_wakeup(1ULL << CONFIG_BUTTON_PIN, ESP_EXT1_WAKEUP_ALL_LOW);
+  esp_sleep_enable_timer_wakeup(sleepTimeUs);
+  
+  // O sono começa logo depois das fontes de wake armadas
+  if (timebaseValid(timebase)) {
+    timebaseSleep(timebase, rtcTimeUs());
+  }
+}
 
-  // When both I2C sensors are used, prefer AHT20 for temperature/humidity
-  // and BMP280 for additional pressure reading
-  #if defined(USE_AHT20) && defined(USE_BMP280)
-    success = readAHT20(temperature, humidity);
-    // We'll read pressure from BMP280 separately when sending data
-  #elif defined(USE_AHT20)
-    success = readAHT20(temperature, humidity);
-  #elif defined(USE_BMP280)
-    success = readBMP280(temperature, humidity);
-  #endif
+// Tempo do relógio do sistema em microssegundos; mantido pelo RTC durante o deep sleep
+int64_t rtcTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
 
-  // If no sensor is defined, return false
-  if (!success) {
-    Serial.println("Failed to read from sensors or no sensors defined in build flags!");
+// Registra uma basculada colhida do contador ULP
+void onUlpRainTip(time_t timestamp) {
+  storeRainTip(timestamp);
+}
+
+// Caminho rápido para wakes do pluviômetro: registra a basculada usando apenas memória RTC
+// e volta ao deep sleep sem Serial, SPIFFS ou WiFi. Retorna true se a basculada foi
+// registrada e um ciclo completo deve transmiti-la (limite de basculadas, latência ou
+// timer vencido); não retorna se o dispositivo voltar a dormir.
+bool handleRainTipFastPath() {
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_EXT0 || !rainFastPath.valid) {
+    return false;
+  }
+  
+  time_t now = getLocalTime();
+  rainCounter++;
+  storeRainTip(now);
+  if (pendingRainTips == 0) {
+    firstPendingTipTime = now;
+  }
+  pendingRainTips++;
+  
+  int64_t remainingUs = scheduledTimerWakeUs - rtcTimeUs();
+  bool flushDue = pendingRainTips >= rainFastPath.flushTips ||
+                  now - firstPendingTipTime >= (time_t)rainFastPath.flushMinutes * 60 ||
+                  remainingUs <= 0;
+  if (flushDue) {
+    return true;
+  }
+  
+  // Espera a báscula liberar o contato; dormir com o pino ainda no nível de wake
+  // acordaria imediatamente e contaria a mesma basculada duas vezes
+  unsigned long releaseStart = millis();
+  while (rtc_gpio_get_level(RAIN_GAUGE_INTERRUPT_PIN) == RAIN_GAUGE_WAKE_LEVEL &&
+         millis() - releaseStart < RAIN_TIP_RELEASE_TIMEOUT_MS) {
+    delay(1);
+  }
+  
+  // O sono até o wake por timer já foi contabilizado pelo último ciclo completo
+  if (energyAccountValid(energyAccount)) {
+    accountEnergy(0, false);
   }
   
-  return success;
+  armWakeSources((uint64_t)remainingUs);
+  esp_deep_sleep_start();
+  return false; // This will never be reached
 }
 
-#ifdef USE_AHT20
-// Read temperature and humidity from AHT20 sensor
-bool readAHT20(float &temperature, float &humidity) {
-  Serial.println("Reading AHT20 sensor...");
+// Visitantes de EnabledSensors (ver SensorList.h); index é a posição em sensorHealth/sensorRetry
+struct SensorBeginVisitor {
+  const WeatherStationConfig &config;
   
-  sensors_event_t humidityEvent, temperatureEvent;
+  template <typename Driver> void visit(uint8_t index) {
+    Driver::begin(config);
+  }
+};
+
+struct SensorRetryBeginVisitor {
+  uint32_t now;
+  uint32_t deadline;
   
-  // Try reading a few times
-  for (int i = 0; i < 3; i++) {
-    if (aht.getEvent(&humidityEvent, &temperatureEvent)) {
-      humidity = humidityEvent.relative_humidity;
-      temperature = temperatureEvent.temperature;
-      
-      Serial.print("Temperature: ");
-      Serial.print(temperature);
-      Serial.println(" °C");
-      Serial.print("Humidity: ");
-      Serial.print(humidity);
-      Serial.println(" %");
-      return true;
+  template <typename Driver> void visit(uint8_t index) {
+    sensorRetryBegin(sensorRetry[index], sensorHealth[index], Driver::retryMinMs, now, deadline);
+  }
+};
+
+// Uma tentativa de cada sensor cuja hora já chegou
+struct SensorPollVisitor {
+  bool done;
+  bool ok;
+  
+  template <typename Driver> void visit(uint8_t index) {
+    SensorRetry &retry = sensorRetry[index];
+    SensorHealth &health = sensorHealth[index];
+    if (sensorRetryDue(retry, millis())) {
+      bool read = Driver::read(*sensorTarget, sensorQuantities<EnabledSensors, Driver>());
+      if (read) {
+        sensorTarget->quantities |= sensorQuantities<EnabledSensors, Driver>();
+      }
+      sensorRetryResult(retry, health, read, millis());
+      if (retry.state == SENSOR_RETRY_WAITING) {
+        LOG_W("Failed to read from %s sensor, retrying in %lu ms", Driver::name(),
+              (unsigned long)(retry.nextAtMs - millis()));
+      } else if (retry.state == SENSOR_RETRY_FAILED) {
+        LOG_E("No reading from %s sensor after %u attempts (%u wakes in a row)", Driver::name(),
+              retry.attempts, health.failStreak);
+      }
     }
-    
-    Serial.println("Failed to read from AHT20 sensor, retrying...");
-    delay(2000);
+    done = done && sensorRetryDone(retry);
+    ok = ok && retry.state == SENSOR_RETRY_OK;
   }
+};
+
+struct SensorNameVisitor {
+  char *names;
+  size_t size;
   
-  Serial.println("All attempts to read AHT20 sensor failed!");
-  return false;
+  template <typename Driver> void visit(uint8_t index) {
+    size_t length = strlen(names);
+    snprintf(names + length, size - length, index > 0 ? "+%s" : "%s", Driver::name());
+  }
+};
+
+// Initialize the sensors enabled in the build flags
+void setupSensors() {
+  SensorBeginVisitor begin = {*configManager.getConfig()};
+  EnabledSensors::forEach(begin);
 }
-#endif
 
-#ifdef USE_BMP280
-// Read temperature and pressure from BMP280 sensor (BMP280 doesn't have humidity, use 0)
-bool readBMP280(float &temperature, float &humidity) {
-  Serial.println("Reading BMP280 sensor...");
+// Inicia a leitura dos sensores e da bateria. A primeira tentativa de cada sensor é
+// feita agora; as novas tentativas não usam delay(): correm em pollSensorRead() durante
+// as esperas seguintes, até o prazo da fase de sensores
+void startSensorRead(SensorReadings &readings) {
+  uint32_t now = millis();
+  SensorRetryBeginVisitor begin = {now, now + runtimeBudget.remaining()};
+  EnabledSensors::forEach(begin);
+  readings.pressureHpa = NAN;
+  sensorTarget = &readings;
+  
+  // Uma única amostra do ADC para a tensão e o nível da bateria
+  readings.batteryVoltage = getBatteryVoltage();
+  readings.batteryLevel = batteryLevel(readings.batteryVoltage);
+  
+  pollSensorRead();
+}
+
+// Faz as tentativas que já venceram, dos sensores mais rápidos aos mais lentos; retorna
+// true quando todos os sensores terminaram
+bool pollSensorRead() {
+  if (sensorTarget == nullptr) {
+    return true;
+  }
   
-  // Try reading a few times
-  for (int i = 0; i < 3; i++) {
-    temperature = bmp.readTemperature();
-    // BMP280 doesn't measure humidity, so set humidity to 0
-    humidity = 0;
-    
-    float pressure = bmp.readPressure() / 100.0F; // Convert Pa to hPa
-    
-    if (!isnan(temperature) && !isnan(pressure)) {
-      Serial.print("Temperature: ");
-      Serial.print(temperature);
-      Serial.println(" °C");
-      Serial.print("Pressure: ");
-      Serial.print(pressure);
-      Serial.println(" hPa");
-      Serial.println("Note: BMP280 does not have humidity sensor");
-      return true;
-    }
-    
-    Serial.println("Failed to read from BMP280 sensor, retrying...");
-    delay(2000);
+  SensorPollVisitor poll = {true, true};
+  forEachByLatency<EnabledSensors>(poll);
+  if (EnabledSensors::count == 0) {
+    LOG_E("No sensors defined in build flags!");
+    poll.ok = false;
   }
   
-  Serial.println("All attempts to read BMP280 sensor failed!");
-  return false;
+  if (poll.done) {
+    sensorTarget->sensorOk = poll.ok;
+    sensorTarget = nullptr;
+  }
+  return poll.done;
+}
+
+// Nomes dos sensores do build para o campo "sensor" (ex.: "AHT20+BMP280")
+const char* sensorNames() {
+  static char names[32] = "";
+  if (names[0] == '\0') {
+    SensorNameVisitor visitor = {names, sizeof(names)};
+    EnabledSensors::forEach(visitor);
+  }
+  return names;
+}
+
+// Aguarda as tentativas que ainda faltam; o prazo foi fixado em startSensorRead()
+void finishSensorRead() {
+  while (!pollSensorRead()) {
+    delay(SENSOR_POLL_MS);
+  }
+}
+
+// O snapshot do wake a partir das leituras terminadas (finishSensorRead()), depois da
+// colheita do ULP e do NTP
+SensorSnapshot takeSensorSnapshot(const SensorReadings &readings) {
+  SensorSnapshot snapshot = {};
+  snapshot.sensor = sensorNames();
+  snapshot.sensorOk = readings.sensorOk;
+  snapshot.quantities = readings.quantities;
+  snapshot.rawTemperature = readings.temperature;
+  snapshot.rawHumidity = readings.humidity;
+  snapshot.rawPressureHpa = readings.pressureHpa;
+  snapshot.batteryVoltage = readings.batteryVoltage;
+  snapshot.batteryLevel = readings.batteryLevel;
+  snapshot.runtimeHours = energyProjectedHours(energyAccount, BATTERY_CAPACITY_MAH);
+  readRainSnapshot(snapshot);
+  filterSensorReadings(snapshot);
+  return snapshot;
+}
+
+// Leituras filtradas no snapshot: cada grandeza lida neste wake passa pelo seu filtro,
+// com o horário do snapshot. Uma grandeza que não foi lida fica com a estimativa
+// anterior do filtro, se recente, ou NAN: nunca com o valor bruto zerado
+void filterSensorReadings(SensorSnapshot &snapshot) {
+  if (snapshot.quantities & SENSOR_TEMPERATURE) {
+    snapshot.temperature = sensorFilterUpdate(temperatureFilter, temperatureFilterParams,
+                                              snapshot.rawTemperature, snapshot.timestamp);
+  } else {
+    snapshot.temperature = sensorFilterHeld(temperatureFilter, temperatureFilterParams, snapshot.timestamp);
+  }
+  if (snapshot.quantities & SENSOR_HUMIDITY) {
+    snapshot.humidity = sensorFilterUpdate(humidityFilter, humidityFilterParams,
+                                           snapshot.rawHumidity, snapshot.timestamp);
+  } else {
+    snapshot.humidity = sensorFilterHeld(humidityFilter, humidityFilterParams, snapshot.timestamp);
+  }
+  if (snapshot.quantities & SENSOR_PRESSURE) {
+    snapshot.pressureHpa = sensorFilterUpdate(pressureFilter, pressureFilterParams,
+                                              snapshot.rawPressureHpa, snapshot.timestamp);
+  } else {
+    snapshot.pressureHpa = sensorFilterHeld(pressureFilter, pressureFilterParams, snapshot.timestamp);
+  }
+  LOG_D("Filtered: %.2f °C, %.2f %%, %.2f hPa", snapshot.temperature, snapshot.humidity,
+        snapshot.pressureHpa);
+}
+
+// Completa o snapshot com a chuva e o horário, depois da colheita do ULP e do NTP
+void readRainSnapshot(SensorSnapshot &snapshot) {
+  float mmPerTip = configManager.getConfig()->rainMmPerTip;
+  snapshot.timestamp = getLocalTime();
+  snapshot.wallClock = timebaseSynced(timebase);
+  snapshot.rain = rainCounter * mmPerTip;
+  snapshot.rainLastHour = getRainLastHour();
+  snapshot.rainLast24Hours = getRainLast24Hours();
+  updateRainRollupTotals(snapshot);
+  updateRainIntensity(snapshot);
 }
-#endif
 
 #ifdef USE_MQTT
 // Function to send data via MQTT
-bool sendDataToMQTT(float temperature, float humidity, float rainAmount) {
-  Serial.println("Preparing to send data via MQTT...");
+bool sendDataToMQTT(const SensorSnapshot &snapshot) {
+  LOG_D("Preparing to send data via MQTT...");
   
   // Get MQTT configuration
   WeatherStationConfig* config = configManager.getConfig();
   
   // Skip if server is not configured
   if (strlen(config->mqttServer) == 0) {
-    Serial.println("MQTT server not configured, skipping");
+    LOG_W("MQTT server not configured, skipping");
     return false;
   }
   
   // Configure MQTT server
   mqttClient.setServer(config->mqttServer, config->mqttPort);
   
+  // O buffer padrão (256 bytes) é menor que o payload com os campos de diagnóstico
+  mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
+  
+  // Conexão TCP e espera pelo CONNACK limitadas ao prazo da fase de envio
+  // (ambos os timeouts são em segundos)
+  uint16_t timeoutSeconds = max(1UL, (unsigned long)runtimeBudget.remaining() / 1000);
+  wifiClient.setTimeout(timeoutSeconds);
+  mqttClient.setSocketTimeout(timeoutSeconds);
+  
   // Generate a client ID if not configured
   String clientId = config->mqttClientId;
   if (clientId.length() == 0) {
     clientId = "ESP32Weather-";
     clientId += String((uint32_t)(ESP.getEfuseMac() & 0xFFFFFF), HEX);
-    Serial.print("Generated MQTT client ID: ");
-    Serial.println(clientId);
+    LOG_D("Generated MQTT client ID: %s", clientId.c_str());
   }
   
   // Attempt to connect to MQTT broker
-  Serial.print("Connecting to MQTT broker at ");
-  Serial.print(config->mqttServer);
-  Serial.print(":");
-  Serial.println(config->mqttPort);
+  LOG_I("Connecting to MQTT broker at %s:%u", config->mqttServer, config->mqttPort);
   
   // Try connecting with credentials if provided
   bool connected = false;
   if (strlen(config->mqttUsername) > 0) {
-    Serial.println("Connecting with credentials");
     connected = mqttClient.connect(
       clientId.c_str(), 
       config->mqttUsername, 
       config->mqttPassword
     );
   } else {
-    Serial.println("Connecting without credentials");
     connected = mqttClient.connect(clientId.c_str());
   }
   
   if (!connected) {
-    Serial.print("Failed to connect to MQTT broker, error code: ");
-    Serial.println(mqttClient.state());
+    LOG_E("Failed to connect to MQTT broker, error code: %d", mqttClient.state());
     return false;
   }
   
-  Serial.println("Connected to MQTT broker!");
+  LOG_D("Connected to MQTT broker!");
   
   // Create JSON document for the weather data
-  StaticJsonDocument<256> dataDoc;
-  
-  // Include temperature data
-  dataDoc["temperature"] = round(temperature * 100) / 100;;
+  StaticJsonDocument<1024> dataDoc;
   
-  // Include sensor-specific data
-  #ifdef USE_DHT22
-    dataDoc["humidity"] = humidity;
-    dataDoc["sensor"] = "DHT22";
-  #endif
-  
-  // When both I2C sensors are used, we get more complete data
-  #if defined(USE_AHT20) && defined(USE_BMP280)
-    dataDoc["humidity"] = round(humidity * 100) / 100; 
-    float pressure = bmp.readPressure() / 100.0F; // Convert Pa to hPa
-    dataDoc["pressure"] = round(pressure * 100) / 100;
-    dataDoc["sensor"] = "AHT20+BMP280";
-  #elif defined(USE_AHT20)
-    dataDoc["humidity"] = humidity;
-    dataDoc["sensor"] = "AHT20";
-  #elif defined(USE_BMP280)
-    dataDoc["pressure"] = bmp.readPressure() / 100.0F; // Convert Pa to hPa
-    dataDoc["sensor"] = "BMP280";
-  #endif
+  // Temperature and the other quantities of the enabled sensors
+  addSensorReadings(dataDoc, snapshot);
+  addRawReadings(dataDoc, snapshot);
   
   // Include rain data and node identification
-  dataDoc["rain"] = rainAmount;
-  dataDoc["rain_1h"] = rainLastHour;
-  dataDoc["rain_24h"] = rainLast24Hours;
+  dataDoc["rain"] = snapshot.rain;
+  dataDoc["rain_1h"] = snapshot.rainLastHour;
+  dataDoc["rain_24h"] = snapshot.rainLast24Hours;
+  addRainTotals(dataDoc, snapshot);
+  addRainIntensity(dataDoc, snapshot);
   dataDoc["node_name"] = config->deviceName;
   
-  // Adiciona apenas timestamp NTP (Unix) se disponível
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    time_t currentTime = getLocalTime();
-    dataDoc["timestamp"] = currentTime;  // Timestamp Unix (segundos desde 1970)
+  // Timestamp Unix pela base de tempo, mesmo sem NTP neste wake, desde que já tenha
+  // havido uma sincronização
+  if (snapshot.wallClock) {
+    dataDoc["timestamp"] = snapshot.timestamp;  // Timestamp Unix (segundos desde 1970)
   }
   
   // add battery voltage
-  dataDoc["voltage"] = getBatteryVoltage();
-  dataDoc["BatteryLevel"] = batteryLevel(getBatteryVoltage());
+  dataDoc["voltage"] = snapshot.batteryVoltage;
+  dataDoc["BatteryLevel"] = snapshot.batteryLevel;
+  
+  // Autonomia projetada e consumo estimado
+  addRuntimeEstimate(dataDoc, snapshot);
+  addEnergyEstimate(dataDoc);
+  
+  // Perfil de tempo do ciclo anterior
+  addWakeProfile(dataDoc);
+  
+  // Conexões WiFi rápidas: [sucessos, falhas]
+  JsonArray wifiFast = dataDoc.createNestedArray("wifi_fast");
+  wifiFast.add(wifiCache.fastSuccesses);
+  wifiFast.add(wifiCache.fastFailures);
+  
+  // Decisão do agendador adaptativo
+  addSleepDecision(dataDoc);
+  
+  // Estouros de prazo por fase e etapas opcionais descartadas
+  addBudgetStats(dataDoc);
   
   // Serialize weather data JSON to string
   String dataString;
@@ -889,78 +1422,48 @@ bool sendDataToMQTT(float temperature, float humidity, float rainAmount) {
     topic += config->deviceName;
   }
   
-  Serial.print("Publishing to topic: ");
-  Serial.println(topic);
-  Serial.print("Data: ");
-  Serial.println(dataString);
+  LOG_I("Publishing to topic: %s", topic.c_str());
+  LOG_D("Data: %s", dataString.c_str());
   
   // Publish data to the MQTT topic
   bool published = mqttClient.publish(topic.c_str(), dataString.c_str(), true);
   
   if (published) {
-    Serial.println("Data published successfully");
+    LOG_D("Data published successfully");
     
-    // Check if interval updates are enabled
-    /* if (config->mqttUpdateInterval > 0) {
-      Serial.print("MQTT update interval is set to ");
-      Serial.print(config->mqttUpdateInterval);
-      Serial.println(" seconds");
-      Serial.println("Waiting for additional update period before sleep...");
-      
-      // Calculate maximum time to spend in update loop
-      unsigned long maxUpdateTime = min((unsigned long)(config->mqttUpdateInterval * 1000), 
-                                       (unsigned long)(MAX_RUNTIME_MS - (millis() - startTime)));
-      
-      unsigned long updateStart = millis();
-      unsigned long lastPublish = millis();
-      
-      while (millis() - updateStart < maxUpdateTime) {
-        // Check if we need to publish again
-        if (millis() - lastPublish >= config->mqttUpdateInterval * 1000) {
-          // Read sensor data again
-          float newTemp = 0.0;
-          float newHumidity = 0.0;
-          
-          if (readSensorData(newTemp, newHumidity)) {
-            // Update temperature, humidity and rainfall data
-            dataDoc["temperature"] = round(newTemp * 100) / 100;
-            dataDoc["humidity"] = round(newHumidity * 100) / 100;
-            dataDoc["rain_1h"] = rainLastHour;
-            dataDoc["rain_24h"] = rainLast24Hours;
-            dataDoc["uptime"] = millis() / 1000;
-            
-            // Serialize and publish
-            serializeJson(dataDoc, dataString);
-            Serial.print("Publishing update: ");
-            Serial.println(dataString);
-            
-            if (mqttClient.publish(topic.c_str(), dataString.c_str(), true)) {
-              Serial.println("Update published successfully");
-            } else {
-              Serial.println("Failed to publish update");
-            }
-          }
-          
-          lastPublish = millis();
-        }
-        
-        // Process MQTT messages
-        mqttClient.loop();
-        delay(100);
-        
-        // Check if runtime is getting too long
-        if (shouldEnterSleep()) {
-          Serial.println("Update loop interrupted due to maximum runtime");
-          break;
-        }
+    // Resumos dos eventos de chuva encerrados, uma única vez cada (sem retain); cada um
+    // sai da fila quando é publicado
+    String eventTopic = topic + "/event";
+    const RainEvent* event;
+    while ((event = rainEventOldest(rainEvents)) != nullptr) {
+      String eventString = rainEventJson(*event);
+      if (!mqttClient.publish(eventTopic.c_str(), eventString.c_str(), false)) {
+        LOG_W("Failed to publish rain event");
+        break;
+      }
+      LOG_D("Rain event published: %s", eventString.c_str());
+      rainEventPop(rainEvents);
+    }
+    
+    // Leituras que ficaram na fila, em lotes do tamanho do buffer (cabeçalho MQTT de até
+    // 7 bytes mais o tópico)
+    String backlogTopic = topic + "/backlog";
+    String batch;
+    uint32_t batchCount;
+    while ((batchCount = nextTelemetryBatch(batch, MQTT_BUFFER_SIZE - 7 - backlogTopic.length())) > 0) {
+      if (!mqttClient.publish(backlogTopic.c_str(), batch.c_str(), false)) {
+        LOG_W("Failed to publish queued readings");
+        break;
       }
-    } */
+      ackTelemetryBatch(batchCount);
+    }
+    finishTelemetryDrain();
     
     // Disconnect MQTT client
     mqttClient.disconnect();
     return true;
   } else {
-    Serial.println("Failed to publish data");
+    LOG_E("Failed to publish data");
     mqttClient.disconnect();
     return false;
   }
@@ -974,198 +1477,390 @@ void addRainRecord(float amount) {
     return;
   }
   
-  // Tenta obter o timestamp UTC do NTP se possível
-  time_t currentTime;
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    // Usar timestamp NTP se disponível
-    currentTime = getLocalTime();
-    Serial.println("Usando timestamp NTP para registro de chuva");
-  } else {
-    // Fallback para millis se NTP não disponível
-    currentTime = millis() / 1000;
-    
-    // Evite overflow do millis() reiniciando o tempo base se necessário
-    if (lastResetTime == 0) {
-      lastResetTime = currentTime;
-    }
-    
-    Serial.println("NTP não disponível, usando timestamp local relativo");
+  // Timestamp da base de tempo: UTC desde a primeira sincronização NTP, mesmo sem WiFi
+  time_t currentTime = getLocalTime();
+  if (!timebaseSynced(timebase)) {
+    LOG_W("Relógio ainda não sincronizado, usando segundos desde o power-on");
   }
   
-  // Se o buffer estiver cheio, remova o registro mais antigo
-  if (rainHistoryCount >= MAX_RAIN_RECORDS) {
-    // Desloca todos os registros uma posição para trás
-    for (int i = 0; i < rainHistoryCount - 1; i++) {
-      rainHistory[i] = rainHistory[i + 1];
-    }
-    rainHistoryCount--;
-  }
+  storeRainTip(currentTime);
   
-  // Adiciona o novo registro
-  rainHistory[rainHistoryCount].timestamp = currentTime;
-  rainHistory[rainHistoryCount].amount = amount;
-  rainHistoryCount++;
+  LOG_I("Registro de chuva adicionado: %.2f mm no timestamp %ld (total acumulado: %.2f mm)",
+        amount, (long)currentTime, totalRainfall);
+}
+
+// Grava uma basculada no histórico de chuva sem nenhum log (usado também pelo caminho rápido)
+void storeRainTip(time_t timestamp) {
+  rainHistoryAddTips(rainHistory, 1, timestamp);
+  rainRateAddTips(rainRate, rainHistory, 1, timestamp);
+  rainRollupAddTips(rainRollup, 1, timestamp);
+  rainLogAddTips(rainLog, 1, timestamp);
+  rainEventAddTips(rainEvents, 1, timestamp, rainFastPath.eventDryMinutes);
   
   // Atualiza o total de chuva
-  totalRainfall += amount;
-  
-  Serial.print("Registro de chuva adicionado: ");
-  Serial.print(amount);
-  Serial.print(" mm no timestamp ");
-  Serial.println(currentTime);
-  
-  // Se temos NTP, vamos mostrar o horário legível
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    struct tm timeinfo;
-    if(gmtime_r(&currentTime, &timeinfo)) {
-      char timeStr[30];
-      strftime(timeStr, sizeof(timeStr), "%d/%m/%Y %H:%M:%S", &timeinfo);
-      Serial.print("Data/hora: ");
-      Serial.println(timeStr);
-    }
-  }
-  Serial.print("Total acumulado: ");
-  Serial.print(totalRainfall);
-  Serial.println(" mm");
+  totalRainfall += rainFastPath.rainMmPerTip;
 }
 
 // Calcula a quantidade de chuva na última hora
 float getRainLastHour() {
-  float rainLastHour = 0.0;
-  
-  // Tenta usar o timestamp NTP se disponível
-  time_t currentTime;
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    currentTime = getLocalTime();
-  } else {
-    currentTime = millis() / 1000;
-  }
-  
-  time_t oneHourAgo = currentTime - (HOUR_MILLIS / 1000);
-  
-  /* Serial.print("Calculando chuva na última hora. Tempo atual: ");
-  Serial.print(currentTime);
-  Serial.print(", uma hora atrás: ");
-  Serial.println(oneHourAgo); */
-  
-  // Se temos NTP, vamos mostrar o horário legível
- /*  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    struct tm nowInfo, hourAgoInfo;
-    if(gmtime_r(&currentTime, &nowInfo) && gmtime_r(&oneHourAgo, &hourAgoInfo)) {
-      char nowStr[30], hourAgoStr[30];
-      strftime(nowStr, sizeof(nowStr), "%d/%m/%Y %H:%M:%S", &nowInfo);
-      strftime(hourAgoStr, sizeof(hourAgoStr), "%d/%m/%Y %H:%M:%S", &hourAgoInfo);
-      Serial.print("Data/hora atual: ");
-      Serial.print(nowStr);
-      Serial.print("  Uma hora atrás: ");
-      Serial.println(hourAgoStr);
-    }
-  } */
-  
-  for (int i = 0; i < rainHistoryCount; i++) {
-    // Se o registro for mais recente que uma hora atrás
-    if (rainHistory[i].timestamp >= oneHourAgo) {
-      rainLastHour += rainHistory[i].amount;
-    }
-  }
-  
-  Serial.print("Chuva na última hora: ");
-  Serial.print(rainLastHour);
-  Serial.println(" mm");
-  
+  uint32_t tips = rainHistoryHourTips(rainHistory, getLocalTime());
+  float rainLastHour = tips * configManager.getConfig()->rainMmPerTip;
+  LOG_D("Chuva na última hora: %.2f mm", rainLastHour);
   return rainLastHour;
 }
 
 // Calcula a quantidade de chuva nas últimas 24 horas
 float getRainLast24Hours() {
-  float rainLast24Hours = 0.0;
+  uint32_t tips = rainHistoryDayTips(rainHistory, getLocalTime());
+  float rainLast24Hours = tips * configManager.getConfig()->rainMmPerTip;
+  LOG_D("Chuva nas últimas 24 horas: %.2f mm", rainLast24Hours);
+  return rainLast24Hours;
+}
+
+// Gerencia o histórico de chuva - zera os intervalos que saíram das 24 h
+void manageRainHistory() {
+  time_t now = getLocalTime();
+  uint16_t expired = rainHistoryAdvance(rainHistory, now);
+  if (expired > 0) {
+    LOG_I("Limpando histórico de chuva: %u intervalos com chuva saíram das 24 h", expired);
+  }
   
-  // Tenta usar o timestamp NTP se disponível
-  time_t currentTime;
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    currentTime = getLocalTime();
-  } else {
-    currentTime = millis() / 1000;
-  }
-  
-  time_t oneDayAgo = currentTime - (DAY_MILLIS / 1000);
-  
-  /* Serial.print("Calculando chuva nas últimas 24 horas. Tempo atual: ");
-  Serial.print(currentTime);
-  Serial.print(", 24 horas atrás: ");
-  Serial.println(oneDayAgo); */
-  
-  // Se temos NTP, vamos mostrar o horário legível
-  /* if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    struct tm nowInfo, dayAgoInfo;
-    if(gmtime_r(&currentTime, &nowInfo) && gmtime_r(&oneDayAgo, &dayAgoInfo)) {
-      char nowStr[30], dayAgoStr[30];
-      strftime(nowStr, sizeof(nowStr), "%d/%m/%Y %H:%M:%S", &nowInfo);
-      strftime(dayAgoStr, sizeof(dayAgoStr), "%d/%m/%Y %H:%M:%S", &dayAgoInfo);
-      Serial.print("Data/hora atual: ");
-      Serial.print(nowStr);
-      Serial.print("  24 horas atrás: ");
-      Serial.println(dayAgoStr);
-    }
-  } */
+  // Encerra o evento de chuva aberto depois da pausa seca configurada
+  if (rainEventAdvance(rainEvents, now, rainFastPath.eventDryMinutes)) {
+    const RainEvent &event = rainEvents.completed[rainEvents.completedCount - 1];
+    LOG_I("Evento de chuva encerrado: %.1f mm em %lu min, pico de %.1f mm/h",
+          rainEventTotal(event, rainFastPath.rainMmPerTip), (unsigned long)rainEventMinutes(event),
+          rainEventPeakRate(event, rainFastPath.rainMmPerTip));
+  }
+}
+
+// Totais de 7 dias, 30 dias e do mês corrente (exige relógio NTP)
+void updateRainRollupTotals(SensorSnapshot &snapshot) {
+  if (!snapshot.wallClock) {
+    return;
+  }
   
-  for (int i = 0; i < rainHistoryCount; i++) {
-    // Se o registro for mais recente que 24 horas atrás
-    if (rainHistory[i].timestamp >= oneDayAgo) {
-      rainLast24Hours += rainHistory[i].amount;
+  time_t now = snapshot.timestamp;
+  float mmPerTip = configManager.getConfig()->rainMmPerTip;
+  snapshot.rainLast7Days = rainRollupTipsSince(rainRollup, now, now - 7 * 86400L) * mmPerTip;
+  snapshot.rainLast30Days = rainRollupTipsSince(rainRollup, now, now - 30 * 86400L) * mmPerTip;
+  snapshot.rainMonthToDate = rainRollupTipsSince(rainRollup, now, rainRollupMonthStart(now)) * mmPerTip;
+  LOG_D("Chuva em 7 dias: %.2f mm, 30 dias: %.2f mm, no mês: %.2f mm",
+        snapshot.rainLast7Days, snapshot.rainLast30Days, snapshot.rainMonthToDate);
+}
+
+// Intensidade instantânea e picos de 5, 15 e 60 min
+void updateRainIntensity(SensorSnapshot &snapshot) {
+  time_t now = snapshot.timestamp;
+  float mmPerTip = configManager.getConfig()->rainMmPerTip;
+  snapshot.rainRate = rainRateInstant(rainRate, now, mmPerTip);
+  rainRatePeaks(rainRate, now, mmPerTip, snapshot.rainPeakRates);
+  LOG_D("Intensidade: %.1f mm/h, picos de 5/15/60 min: %.1f/%.1f/%.1f mm/h", snapshot.rainRate,
+        snapshot.rainPeakRates[0], snapshot.rainPeakRates[1], snapshot.rainPeakRates[2]);
+}
+
+// Recupera do flash a última cópia dos totais longos
+void restoreRainRollup() {
+  RainRollupCheckpoint checkpoint;
+  if (configManager.readBlob(RAIN_CHECKPOINT_FILE, &checkpoint, sizeof(checkpoint))) {
+    if (!rainRollupRestore(rainRollup, checkpoint)) {
+      LOG_W("Cópia dos totais de chuva inválida, ignorada");
+      return;
     }
+    rainCheckpointHour = rainRollup.hourBin;
+    rainCheckpointTips = rainRollup.totalTips;
+    LOG_I("Totais de chuva recuperados do flash (%lu basculadas)", (unsigned long)rainRollup.totalTips);
+    return;
   }
   
-  Serial.print("Chuva nas últimas 24 horas: ");
-  Serial.print(rainLast24Hours);
-  Serial.println(" mm");
+  // Arquivo da versão anterior (camadas de 32 bits): converte e regrava no formato atual
+  RainRollupCheckpointV1 legacy;
+  if (configManager.readBlob(RAIN_CHECKPOINT_FILE, &legacy, sizeof(legacy)) &&
+      rainRollupRestoreV1(rainRollup, legacy)) {
+    LOG_I("Totais de chuva migrados do formato anterior (%lu basculadas)", (unsigned long)rainRollup.totalTips);
+    checkpointRainRollup(true);
+  }
+}
+
+// Grava os totais longos no flash se houve chuva e a última cópia tem mais de
+// RAIN_CHECKPOINT_HOURS (ou sempre, com force); sem chuva nova a cópia anterior continua exata
+void checkpointRainRollup(bool force) {
+  if (rainRollup.totalTips == rainCheckpointTips) {
+    return;
+  }
+  if (!force && rainRollup.hourBin - rainCheckpointHour < RAIN_CHECKPOINT_HOURS) {
+    return;
+  }
   
-  return rainLast24Hours;
+  // A cópia nunca fica à frente do log: a reconstrução só soma os registros posteriores a ela
+  commitRainLog(true);
+  
+  RainRollupCheckpoint checkpoint;
+  rainRollupCheckpoint(rainRollup, checkpoint);
+  if (configManager.writeBlob(RAIN_CHECKPOINT_FILE, &checkpoint, sizeof(checkpoint))) {
+    rainCheckpointHour = rainRollup.hourBin;
+    rainCheckpointTips = rainRollup.totalTips;
+    LOG_I("Totais de chuva gravados no flash");
+  }
 }
 
-// Gerencia o histórico de registros de chuva - limpa registros muito antigos
-void manageRainHistory() {
-  // Tenta usar o timestamp NTP se disponível
-  time_t currentTime;
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    currentTime = getLocalTime();
-  } else {
-    currentTime = millis() / 1000;
+// Partição do log de chuva; nullptr até openRainLog() ou com a tabela de partições antiga
+const esp_partition_t* rainLogPartition = nullptr;
+
+bool rainLogRead(uint32_t offset, void* data, uint32_t length) {
+  return esp_partition_read(rainLogPartition, offset, data, length) == ESP_OK;
+}
+
+bool rainLogWrite(uint32_t offset, const void* data, uint32_t length) {
+  return esp_partition_write(rainLogPartition, offset, data, length) == ESP_OK;
+}
+
+bool rainLogErase(uint32_t offset, uint32_t length) {
+  return esp_partition_erase_range(rainLogPartition, offset, length) == ESP_OK;
+}
+
+// Localiza a partição RAIN_LOG_PARTITION; retorna false se ela não existir
+bool openRainLog(RainLogFlash &flash) {
+  if (rainLogPartition == nullptr) {
+    rainLogPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                                                RAIN_LOG_PARTITION);
+    if (rainLogPartition == nullptr) {
+      return false;
+    }
+  }
+  flash.size = rainLogPartition->size - rainLogPartition->size % RAIN_LOG_SECTOR_SIZE;
+  flash.read = rainLogRead;
+  flash.write = rainLogWrite;
+  flash.erase = rainLogErase;
+  return true;
+}
+
+// Reaplica um registro do log ao histórico de 24 h e aos totais longos
+void replayRainRecord(const RainLogRecord &record) {
+  time_t timestamp = (time_t)record.bin * RAIN_BIN_SECONDS;
+  rainHistoryAddTips(rainHistory, record.tips, timestamp);
+  rainRateAddTips(rainRate, rainHistory, record.tips, timestamp);
+  rainEventAddTips(rainEvents, record.tips, timestamp, configManager.getConfig()->rainEventDryMinutes);
+  
+  // A cópia dos totais longos já contém os registros anteriores a ela
+  if (record.totalTips <= rainRollup.totalTips) {
+    return;
+  }
+  if (rainRollupEmpty(rainRollup)) {
+    rainRollupStart(rainRollup, timestamp, record.totalTips - record.tips);
+  }
+  while (rainRollup.totalTips < record.totalTips) {
+    uint32_t missing = record.totalTips - rainRollup.totalTips;
+    rainRollupAddTips(rainRollup, (uint16_t)(missing < UINT16_MAX ? missing : UINT16_MAX), timestamp);
+  }
+}
+
+// Reconstrói o contador, o total e o histórico de chuva a partir do log no flash
+// (boot a frio); as basculadas ainda não gravadas no log se perdem
+void rebuildRainFromLog() {
+  RainLogFlash flash;
+  if (!openRainLog(flash)) {
+    LOG_W("Partição %s não encontrada, a chuva não sobrevive à perda de energia", RAIN_LOG_PARTITION);
+    return;
   }
   
-  time_t oneDayAgo = currentTime - (DAY_MILLIS / 1000);
-  int recordsToKeep = 0;
+  rainHistoryReset(rainHistory);
+  rainRateReset(rainRate);
+  rainEventReset(rainEvents);
+  uint32_t records = rainLogReplay(flash, replayRainRecord);
   
-  Serial.println("Gerenciando histórico de chuva...");
+  // Não se sabe quais eventos encerrados já foram publicados: só o aberto continua,
+  // para que nenhum resumo seja enviado duas vezes
+  rainEvents.completedCount = 0;
+  if (!rainLogBegin(rainLog, flash, rainRollup.totalTips)) {
+    LOG_E("Falha ao ler o log de chuva");
+    return;
+  }
   
-  // Se temos NTP, vamos mostrar o horário legível
-  if (WiFi.status() == WL_CONNECTED && lastNTPSync > 0) {
-    struct tm timeinfo;
-    if(gmtime_r(&currentTime, &timeinfo)) {
-      char timeStr[30];
-      strftime(timeStr, sizeof(timeStr), "%d/%m/%Y %H:%M:%S", &timeinfo);
-      Serial.print("Data/hora atual: ");
-      Serial.println(timeStr);
-    }
+  rainCounter = rainLog.totalTips;
+  totalRainfall = rainLog.totalTips * configManager.getConfig()->rainMmPerTip;
+  LOG_I("Chuva reconstruída do flash: %lu registros, %lu basculadas",
+        (unsigned long)records, (unsigned long)rainLog.totalTips);
+}
+
+// Grava no log as basculadas pendentes quando rainLogCommitDue() pedir (ou sempre, com force)
+void commitRainLog(bool force) {
+  if (rainLog.pendingCount == 0 || (!force && !rainLogCommitDue(rainLog, getLocalTime()))) {
+    return;
   }
   
-  // Conta quantos registros são mais recentes que 24 horas
-  for (int i = 0; i < rainHistoryCount; i++) {
-    if (rainHistory[i].timestamp >= oneDayAgo) {
-      // Se encontramos um registro no intervalo, move ele para o início do array
-      if (i > recordsToKeep) {
-        rainHistory[recordsToKeep] = rainHistory[i];
-      }
-      recordsToKeep++;
+  RainLogFlash flash;
+  if (!openRainLog(flash)) {
+    return;
+  }
+  int written = rainLogCommit(rainLog, flash);
+  if (written < 0) {
+    LOG_W("Falha ao gravar o log de chuva (%u intervalos pendentes)", rainLog.pendingCount);
+  } else {
+    LOG_D("Log de chuva: %d intervalos gravados", written);
+  }
+}
+
+// Carrega do flash as leituras não enviadas (no máximo uma vez por wake)
+void loadTelemetrySpill() {
+  if (telemetrySpillLoaded) {
+    return;
+  }
+  telemetrySpillLoaded = true;
+  if (!configManager.readBlob(TELEMETRY_SPILL_FILE, &telemetrySpill, sizeof(telemetrySpill)) ||
+      !telemetrySpillValid(telemetrySpill)) {
+    telemetrySpillReset(telemetrySpill);
+  }
+  telemetryQueue.spilled = telemetrySpill.count;
+  if (telemetrySpill.count > 0) {
+    LOG_I("Fila de leituras: %u leituras não enviadas no flash", telemetrySpill.count);
+  }
+}
+
+// Grava no flash as leituras não enviadas, se mudaram neste wake
+void saveTelemetrySpill() {
+  if (!telemetrySpillDirty) {
+    return;
+  }
+  telemetrySpillSeal(telemetrySpill);
+  if (configManager.writeBlob(TELEMETRY_SPILL_FILE, &telemetrySpill, sizeof(telemetrySpill))) {
+    telemetrySpillDirty = false;
+  }
+}
+
+// Passa as leituras da memória RTC para o flash (memória cheia ou antes de um restart)
+void spillTelemetryQueue() {
+  if (telemetryQueue.count == 0) {
+    return;
+  }
+  loadTelemetrySpill();
+  rebaseTelemetryQueue();
+  uint16_t dropped = telemetryQueueSpill(telemetryQueue, telemetrySpill);
+  telemetrySpillDirty = true;
+  saveTelemetrySpill();
+  if (dropped > 0) {
+    LOG_W("Fila de leituras cheia: %u leituras mais antigas descartadas", dropped);
+  }
+}
+
+// Passa para hora de parede, pela primeira sincronização NTP, as leituras guardadas antes
+// dela; o anel do flash precisa estar carregado se houver leituras nele
+void rebaseTelemetryQueue() {
+  if (!timebaseSynced(timebase)) {
+    return;
+  }
+  if (telemetryQueueRebase(telemetryQueue, telemetrySpill, timebase.unsyncedOffsetUs / 1000000LL) > 0) {
+    telemetrySpillDirty = true;
+  }
+}
+
+// Relógio recomeçado (power-on): as leituras do flash sem hora de parede eram de outra
+// contagem do relógio e não têm mais como ser acertadas
+void dropUnsyncedTelemetry() {
+  uint32_t dropped = telemetrySpillDropUnsynced(telemetryQueue, telemetrySpill);
+  if (dropped > 0) {
+    telemetrySpillDirty = true;
+    saveTelemetrySpill();
+    LOG_W("Fila de leituras: %lu leituras sem hora de parede descartadas", (unsigned long)dropped);
+  }
+}
+
+// Guarda a leitura deste ciclo para ser enviada com a próxima conexão. Antes da primeira
+// sincronização NTP o timestamp é a base sem âncora, acertado na sincronização
+void queueTelemetry(const SensorSnapshot &snapshot) {
+  if (telemetryQueueFull(telemetryQueue)) {
+    spillTelemetryQueue();
+  }
+  
+  TelemetryFrame frame = {};
+  frame.timestamp = (uint32_t)snapshot.timestamp;
+  frame.flags = snapshot.wallClock ? 0 : TELEMETRY_FRAME_UNSYNCED;
+  frame.temperature = TELEMETRY_NO_TEMPERATURE;
+  frame.humidity = TELEMETRY_NO_HUMIDITY;
+  frame.pressure = TELEMETRY_NO_PRESSURE;
+  if (!isnan(snapshot.temperature)) {
+    frame.temperature = (int16_t)round(snapshot.temperature * 100);
+  }
+  if (!isnan(snapshot.humidity)) {
+    frame.humidity = (uint16_t)round(snapshot.humidity * 100);
+  }
+  if (!isnan(snapshot.pressureHpa)) {
+    frame.pressure = (uint16_t)round(snapshot.pressureHpa * 10); // Décimos de hPa
+  }
+  frame.voltage = (uint16_t)round(snapshot.batteryVoltage * 1000);
+  frame.rain = (uint32_t)round(snapshot.rain * 100);
+  frame.rain1h = (uint16_t)round(snapshot.rainLastHour * 10);
+  frame.rain24h = (uint16_t)round(snapshot.rainLast24Hours * 10);
+  telemetryQueuePush(telemetryQueue, frame);
+  LOG_I("Leitura guardada para reenvio (%lu na fila)", (unsigned long)telemetryQueuePending(telemetryQueue));
+}
+
+// Monta em json um lote com as leituras mais antigas da fila, até maxBytes:
+// {"node_name": ..., "backlog": [[timestamp, temperatura, umidade, pressão, tensão,
+// chuva, chuva 1h, chuva 24h], ...]}, com null na temperatura, umidade ou pressão que
+// faltou na leitura. As leituras sem hora de parede esperam a primeira sincronização NTP.
+// Retorna quantas leituras entraram (0 quando a fila está vazia, o limite de lotes por
+// wake foi atingido ou falta tempo).
+uint32_t nextTelemetryBatch(String &json, size_t maxBytes) {
+  if (telemetryQueuePending(telemetryQueue) == 0 || telemetryBatchesSent >= TELEMETRY_DRAIN_MAX_BATCHES ||
+      !runtimeBudget.allowOptional(BUDGET_MIN_SEND_MS)) {
+    return 0;
+  }
+  if (telemetryQueue.spilled > 0) {
+    loadTelemetrySpill();
+  }
+  rebaseTelemetryQueue();
+  
+  StaticJsonDocument<1536> doc;
+  doc["node_name"] = configManager.getConfig()->deviceName;
+  JsonArray backlog = doc.createNestedArray("backlog");
+  uint32_t count = 0;
+  const TelemetryFrame* frame;
+  while ((frame = telemetryQueueAt(telemetryQueue, telemetrySpill, count)) != nullptr &&
+         !(frame->flags & TELEMETRY_FRAME_UNSYNCED)) {
+    JsonArray row = backlog.createNestedArray();
+    row.add(frame->timestamp);
+    addBacklogValue(row, frame->temperature != TELEMETRY_NO_TEMPERATURE, frame->temperature / 100.0);
+    addBacklogValue(row, frame->humidity != TELEMETRY_NO_HUMIDITY, frame->humidity / 100.0);
+    addBacklogValue(row, frame->pressure != TELEMETRY_NO_PRESSURE, frame->pressure / 10.0);
+    row.add(frame->voltage / 1000.0);
+    row.add(frame->rain / 100.0);
+    row.add(frame->rain1h / 10.0);
+    row.add(frame->rain24h / 10.0);
+    if (doc.overflowed() || measureJson(doc) > maxBytes) {
+      backlog.remove(count);
+      break;
     }
+    count++;
   }
   
-  // Atualiza o contador para refletir apenas os registros mantidos
-  if (rainHistoryCount != recordsToKeep) {
-    Serial.print("Limpando histórico de chuva: ");
-    Serial.print(rainHistoryCount - recordsToKeep);
-    Serial.println(" registros antigos removidos");
-    rainHistoryCount = recordsToKeep;
+  json = "";
+  serializeJson(doc, json);
+  return count;
+}
+
+// Valor de um quadro da fila no lote, ou null se a leitura não o tinha
+void addBacklogValue(JsonArray row, bool present, double value) {
+  if (present) {
+    row.add(value);
+  } else {
+    row.add((const char*)nullptr);
+  }
+}
+
+// Remove da fila as leituras de um lote enviado
+void ackTelemetryBatch(uint32_t count) {
+  telemetrySpillDirty |= telemetryQueue.spilled > 0;
+  telemetryQueueDrop(telemetryQueue, telemetrySpill, count);
+  telemetryBatchesSent++;
+}
+
+// Grava uma única vez no flash o que saiu da fila nesta conexão
+void finishTelemetryDrain() {
+  saveTelemetrySpill();
+  if (telemetryBatchesSent > 0) {
+    LOG_I("Fila de leituras: %u lotes enviados, %lu leituras restantes", telemetryBatchesSent,
+          (unsigned long)telemetryQueuePending(telemetryQueue));
   }
 }
 
@@ -1184,54 +1879,191 @@ int batteryLevel(float voltage) {
   return 10;  // Considerado nível crítico
 }
 
-// Sincroniza o relógio com servidores NTP
-void syncTimeWithNTP() {
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("WiFi não conectado, impossível sincronizar com NTP");
-    return;
+// Verifica se este wake precisa sincronizar com o NTP (sem âncora ou âncora antiga)
+bool ntpSyncDue() {
+  int64_t clockUs = rtcTimeUs();
+  if (timebaseSynced(timebase) && clockUs > timebase.anchorClockUs &&
+      clockUs - timebase.anchorClockUs < NTP_SYNC_INTERVAL * 1000LL) {
+    LOG_D("Sincronização NTP recente, pulando...");
+    return false;
   }
-  
-  // Verificar se precisamos sincronizar
-  time_t now = time(nullptr);
-  if (lastNTPSync > 0 && now > lastNTPSync && (now - lastNTPSync < NTP_SYNC_INTERVAL / 1000)) {
-    Serial.println("Sincronização NTP recente, pulando...");
+  return true;
+}
+
+// Inicia a sincronização NTP sem bloquear; ntpSyncPending já foi marcado por setupWiFi()
+void startNTPSync() {
+  LOG_D("Configurando servidores NTP...");
+  ntpStartClockUs = rtcTimeUs();
+  ntpStartTimerUs = esp_timer_get_time();
+  sntp_set_time_sync_notification_cb(onNTPSync);
+  configTime(NTP_TIMEZONE * 3600, 0, NTP_SERVER1, NTP_SERVER2);
+}
+
+// Chamado pelo SNTP quando o relógio é efetivamente ajustado pelo servidor
+void onNTPSync(struct timeval *tv) {
+  // O relógio logo antes do ajuste mede o desvio desde a sincronização anterior
+  int64_t epochUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+  int64_t clockBeforeUs = ntpStartClockUs + (esp_timer_get_time() - ntpStartTimerUs);
+  timebaseSync(timebase, clockBeforeUs, rtcTimeUs(), epochUs);
+  ntpSyncPending = false;
+}
+
+// Aguarda a conclusão da sincronização pendente (o GOT_IP e o ajuste pelo SNTP), até timeoutMs
+void waitForNTPSync(uint32_t timeoutMs) {
+  if (!ntpSyncPending) {
     return;
   }
   
-  Serial.println("Configurando servidores NTP...");
-  configTime(NTP_TIMEZONE * 3600, 0, NTP_SERVER1, NTP_SERVER2);
-  
   // Aguardar sincronização
-  Serial.println("Aguardando sincronização NTP...");
-  time_t startWait = millis();
-  time_t timeout = 10000; // 10 segundos de timeout
-  
-  while (time(nullptr) < 1609459200) { // 1 de janeiro de 2021 como referência
-    delay(100);
-    if (millis() - startWait > timeout) {
-      Serial.println("Timeout na sincronização NTP");
+  LOG_D("Aguardando sincronização NTP...");
+  unsigned long startWait = millis();
+  
+  while (ntpSyncPending) {
+    pollSensorRead();
+    delay(10);
+    if (millis() - startWait > timeoutMs) {
+      LOG_W("Timeout na sincronização NTP");
       return;
     }
   }
   
-  now = time(nullptr);
-  lastNTPSync = now;
+  #if LOG_LEVEL >= LOG_LEVEL_INFO
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo)) {
+      char buffer[80];
+      strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", &timeinfo);
+      LOG_I("Horário sincronizado: %s (desvio do relógio RTC: %ld ppb)", buffer, (long)timebase.driftPpb);
+    } else {
+      LOG_W("Falha ao obter horário local");
+    }
+  #endif
+}
+
+// Adiciona ao payload a duração (ms) de cada fase do ciclo anterior, na ordem de WakePhase
+void addWakeProfile(JsonDocument &doc) {
+  const WakeProfile* profile = wakeProfiler.previous();
+  if (profile == nullptr) {
+    return;
+  }
   
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    char buffer[80];
-    strftime(buffer, sizeof(buffer), "%d/%m/%Y %H:%M:%S", &timeinfo);
-    Serial.print("Horário sincronizado: ");
-    Serial.println(buffer);
-  } else {
-    Serial.println("Falha ao obter horário local");
+  JsonArray prof = doc.createNestedArray("prof");
+  for (uint8_t p = 0; p < PHASE_COUNT; p++) {
+    prof.add(profile->phaseUs[p] / 1000);
   }
 }
 
-// Retorna o tempo local atual em timestamp Unix
-time_t getLocalTime() {
-  if (WiFi.status() == WL_CONNECTED && (lastNTPSync == 0 || time(nullptr) - lastNTPSync >= NTP_SYNC_INTERVAL / 1000)) {
-    syncTimeWithNTP();
+// Resumo compacto de um evento de chuva encerrado: início (timestamp), duração (min),
+// total (mm) e pico de intensidade em 5 min (mm/h)
+String rainEventJson(const RainEvent &event) {
+  WeatherStationConfig* config = configManager.getConfig();
+  StaticJsonDocument<192> doc;
+  doc["node_name"] = config->deviceName;
+  JsonObject summary = doc.createNestedObject("rain_event");
+  summary["start"] = event.start;
+  summary["dur"] = rainEventMinutes(event);
+  summary["rain"] = round(rainEventTotal(event, config->rainMmPerTip) * 10) / 10;
+  summary["peak"] = round(rainEventPeakRate(event, config->rainMmPerTip) * 10) / 10;
+  
+  String json;
+  serializeJson(doc, json);
+  return json;
+}
+
+// Adiciona ao payload os totais longos de chuva (mm): rain_7d, rain_30d e rain_mtd
+void addRainTotals(JsonDocument &doc, const SensorSnapshot &snapshot) {
+  doc["rain_7d"] = round(snapshot.rainLast7Days * 10) / 10;
+  doc["rain_30d"] = round(snapshot.rainLast30Days * 10) / 10;
+  doc["rain_mtd"] = round(snapshot.rainMonthToDate * 10) / 10;
+}
+
+// Adiciona ao payload a intensidade instantânea e os picos (mm/h): rain_rate,
+// rain_peak_5, rain_peak_15 e rain_peak_60
+void addRainIntensity(JsonDocument &doc, const SensorSnapshot &snapshot) {
+  static const char* const peakKeys[RAIN_RATE_WINDOWS] = {"rain_peak_5", "rain_peak_15", "rain_peak_60"};
+  doc["rain_rate"] = round(snapshot.rainRate * 10) / 10;
+  for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+    doc[peakKeys[w]] = round(snapshot.rainPeakRates[w] * 10) / 10;
+  }
+}
+
+// Adiciona ao payload a temperatura, as grandezas que os sensores do build fornecem
+// (humidity, pressure), já filtradas, e os nomes dos sensores. Uma grandeza sem leitura
+// nem estimativa recente fica fora do payload
+void addSensorReadings(JsonDocument &doc, const SensorSnapshot &snapshot) {
+  if (!isnan(snapshot.temperature)) {
+    doc["temperature"] = round(snapshot.temperature * 100) / 100;
+  }
+  if ((EnabledSensors::quantities & SENSOR_HUMIDITY) && !isnan(snapshot.humidity)) {
+    doc["humidity"] = round(snapshot.humidity * 100) / 100;
+  }
+  if ((EnabledSensors::quantities & SENSOR_PRESSURE) && !isnan(snapshot.pressureHpa)) {
+    doc["pressure"] = round(snapshot.pressureHpa * 100) / 100;
+  }
+  doc["sensor"] = snapshot.sensor;
+}
+
+// Adiciona ao payload as leituras brutas deste wake em "raw": {"t", "h", "p"}; uma
+// grandeza filtrada sem "raw" é a estimativa anterior
+void addRawReadings(JsonDocument &doc, const SensorSnapshot &snapshot) {
+  if (snapshot.quantities == 0) {
+    return;
+  }
+  
+  JsonObject raw = doc.createNestedObject("raw");
+  if (snapshot.quantities & SENSOR_TEMPERATURE) {
+    raw["t"] = round(snapshot.rawTemperature * 100) / 100;
   }
-  return time(nullptr);
+  if (snapshot.quantities & SENSOR_HUMIDITY) {
+    raw["h"] = round(snapshot.rawHumidity * 100) / 100;
+  }
+  if (snapshot.quantities & SENSOR_PRESSURE) {
+    raw["p"] = round(snapshot.rawPressureHpa * 100) / 100;
+  }
+}
+
+// Adiciona ao payload o intervalo de sono escolhido e o motivo
+void addSleepDecision(JsonDocument &doc) {
+  if (!sleepDecisionReady) {
+    return;
+  }
+  
+  JsonObject sleep = doc.createNestedObject("sleep");
+  sleep["next"] = sleepDecision.minutes;
+  sleep["why"] = sleepReasonName(sleepDecision.reason);
+  if (!isnan(sleepDecision.pressureTrend)) {
+    sleep["dp"] = round(sleepDecision.pressureTrend * 100) / 100;
+  }
+}
+
+// Adiciona ao payload os estouros de prazo por fase (ordem de BudgetPhase) e os descartes
+void addBudgetStats(JsonDocument &doc) {
+  const RuntimeBudgetStats& stats = runtimeBudget.stats();
+  
+  JsonObject budget = doc.createNestedObject("budget");
+  JsonArray overruns = budget.createNestedArray("over");
+  for (uint8_t p = 0; p < BUDGET_PHASE_COUNT; p++) {
+    overruns.add(stats.overruns[p]);
+  }
+  budget["skip"] = stats.skipped;
+}
+
+// Adiciona ao payload a autonomia projetada (h) até o ciclo anterior
+void addRuntimeEstimate(JsonDocument &doc, const SensorSnapshot &snapshot) {
+  if (snapshot.runtimeHours >= 0.0f) {
+    doc["runtime_h"] = (uint32_t)snapshot.runtimeHours;
+  }
+}
+
+// Adiciona ao payload o consumo estimado até o ciclo anterior
+void addEnergyEstimate(JsonDocument &doc) {
+  JsonObject energy = doc.createNestedObject("energy");
+  energy["mAh"] = round(energyAccount.consumedMah * 100) / 100;
+  energy["cycle_uAh"] = (uint32_t)(energyAccount.lastCycleMah * 1000.0f);
+  energy["avg_mA"] = round(energyAccount.averageMa * 1000) / 1000;
+}
+
+// Hora atual (timestamp Unix) pela base de tempo, em qualquer wake e sem rádio. Antes da
+// primeira sincronização NTP desde o power-on são segundos desde o power-on.
+time_t getLocalTime() {
+  return timebaseNow(timebase, rtcTimeUs());
 }
\ No newline at end of file
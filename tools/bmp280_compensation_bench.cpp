@@ -0,0 +1,151 @@
+// Conferência da compensação do BMP280 (Bmp280Compensation) com o exemplo do datasheet e
+// com a fórmula em ponto flutuante do datasheet (seção 3.11.3).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/bmp280_compensation_bench.cpp src/Bmp280Compensation.cpp -o bmp280_compensation_bench
+//   ./bmp280_compensation_bench [passo do ADC]
+//
+// Os coeficientes são os do exemplo do datasheet (seção 3.12), montados nos 24 bytes
+// little-endian de BMP280_REG_CALIB. Confere que:
+//   - o exemplo (adc_T = 519888, adc_P = 415148) dá 25,08 °C e 100653,27 Pa (±0,05 Pa),
+//     também a partir dos 6 bytes de BMP280_REG_DATA;
+//   - de -40 a 85 °C e de 300 a 1100 hPa, com o passo pedido nos dois ADCs, a compensação
+//     em inteiros fica a até 0,01 °C e 1 Pa da fórmula em ponto flutuante, a temperatura
+//     cresce com o ADC e a pressão diminui;
+//   - uma medida desligada (BMP280_ADC_SKIPPED) é recusada, e ctrl_meas tem os códigos de
+//     oversampling e o modo forçado nos bits do datasheet.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Bmp280Compensation.h"
+
+// dig_T1 ... dig_P9 do exemplo do datasheet
+static const int32_t example[12] = {
+  27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000
+};
+
+#define EXAMPLE_ADC_T 519888
+#define EXAMPLE_ADC_P 415148
+#define EXAMPLE_TEMPERATURE 25.08
+#define EXAMPLE_PRESSURE_PA 100653.27   // Fórmula em ponto flutuante; a de inteiros dá 100653,25
+
+// Fórmula em ponto flutuante do datasheet
+static void compensateDouble(const int32_t* c, int32_t adcT, int32_t adcP,
+                             double& temperature, double& pressurePa) {
+  double var1 = (adcT / 16384.0 - c[0] / 1024.0) * c[1];
+  double var2 = (adcT / 131072.0 - c[0] / 8192.0) * (adcT / 131072.0 - c[0] / 8192.0) * c[2];
+  int32_t tFine = (int32_t)(var1 + var2);
+  temperature = (var1 + var2) / 5120.0;
+
+  var1 = tFine / 2.0 - 64000.0;
+  var2 = var1 * var1 * c[8] / 32768.0;
+  var2 = var2 + var1 * c[7] * 2.0;
+  var2 = var2 / 4.0 + c[6] * 65536.0;
+  var1 = (c[5] * var1 * var1 / 524288.0 + c[4] * var1) / 524288.0;
+  var1 = (1.0 + var1 / 32768.0) * c[3];
+  double p = 1048576.0 - adcP;
+  p = (p - var2 / 4096.0) * 6250.0 / var1;
+  var1 = c[11] * p * p / 2147483648.0;
+  var2 = p * c[10] / 32768.0;
+  pressurePa = p + (var1 + var2 + c[9]) / 16.0;
+}
+
+int main(int argc, char** argv) {
+  int32_t step = argc > 1 ? atoi(argv[1]) : 97;
+  if (step < 1) {
+    step = 1;
+  }
+  long mismatches = 0;
+
+  uint8_t raw[BMP280_CALIB_BYTES];
+  for (int i = 0; i < 12; i++) {
+    raw[2 * i] = (uint8_t)(example[i] & 0xFF);
+    raw[2 * i + 1] = (uint8_t)((example[i] >> 8) & 0xFF);
+  }
+  Bmp280Calibration calibration;
+  bmp280ParseCalibration(raw, calibration);
+  if (calibration.t1 != 27504 || calibration.t3 != -1000 || calibration.p1 != 36477 ||
+      calibration.p6 != -7 || calibration.p9 != 6000) {
+    printf("coeficientes lidos errados\n");
+    mismatches++;
+  }
+
+  // Exemplo do datasheet, pelos ADCs e pela rajada de 6 bytes
+  float temperature = 0, pressurePa = 0;
+  bool ok = bmp280CompensateAdc(calibration, EXAMPLE_ADC_T, EXAMPLE_ADC_P, temperature, pressurePa);
+  printf("exemplo: %.2f °C, %.2f Pa\n", temperature, pressurePa);
+  if (!ok || fabs(temperature - EXAMPLE_TEMPERATURE) > 0.005 ||
+      fabs(pressurePa - EXAMPLE_PRESSURE_PA) > 0.05) {
+    printf("  datasheet: %.2f °C, %.2f Pa\n", EXAMPLE_TEMPERATURE, EXAMPLE_PRESSURE_PA);
+    mismatches++;
+  }
+  const uint8_t burst[BMP280_DATA_BYTES] = {
+    EXAMPLE_ADC_P >> 12, (EXAMPLE_ADC_P >> 4) & 0xFF, (EXAMPLE_ADC_P & 0x0F) << 4,
+    EXAMPLE_ADC_T >> 12, (EXAMPLE_ADC_T >> 4) & 0xFF, (EXAMPLE_ADC_T & 0x0F) << 4
+  };
+  float burstTemperature = 0, burstPressurePa = 0;
+  if (!bmp280Compensate(calibration, burst, burstTemperature, burstPressurePa) ||
+      burstTemperature != temperature || burstPressurePa != pressurePa) {
+    printf("rajada: %.2f °C, %.2f Pa\n", burstTemperature, burstPressurePa);
+    mismatches++;
+  }
+
+  // Faixa de operação contra a fórmula em ponto flutuante
+  long points = 0;
+  double worstT = 0, worstP = 0;
+  float previousT = -1000;
+  for (int32_t adcT = 0; adcT <= 0xFFFFF; adcT += step) {
+    double expectedT, expectedP;
+    compensateDouble(example, adcT, 0x60000, expectedT, expectedP);
+    if (expectedT < -40 || expectedT > 85 || adcT == BMP280_ADC_SKIPPED) {
+      continue;
+    }
+    float t, p;
+    bmp280CompensateAdc(calibration, adcT, 0x60000, t, p);
+    if (t < previousT) {
+      if (mismatches < 5) {
+        printf("adc_T %ld: temperatura caiu (%.2f depois de %.2f)\n", (long)adcT, t, previousT);
+      }
+      mismatches++;
+    }
+    previousT = t;
+
+    float previousP = 1e9f;
+    for (int32_t adcP = 0; adcP <= 0xFFFFF; adcP += step * 16) {
+      compensateDouble(example, adcT, adcP, expectedT, expectedP);
+      if (expectedP < 30000 || expectedP > 110000 || adcP == BMP280_ADC_SKIPPED) {
+        continue;
+      }
+      bmp280CompensateAdc(calibration, adcT, adcP, t, p);
+      double errorT = fabs(t - expectedT);
+      double errorP = fabs(p - expectedP);
+      worstT = errorT > worstT ? errorT : worstT;
+      worstP = errorP > worstP ? errorP : worstP;
+      if (errorT > 0.01 || errorP > 1.0 || p > previousP) {
+        if (mismatches < 5) {
+          printf("adc_T %ld, adc_P %ld: %.2f °C, %.2f Pa; flutuante %.2f °C, %.2f Pa\n",
+                 (long)adcT, (long)adcP, t, p, expectedT, expectedP);
+        }
+        mismatches++;
+      }
+      previousP = p;
+      points++;
+    }
+  }
+  printf("%ld pontos: maior diferença %.4f °C, %.3f Pa\n", points, worstT, worstP);
+
+  if (bmp280CompensateAdc(calibration, BMP280_ADC_SKIPPED, EXAMPLE_ADC_P, temperature, pressurePa) ||
+      bmp280CompensateAdc(calibration, EXAMPLE_ADC_T, BMP280_ADC_SKIPPED, temperature, pressurePa)) {
+    printf("medida desligada aceita\n");
+    mismatches++;
+  }
+  if (bmp280CtrlMeas(1, 3) != 0x2D || bmp280CtrlMeas(2, 5) != 0x55) {
+    printf("ctrl_meas: 0x%02X e 0x%02X, esperado 0x2D e 0x55\n",
+           bmp280CtrlMeas(1, 3), bmp280CtrlMeas(2, 5));
+    mismatches++;
+  }
+
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// Reprodução de wakes gravados (campo "prof" da telemetria) sobre a estimativa de
+// consumo (EnergyModel), com as correntes padrão de config.h.
+//
+//   g++ -O2 -std=gnu++17 -I include tools/energy_model_bench.cpp src/EnergyModel.cpp -o energy_model_bench
+//   ./energy_model_bench [dias]
+//
+// Cada wake do trace tem as durações em ms de "prof" (boot, config, wifi, ntp, sensors,
+// send, sleep), a frequência da CPU e o sono programado. As durações viram uma amostra
+// como em accountEnergy(): CPU ativa na soma das fases; WiFi ligado de setupWiFi() (fim de
+// config) até o desligamento depois do envio, ou até o sono quando não conectou. O
+// consumo esperado de cada wake foi calculado à mão. Confere que:
+//   - o consumo de cada wake é o calculado à mão (±0,001 µAh), inclusive o modo de
+//     configuração com BLE e portal e uma amostra vazia;
+//   - o acumulado, a corrente média (EMA) e a autonomia projetada depois do trace são os
+//     calculados à mão;
+//   - repetindo o trace pelos dias pedidos, o acumulado em double não perde precisão e a
+//     autonomia para em zero quando o consumo passa da capacidade.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "config.h"
+#include "EnergyModel.h"
+
+#define PHASES 7                     // Fases de "prof", na ordem de WakePhase
+#define CYCLE_TOLERANCE_UAH 0.001
+#define TOTAL_TOLERANCE 1e-6         // Relativa
+
+// Como o WiFi terminou o wake
+enum WifiEnd {
+  WIFI_OFF_AFTER_SEND,               // Desligado depois do envio (conectou)
+  WIFI_ON_UNTIL_SLEEP                // Não conectou: ligado até o sono
+};
+
+struct RecordedWake {
+  const char* name;
+  uint32_t prof[PHASES];             // ms
+  uint16_t cpuMHz;
+  uint16_t sleepMinutes;
+  WifiEnd wifiEnd;
+  double cycleUah;                   // Calculado à mão
+};
+
+// CPU: 20 + 0,125 mA/MHz (40 mA a 160 MHz, 30 mA a 80 MHz); WiFi: 95 × 0,85 + 180 × 0,15
+// = 107,75 mA; sono 0,15 mA. Ex.: primeiro wake, 860 ms ativos e 645 ms de WiFi:
+// (40 × 0,860 + 107,75 × 0,645 + 0,15 × 300) mA·s / 3,6 = 41,3608 µAh
+static const RecordedWake trace[] = {
+  {"conexão rápida", {38, 175, 240, 60, 35, 310, 2}, 160, 5, WIFI_OFF_AFTER_SEND, 41.3608},
+  {"varredura completa", {38, 180, 2900, 120, 30, 420, 2}, 160, 5, WIFI_OFF_AFTER_SEND, 157.3590},
+  {"chuva a 80 MHz", {40, 260, 520, 0, 60, 380, 3}, 80, 2, WIFI_OFF_AFTER_SEND, 44.2583},
+  {"AP fora do ar", {39, 178, 10000, 0, 25, 0, 2}, 160, 30, WIFI_ON_UNTIL_SLEEP, 488.9359},
+  {"tempo estável", {37, 172, 230, 0, 33, 290, 2}, 160, 15, WIFI_OFF_AFTER_SEND, 62.5405},
+  {"broker fora do ar", {38, 176, 250, 0, 34, 9800, 2}, 160, 5, WIFI_OFF_AFTER_SEND, 428.7642}
+};
+
+// Depois do trace: acumulado (mAh), corrente média (mA) e autonomia (h) para 2000 mAh
+#define TRACE_CONSUMED_MAH 1.2232187
+#define TRACE_AVERAGE_MA 1.1091042
+#define TRACE_PROJECTED_HOURS 1802.1542
+
+static EnergySample sampleFromProfile(const RecordedWake& wake) {
+  uint32_t totalMs = 0;
+  for (int p = 0; p < PHASES; p++) {
+    totalMs += wake.prof[p];
+  }
+  // wifi, ntp, sensors e send; sleep também quando o WiFi não foi desligado
+  uint32_t wifiMs = wake.prof[2] + wake.prof[3] + wake.prof[4] + wake.prof[5];
+  if (wake.wifiEnd == WIFI_ON_UNTIL_SLEEP) {
+    wifiMs += wake.prof[6];
+  }
+
+  EnergySample sample;
+  sample.activeUs = totalMs * 1000;
+  sample.wifiUs = wifiMs * 1000;
+  sample.bleUs = 0;
+  sample.sleepUs = (uint64_t)wake.sleepMinutes * 60000000ULL;
+  sample.cpuMHz = wake.cpuMHz;
+  return sample;
+}
+
+static bool near(double value, double expected, double tolerance) {
+  return fabs(value - expected) <= tolerance;
+}
+
+int main(int argc, char** argv) {
+  int days = argc > 1 ? atoi(argv[1]) : 365;
+
+  const EnergyModelConfig config = {
+    ENERGY_DEEP_SLEEP_MA, ENERGY_CPU_BASE_MA, ENERGY_CPU_MA_PER_MHZ,
+    ENERGY_WIFI_RX_MA, ENERGY_WIFI_TX_MA, ENERGY_WIFI_TX_DUTY, ENERGY_BLE_MA
+  };
+  const size_t wakes = sizeof(trace) / sizeof(trace[0]);
+  long mismatches = 0;
+
+  // Memória RTC sem acumulado válido, depois uma bateria nova
+  EnergyAccount account;
+  memset(&account, 0, sizeof(account));
+  if (energyAccountValid(account)) {
+    printf("acumulado zerado aceito como válido\n");
+    mismatches++;
+  }
+  energyAccountReset(account);
+  if (!energyAccountValid(account) || energyProjectedHours(account, BATTERY_CAPACITY_MAH) >= 0) {
+    printf("acumulado novo inválido ou com autonomia sem nenhum ciclo\n");
+    mismatches++;
+  }
+
+  for (size_t i = 0; i < wakes; i++) {
+    EnergySample sample = sampleFromProfile(trace[i]);
+    double uah = energyCycleMah(config, sample) * 1000.0;
+    if (!near(uah, trace[i].cycleUah, CYCLE_TOLERANCE_UAH)) {
+      if (mismatches < 5) {
+        printf("%s: %.4f µAh, calculado %.4f\n", trace[i].name, uah, trace[i].cycleUah);
+      }
+      mismatches++;
+    }
+    energyAccountAdd(account, config, sample);
+    printf("  %s: %.0f ms ativos, %.1f µAh\n", trace[i].name, sample.activeUs / 1000.0, uah);
+  }
+
+  float hours = energyProjectedHours(account, BATTERY_CAPACITY_MAH);
+  printf("%zu wakes: %.7f mAh, média %.7f mA, autonomia %.1f h\n",
+         wakes, account.consumedMah, account.averageMa, hours);
+  if (account.cycles != wakes ||
+      !near(account.consumedMah, TRACE_CONSUMED_MAH, TRACE_CONSUMED_MAH * TOTAL_TOLERANCE) ||
+      !near(account.averageMa, TRACE_AVERAGE_MA, TRACE_AVERAGE_MA * TOTAL_TOLERANCE) ||
+      !near(hours, TRACE_PROJECTED_HOURS, 0.05)) {
+    printf("  acumulado diferente do calculado (%.7f mAh, %.7f mA, %.1f h)\n",
+           TRACE_CONSUMED_MAH, TRACE_AVERAGE_MA, TRACE_PROJECTED_HOURS);
+    mismatches++;
+  }
+
+  // Modo de configuração: 180 s com BLE e portal; (40 + 107,75 + 30) × 180 / 3600 mAh
+  EnergySample configMode = {180000000, 180000000, 180000000, 0, 160};
+  if (!near(energyCycleMah(config, configMode), 8.8875, CYCLE_TOLERANCE_UAH / 1000.0)) {
+    printf("modo de configuração: %.7f mAh, calculado 8.8875\n", energyCycleMah(config, configMode));
+    mismatches++;
+  }
+
+  // Amostra vazia: nada consumido e não entra na média
+  EnergyAccount before = account;
+  EnergySample empty = {0, 0, 0, 0, 160};
+  energyAccountAdd(account, config, empty);
+  if (account.cycles != before.cycles || account.consumedMah != before.consumedMah ||
+      account.averageMa != before.averageMa) {
+    printf("amostra vazia mudou o acumulado\n");
+    mismatches++;
+  }
+
+  // Uma bateria por dias seguidos com os mesmos wakes
+  energyAccountReset(account);
+  double traceMah = 0;
+  uint64_t traceUs = 0;
+  for (size_t i = 0; i < wakes; i++) {
+    EnergySample sample = sampleFromProfile(trace[i]);
+    traceMah += trace[i].cycleUah / 1000.0;
+    traceUs += sample.activeUs + sample.sleepUs;
+  }
+  uint64_t endUs = (uint64_t)days * 86400000000ULL;
+  uint64_t elapsedUs = 0;
+  long repetitions = 0;
+  double emptyAtDays = -1;
+  while (elapsedUs + traceUs <= endUs) {
+    for (size_t i = 0; i < wakes; i++) {
+      EnergySample sample = sampleFromProfile(trace[i]);
+      energyAccountAdd(account, config, sample);
+      elapsedUs += sample.activeUs + sample.sleepUs;
+      if (emptyAtDays < 0 && account.consumedMah >= BATTERY_CAPACITY_MAH) {
+        emptyAtDays = elapsedUs / 86400e6;
+      }
+    }
+    repetitions++;
+  }
+
+  double expected = traceMah * repetitions;
+  hours = energyProjectedHours(account, BATTERY_CAPACITY_MAH);
+  printf("%d dias: %lu ciclos, %.3f mAh (calculado %.3f)\n",
+         days, (unsigned long)account.cycles, account.consumedMah, expected);
+  if (emptyAtDays >= 0) {
+    printf("  bateria de %d mAh esgotada no dia %.1f\n", BATTERY_CAPACITY_MAH, emptyAtDays);
+  }
+  if (account.cycles != repetitions * wakes ||
+      !near(account.consumedMah, expected, expected * TOTAL_TOLERANCE)) {
+    printf("  acumulado de %d dias diferente do calculado\n", days);
+    mismatches++;
+  }
+  double remaining = BATTERY_CAPACITY_MAH - account.consumedMah;
+  double expectedHours = remaining > 0 ? remaining / account.averageMa : 0.0;
+  if (!near(hours, expectedHours, 0.05)) {
+    printf("  autonomia %.1f h, calculado %.1f h\n", hours, expectedHours);
+    mismatches++;
+  }
+
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
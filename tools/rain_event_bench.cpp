@@ -0,0 +1,124 @@
+// Reprodução de chuva para conferir a segmentação em eventos (RainEvent).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/rain_event_bench.cpp src/RainEvent.cpp -o rain_event_bench
+//   ./rain_event_bench [mm/dia] [dias] [pausa seca em min]
+//
+// A chuva é a mesma de tools/rain_history_bench.cpp (30% das horas secas, as demais com
+// 6*U*U/1,05 da média, basculadas em processo de Poisson). Cada basculada é registrada
+// com rainEventAddTips() e a cada 5 min um ciclo completo chama rainEventAdvance() e
+// publica os eventos encerrados; em 10% dos ciclos o envio falha e os eventos esperam na
+// fila. Os eventos publicados são comparados com uma segmentação de todas as basculadas
+// feita depois (início, fim, total e pico em 5 min). A saída é diferente de zero se
+// algum evento divergir ou for perdido.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <map>
+#include <vector>
+#include "RainEvent.h"
+
+#define MM_PER_TIP 0.25f
+#define START_EPOCH 1717200000
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+int main(int argc, char** argv) {
+  double mmPerDay = argc > 1 ? atof(argv[1]) : 40.0;
+  int days = argc > 2 ? atoi(argv[2]) : 120;
+  uint16_t dryMinutes = argc > 3 ? (uint16_t)atoi(argv[3]) : 60;
+
+  std::vector<uint32_t> tips;
+  uint32_t end = START_EPOCH + (uint32_t)days * 86400;
+  for (uint32_t hour = START_EPOCH; hour < end; hour += 3600) {
+    double factor = uniform() < 0.3 ? 0.0 : 6.0 * uniform() * uniform() / 1.05;
+    double tipsPerSecond = mmPerDay * factor / MM_PER_TIP / 86400.0;
+    if (tipsPerSecond <= 0) continue;
+    double t = hour;
+    while ((t += -log(uniform()) / tipsPerSecond) < hour + 3600) {
+      tips.push_back((uint32_t)t);
+    }
+  }
+
+  // Segmentação de referência sobre todas as basculadas
+  std::vector<RainEvent> expected;
+  std::map<uint32_t, uint16_t> binTips;
+  for (size_t i = 0; i < tips.size(); i++) {
+    if (i == 0 || tips[i] - tips[i - 1] >= (uint32_t)dryMinutes * 60) {
+      expected.push_back({tips[i], tips[i], 0, 0});
+      binTips.clear();
+    }
+    RainEvent& event = expected.back();
+    event.end = tips[i];
+    event.tips++;
+    uint16_t inBin = ++binTips[tips[i] / RAIN_BIN_SECONDS];
+    if (inBin > event.peakBinTips) event.peakBinTips = inBin;
+  }
+
+  static RainEventTable table;
+  rainEventReset(table);
+  std::vector<RainEvent> published;
+  uint32_t failedCycles = 0;
+  uint8_t maxQueued = 0;
+  size_t next = 0;
+  uint32_t last = end + (uint32_t)dryMinutes * 60 + RAIN_BIN_SECONDS;
+  for (uint32_t now = START_EPOCH + RAIN_BIN_SECONDS; now <= last; now += RAIN_BIN_SECONDS) {
+    for (; next < tips.size() && tips[next] <= now; next++) {
+      rainEventAddTips(table, 1, tips[next], dryMinutes);
+    }
+    rainEventAdvance(table, now, dryMinutes);
+    maxQueued = table.completedCount > maxQueued ? table.completedCount : maxQueued;
+
+    if (uniform() < 0.1) {
+      failedCycles++;
+      continue;
+    }
+    const RainEvent* event;
+    while ((event = rainEventOldest(table)) != nullptr) {
+      published.push_back(*event);
+      rainEventPop(table);
+    }
+  }
+
+  long mismatches = 0;
+  if (published.size() + table.dropped != expected.size() || table.current.tips != 0) {
+    mismatches++;
+    printf("%zu eventos publicados e %u descartados, esperados %zu\n",
+           published.size(), table.dropped, expected.size());
+  }
+  for (size_t i = 0; table.dropped == 0 && i < published.size() && i < expected.size(); i++) {
+    const RainEvent& a = published[i];
+    const RainEvent& b = expected[i];
+    if (a.start != b.start || a.end != b.end || a.tips != b.tips || a.peakBinTips != b.peakBinTips) {
+      if (mismatches++ < 5) {
+        printf("evento %zu divergente: %u-%u %u basculadas pico %u, esperado %u-%u %u pico %u\n",
+               i, a.start, a.end, a.tips, a.peakBinTips, b.start, b.end, b.tips, b.peakBinTips);
+      }
+    }
+  }
+
+  uint32_t longest = 0;
+  float wettest = 0;
+  float peak = 0;
+  for (const RainEvent& event : expected) {
+    longest = rainEventMinutes(event) > longest ? rainEventMinutes(event) : longest;
+    wettest = rainEventTotal(event, MM_PER_TIP) > wettest ? rainEventTotal(event, MM_PER_TIP) : wettest;
+    peak = rainEventPeakRate(event, MM_PER_TIP) > peak ? rainEventPeakRate(event, MM_PER_TIP) : peak;
+  }
+
+  printf("%d dias, %.0f mm/dia em média, %zu basculadas, pausa seca de %u min\n",
+         days, mmPerDay, tips.size(), dryMinutes);
+  printf("  %zu eventos: o mais longo com %u min, o maior com %.1f mm, pico de %.1f mm/h\n",
+         expected.size(), longest, wettest, peak);
+  printf("  %u ciclos sem envio; até %u eventos na fila, %u descartados\n",
+         failedCycles, maxQueued, table.dropped);
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
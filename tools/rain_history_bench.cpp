@@ -0,0 +1,261 @@
+// Reprodução de tempestades e benchmark do histórico de chuva em intervalos (RainHistory),
+// comparado à implementação anterior (um registro por basculada, no máximo 288).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/rain_history_bench.cpp src/RainHistory.cpp src/RainRollup.cpp -o rain_history_bench
+//   ./rain_history_bench [mm/dia] [dias]
+//
+// As basculadas são sorteadas com intensidade variável (rajadas de até ~6x a média) e
+// registradas no instante em que ocorrem, como no caminho rápido. A cada 5 min um
+// ciclo completo consulta a última hora e as últimas 24 h; os totais são conferidos
+// com a contagem exata das basculadas nos mesmos intervalos. As camadas de RainRollup
+// são conferidas da mesma forma em 7 dias, 30 dias e no mês corrente (use 40 dias ou
+// mais para cobrir todas), e a cada dia passam por uma cópia e restauração como a do
+// flash. No mesmo momento o arquivo da versão anterior (camadas de 32 bits) é montado
+// a partir da contagem exata e migrado, e o resultado tem de ser idêntico às camadas
+// de 16 bits; com mais de 65536 basculadas (ex.: 250 mm/dia por 70 dias) isso confere
+// também a volta do contador. A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "RainHistory.h"
+#include "RainRollup.h"
+
+#define MM_PER_TIP 0.25
+#define LEGACY_RECORDS 288
+#define START_EPOCH 1717200000
+
+// Implementação anterior: deslocamento do array e varredura a cada consulta
+struct LegacyRecord {
+  uint32_t timestamp;
+  float amount;
+};
+
+struct LegacyHistory {
+  LegacyRecord records[LEGACY_RECORDS];
+  int count = 0;
+};
+
+static void legacyAdd(LegacyHistory& history, float amount, time_t timestamp) {
+  if (history.count >= LEGACY_RECORDS) {
+    for (int i = 0; i < history.count - 1; i++) {
+      history.records[i] = history.records[i + 1];
+    }
+    history.count--;
+  }
+  history.records[history.count].timestamp = timestamp;
+  history.records[history.count].amount = amount;
+  history.count++;
+}
+
+static float legacySum(const LegacyHistory& history, time_t since) {
+  float sum = 0.0f;
+  for (int i = 0; i < history.count; i++) {
+    if ((time_t)history.records[i].timestamp >= since) {
+      sum += history.records[i].amount;
+    }
+  }
+  return sum;
+}
+
+// Contagem exata nas janelas de intervalos inteiros usadas por RainHistory
+static uint32_t exactTips(const std::vector<time_t>& tips, time_t now, uint32_t bins) {
+  time_t since = ((time_t)(now / RAIN_BIN_SECONDS) - bins + 1) * RAIN_BIN_SECONDS;
+  uint32_t count = 0;
+  for (time_t t : tips) {
+    if (t >= since && t <= now) count++;
+  }
+  return count;
+}
+
+// Contagem exata de since (alinhado ao início do intervalo local de width segundos) até now
+static uint32_t exactTipsSince(const std::vector<time_t>& tips, time_t now, time_t since, time_t width) {
+  time_t local = since + RAIN_ROLLUP_UTC_OFFSET;
+  since = local - local % width - RAIN_ROLLUP_UTC_OFFSET;
+  return std::upper_bound(tips.begin(), tips.end(), now) - std::lower_bound(tips.begin(), tips.end(), since);
+}
+
+static uint32_t countBefore(const std::vector<time_t>& tips, time_t t) {
+  return std::lower_bound(tips.begin(), tips.end(), t) - tips.begin();
+}
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320UL : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+// Arquivo gravado pela versão anterior para o estado de rollup, com cada camada
+// preenchida pela contagem exata antes do início do intervalo
+static void exactCheckpointV1(const std::vector<time_t>& tips, const RainRollup& rollup, time_t now,
+                              RainRollupCheckpointV1& legacy) {
+  memset(&legacy, 0, sizeof(legacy));
+  legacy.magic = 0x524F4C4CUL;
+  legacy.layout = ((uint32_t)RAIN_ROLLUP_HOURS << 16) | (RAIN_ROLLUP_DAYS << 8) | RAIN_ROLLUP_MONTHS;
+  legacy.totalTips = countBefore(tips, now + 1);
+  legacy.hourBin = rollup.hourBin;
+  legacy.dayBin = rollup.dayBin;
+  legacy.monthBin = rollup.monthBin;
+  for (uint32_t i = 0; i < RAIN_ROLLUP_HOURS; i++) {
+    uint32_t bin = rollup.hourBin - i;
+    legacy.hourStart[bin % RAIN_ROLLUP_HOURS] =
+        countBefore(tips, (time_t)bin * 3600 - RAIN_ROLLUP_UTC_OFFSET);
+  }
+  for (uint32_t i = 0; i < RAIN_ROLLUP_DAYS; i++) {
+    uint32_t bin = rollup.dayBin - i;
+    legacy.dayStart[bin % RAIN_ROLLUP_DAYS] =
+        countBefore(tips, (time_t)bin * 86400 - RAIN_ROLLUP_UTC_OFFSET);
+  }
+  time_t monthStart = rainRollupMonthStart(now);
+  for (uint32_t i = 0; i < RAIN_ROLLUP_MONTHS; i++) {
+    legacy.monthStart[(rollup.monthBin - i) % RAIN_ROLLUP_MONTHS] = countBefore(tips, monthStart);
+    monthStart = rainRollupMonthStart(monthStart - 1);
+  }
+  legacy.crc = crc32((const uint8_t*)&legacy, offsetof(RainRollupCheckpointV1, crc));
+}
+
+static bool sameRollup(const RainRollup& a, const RainRollup& b) {
+  return a.totalTips == b.totalTips && a.hourBin == b.hourBin && a.dayBin == b.dayBin &&
+         a.monthBin == b.monthBin &&
+         memcmp(a.hourStart, b.hourStart, sizeof(a.hourStart)) == 0 &&
+         memcmp(a.dayStart, b.dayStart, sizeof(a.dayStart)) == 0 &&
+         memcmp(a.monthStart, b.monthStart, sizeof(a.monthStart)) == 0;
+}
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+int main(int argc, char** argv) {
+  double mmPerDay = argc > 1 ? atof(argv[1]) : 250.0;
+  int days = argc > 2 ? atoi(argv[2]) : 3;
+
+  // Intensidade sorteada a cada hora: 30% das horas secas, as demais com 6*U*U/1,05 da
+  // média (média 1 no total, rajadas de até ~6x)
+  std::vector<time_t> tips;
+  time_t end = START_EPOCH + (time_t)days * 86400;
+  for (time_t hour = START_EPOCH; hour < end; hour += 3600) {
+    double factor = uniform() < 0.3 ? 0.0 : 6.0 * uniform() * uniform() / 1.05;
+    double tipsPerSecond = mmPerDay * factor / MM_PER_TIP / 86400.0;
+    if (tipsPerSecond <= 0) continue;
+    double t = hour;
+    while ((t += -log(uniform()) / tipsPerSecond) < hour + 3600) {
+      tips.push_back((time_t)t);
+    }
+  }
+
+  static RainHistory history;
+  static RainRollup rollup;
+  static LegacyHistory legacy;
+  size_t next = 0;
+  long checks = 0;
+  long mismatches = 0;
+  double worstLegacyMm = 0;
+  double historyNs = 0;
+  double legacyNs = 0;
+  double rollupNs = 0;
+  long restores = 0;
+  long migrations = 0;
+
+  for (time_t now = START_EPOCH + RAIN_BIN_SECONDS; now <= end; now += RAIN_BIN_SECONDS) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = next; i < tips.size() && tips[i] <= now; i++) {
+      rainHistoryAddTips(history, 1, tips[i]);
+      rainRollupAddTips(rollup, 1, tips[i]);
+    }
+    rainHistoryAdvance(history, now);
+    uint32_t hourTips = rainHistoryHourTips(history, now);
+    uint32_t dayTips = rainHistoryDayTips(history, now);
+    auto t1 = std::chrono::steady_clock::now();
+    for (; next < tips.size() && tips[next] <= now; next++) {
+      legacyAdd(legacy, MM_PER_TIP, tips[next]);
+    }
+    float legacyDay = legacySum(legacy, now - 86400);
+    legacySum(legacy, now - 3600);
+    auto t2 = std::chrono::steady_clock::now();
+    uint32_t weekTips = rainRollupTipsSince(rollup, now, now - 7 * 86400);
+    uint32_t monthTips = rainRollupTipsSince(rollup, now, now - 30 * 86400);
+    uint32_t mtdTips = rainRollupTipsSince(rollup, now, rainRollupMonthStart(now));
+    auto t3 = std::chrono::steady_clock::now();
+    historyNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    rollupNs += std::chrono::duration<double, std::nano>(t3 - t2).count();
+    legacyNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+
+    uint32_t expectedHour = exactTips(tips, now, RAIN_HOUR_BINS);
+    uint32_t expectedDay = exactTips(tips, now, RAIN_HISTORY_BINS);
+    checks++;
+    if (hourTips != expectedHour || dayTips != expectedDay) {
+      if (mismatches++ < 5) {
+        printf("divergência em %+.2f h: 1h %u/%u, 24h %u/%u\n", (now - START_EPOCH) / 3600.0,
+               hourTips, expectedHour, dayTips, expectedDay);
+      }
+    }
+    uint32_t expectedWeek = exactTipsSince(tips, now, now - 7 * 86400, 3600);
+    uint32_t expectedMonth = exactTipsSince(tips, now, now - 30 * 86400, 86400);
+    uint32_t expectedMtd = exactTipsSince(tips, now, rainRollupMonthStart(now), 86400);
+    if (weekTips != expectedWeek || monthTips != expectedMonth || mtdTips != expectedMtd) {
+      if (mismatches++ < 5) {
+        printf("divergência em %+.2f h: 7d %u/%u, 30d %u/%u, mês %u/%u\n", (now - START_EPOCH) / 3600.0,
+               weekTips, expectedWeek, monthTips, expectedMonth, mtdTips, expectedMtd);
+      }
+    }
+
+    // Cópia e restauração diárias; uma cópia corrompida tem de ser rejeitada
+    if ((now - START_EPOCH) % 86400 == 0) {
+      RainRollupCheckpoint checkpoint;
+      RainRollup restored;
+      rainRollupCheckpoint(rollup, checkpoint);
+      bool ok = rainRollupRestore(restored, checkpoint) && sameRollup(restored, rollup);
+      checkpoint.rollup.totalTips ^= 1;
+      ok = ok && !rainRollupRestore(restored, checkpoint);
+      restores++;
+      if (!ok && mismatches++ < 5) {
+        printf("cópia do acumulado inválida em %+.2f h\n", (now - START_EPOCH) / 3600.0);
+      }
+
+      static RainRollupCheckpointV1 legacyCheckpoint;
+      exactCheckpointV1(tips, rollup, now, legacyCheckpoint);
+      ok = rainRollupRestoreV1(restored, legacyCheckpoint) && sameRollup(restored, rollup);
+      migrations++;
+      if (!ok && mismatches++ < 5) {
+        printf("migração do formato anterior divergente em %+.2f h\n", (now - START_EPOCH) / 3600.0);
+      }
+    }
+
+    double legacyMissing = expectedDay * MM_PER_TIP - legacyDay;
+    if (legacyMissing > worstLegacyMm) worstLegacyMm = legacyMissing;
+  }
+
+  uint32_t peakDay = 0;
+  for (time_t now = START_EPOCH; now <= end; now += RAIN_BIN_SECONDS) {
+    uint32_t day = exactTips(tips, now, RAIN_HISTORY_BINS);
+    if (day > peakDay) peakDay = day;
+  }
+
+  printf("%d dias, %.0f mm/dia em média, pico de %.1f mm em 24 h (%zu basculadas)\n",
+         days, mmPerDay, peakDay * MM_PER_TIP, tips.size());
+  printf("  intervalos: %ld consultas, %ld divergências, %zu bytes, %.0f ns/ciclo\n",
+         checks, mismatches, sizeof(RainHistory), historyNs / checks);
+  printf("  anterior:   até %.1f mm faltando em rain_24h, %zu bytes, %.0f ns/ciclo\n",
+         worstLegacyMm, sizeof(LegacyHistory), legacyNs / checks);
+  printf("  camadas:    7d/30d/mês em %ld consultas, %ld cópias restauradas, %ld migradas, %zu bytes "
+         "(%zu no formato anterior), %.0f ns/ciclo\n",
+         checks, restores, migrations, sizeof(RainRollup),
+         sizeof(RainRollupCheckpointV1) - 3 * sizeof(uint32_t), rollupNs / checks);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+// Reprodução de chuva com quedas de energia sobre o log de chuva em flash (RainLog),
+// com um flash NOR em memória (escrita só leva bits de 1 para 0, apagamento por setor).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/rain_log_bench.cpp src/RainLog.cpp -o rain_log_bench
+//   ./rain_log_bench [mm/dia] [dias] [quedas]
+//
+// A cada 5 min um ciclo completo registra as basculadas e grava o log quando
+// rainLogCommitDue() pede. Em instantes sorteados a energia cai: metade das vezes no
+// meio de uma gravação (a página fica gravada só até um byte sorteado), as demais
+// durante o sono. Depois de cada queda o estado RTC é perdido e o log é reconstruído
+// do flash, como no boot a frio do firmware. Confere que:
+//   - nenhum registro gravado por inteiro se perde e nenhum é contado duas vezes;
+//   - as basculadas perdidas são só as que ainda não tinham sido gravadas;
+//   - os apagamentos se distribuem igualmente pelos setores.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "RainLog.h"
+
+#define MM_PER_TIP 0.25
+#define FLASH_SIZE (16 * RAIN_LOG_SECTOR_SIZE)
+#define START_EPOCH 1717200000
+
+static uint8_t flash[FLASH_SIZE];
+static uint32_t eraseCount[FLASH_SIZE / RAIN_LOG_SECTOR_SIZE];
+static uint32_t writeCalls = 0;
+static uint32_t tornAtByte = 0;      // > 0: a próxima escrita é interrompida neste byte
+static bool powerLost = false;
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+static bool flashRead(uint32_t offset, void* data, uint32_t length) {
+  if (offset + length > FLASH_SIZE) return false;
+  memcpy(data, flash + offset, length);
+  return true;
+}
+
+static bool flashWrite(uint32_t offset, const void* data, uint32_t length) {
+  if (offset + length > FLASH_SIZE || powerLost) return false;
+  writeCalls++;
+  uint32_t programmed = length;
+  if (tornAtByte > 0) {
+    programmed = tornAtByte < length ? tornAtByte : length;
+    tornAtByte = 0;
+    powerLost = true;
+  }
+  for (uint32_t i = 0; i < programmed; i++) {
+    flash[offset + i] &= ((const uint8_t*)data)[i];
+  }
+  return !powerLost;
+}
+
+static bool flashErase(uint32_t offset, uint32_t length) {
+  if (offset % RAIN_LOG_SECTOR_SIZE != 0 || offset + length > FLASH_SIZE || powerLost) return false;
+  memset(flash + offset, 0xFF, length);
+  eraseCount[offset / RAIN_LOG_SECTOR_SIZE]++;
+  return true;
+}
+
+static const RainLogFlash logFlash = {FLASH_SIZE, flashRead, flashWrite, flashErase};
+
+// Conferência da reconstrução
+static uint32_t replayedLast;
+static uint32_t replayedRecords;
+static long chainBreaks;
+
+static void onRecord(const RainLogRecord& record) {
+  // Cada registro continua o contador do anterior
+  if (replayedRecords > 0 && record.totalTips != replayedLast + record.tips) {
+    chainBreaks++;
+  }
+  replayedLast = record.totalTips;
+  replayedRecords++;
+}
+
+int main(int argc, char** argv) {
+  double mmPerDay = argc > 1 ? atof(argv[1]) : 40.0;
+  int days = argc > 2 ? atoi(argv[2]) : 120;
+  int cuts = argc > 3 ? atoi(argv[3]) : 40;
+
+  // Mesma chuva de tools/rain_history_bench.cpp: 30% das horas secas, as demais com
+  // 6*U*U/1,05 da média
+  std::vector<time_t> tips;
+  time_t end = START_EPOCH + (time_t)days * 86400;
+  for (time_t hour = START_EPOCH; hour < end; hour += 3600) {
+    double factor = uniform() < 0.3 ? 0.0 : 6.0 * uniform() * uniform() / 1.05;
+    double tipsPerSecond = mmPerDay * factor / MM_PER_TIP / 86400.0;
+    if (tipsPerSecond <= 0) continue;
+    double t = hour;
+    while ((t += -log(uniform()) / tipsPerSecond) < hour + 3600) {
+      tips.push_back((time_t)t);
+    }
+  }
+
+  std::vector<time_t> cutTimes;
+  for (int i = 0; i < cuts; i++) {
+    cutTimes.push_back(START_EPOCH + (time_t)(uniform() * (end - START_EPOCH)));
+  }
+  std::sort(cutTimes.begin(), cutTimes.end());
+
+  memset(flash, 0xFF, sizeof(flash));
+  static RainLog log;
+  rainLogBegin(log, logFlash, 0);
+
+  size_t next = 0;
+  size_t nextCut = 0;
+  uint32_t counted = 0;         // Basculadas registradas em RainLog (inclui as perdidas depois)
+  uint32_t lost = 0;            // Pendentes descartadas pelas quedas
+  uint32_t commits = 0;
+  long mismatches = 0;
+
+  for (time_t now = START_EPOCH + RAIN_BIN_SECONDS; now <= end; now += RAIN_BIN_SECONDS) {
+    for (; next < tips.size() && tips[next] <= now; next++) {
+      rainLogAddTips(log, 1, tips[next]);
+      counted++;
+    }
+
+    bool cut = nextCut < cutTimes.size() && cutTimes[nextCut] <= now;
+    if (cut) {
+      nextCut++;
+      // Metade das quedas acontece durante uma gravação
+      if (uniform() < 0.5 && log.pendingCount > 0) {
+        tornAtByte = 1 + (uint32_t)(uniform() * RAIN_LOG_PAGE_SIZE);
+      } else {
+        powerLost = true;
+      }
+    }
+
+    if (tornAtByte > 0 || (!powerLost && rainLogCommitDue(log, now))) {
+      if (rainLogCommit(log, logFlash) >= 0) {
+        commits++;
+      }
+    }
+
+    if (powerLost) {
+      // Boot a frio: o estado RTC se perde e o log é reconstruído do flash
+      uint32_t durable = log.committedTips;
+      uint32_t pending = log.totalTips - log.committedTips;
+      powerLost = false;
+      tornAtByte = 0;
+      memset(&log, 0, sizeof(log));
+      replayedLast = 0;
+      replayedRecords = 0;
+      rainLogReplay(logFlash, onRecord);
+      rainLogBegin(log, logFlash, 0);
+
+      // Uma página interrompida pode ter deixado registros inteiros além dos confirmados
+      uint32_t recovered = log.committedTips - durable;
+      if (log.committedTips < durable || recovered > pending || replayedLast != log.committedTips) {
+        if (mismatches++ < 5) {
+          printf("reconstrução divergente: %u gravadas, %u no log (+%u de %u pendentes)\n",
+                 durable, log.committedTips, recovered, pending);
+        }
+      }
+      lost += pending - recovered;
+    }
+  }
+
+  // Confere o log final inteiro
+  rainLogCommit(log, logFlash);
+  replayedLast = 0;
+  replayedRecords = 0;
+  uint32_t records = rainLogReplay(logFlash, onRecord);
+  if (replayedLast != counted - lost || log.committedTips != counted - lost) {
+    mismatches++;
+    printf("total divergente: %u basculadas, %u perdidas nas quedas, %u no log\n",
+           counted, lost, replayedLast);
+  }
+  if (chainBreaks > 0) {
+    mismatches++;
+    printf("%ld registros não continuam o contador do anterior\n", chainBreaks);
+  }
+
+  uint32_t minErase = UINT32_MAX;
+  uint32_t maxErase = 0;
+  for (uint32_t count : eraseCount) {
+    minErase = count < minErase ? count : minErase;
+    maxErase = count > maxErase ? count : maxErase;
+  }
+  if (maxErase - minErase > 1) {
+    mismatches++;
+    printf("apagamentos desiguais entre setores: %u a %u\n", minErase, maxErase);
+  }
+
+  printf("%d dias, %.0f mm/dia em média, %u basculadas, %d quedas de energia\n",
+         days, mmPerDay, counted, cuts);
+  printf("  log: %u gravações (%.3f por basculada), %u escritas no flash, %u registros legíveis\n",
+         commits, counted ? (double)commits / counted : 0.0, writeCalls, records);
+  printf("  setores: %u a %u apagamentos cada; quedas descartaram %u basculadas pendentes (%.1f mm)\n",
+         minErase, maxErase, lost, lost * MM_PER_TIP);
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// Reprodução de chuva com intensidade conhecida para conferir a intensidade da chuva
+// (RainRate): picos de 5, 15 e 60 min e intensidade instantânea.
+//
+//   g++ -O2 -std=gnu++17 -I include tools/rain_rate_bench.cpp src/RainHistory.cpp src/RainRate.cpp -o rain_rate_bench
+//   ./rain_rate_bench [mm/dia] [dias] [ulp]
+//
+// A intensidade real é constante em cada hora (30% das horas secas, as demais com
+// 6*U*U/1,05 da média, como em tools/rain_history_bench.cpp) e as basculadas são um
+// processo de Poisson com essa intensidade, registradas no instante em que ocorrem ou,
+// com "ulp", no minuto (como o contador ULP). A cada 5 min um ciclo completo consulta a
+// intensidade e os picos. Os picos são conferidos com uma varredura de todas as janelas
+// que terminam em um intervalo com chuva nas últimas 24 h; a intensidade instantânea é
+// comparada com a real e com a chuva da última hora (que atrasa nas mudanças de intensidade). A saída é diferente de zero se algum
+// pico divergir.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+#include "RainHistory.h"
+#include "RainRate.h"
+
+#define MM_PER_TIP 0.25f
+#define START_EPOCH 1717200000
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+static double median(std::vector<double> values) {
+  if (values.empty()) return 0;
+  std::sort(values.begin(), values.end());
+  return values[values.size() / 2];
+}
+
+int main(int argc, char** argv) {
+  double mmPerDay = argc > 1 ? atof(argv[1]) : 40.0;
+  int days = argc > 2 ? atoi(argv[2]) : 30;
+  bool ulp = argc > 3 && strcmp(argv[3], "ulp") == 0;
+
+  std::vector<double> hourlyMmPerHour;
+  std::vector<time_t> tips;
+  time_t end = START_EPOCH + (time_t)days * 86400;
+  for (time_t hour = START_EPOCH; hour < end; hour += 3600) {
+    double factor = uniform() < 0.3 ? 0.0 : 6.0 * uniform() * uniform() / 1.05;
+    double mmPerHour = mmPerDay / 24.0 * factor;
+    hourlyMmPerHour.push_back(mmPerHour);
+    double tipsPerSecond = mmPerHour / MM_PER_TIP / 3600.0;
+    if (tipsPerSecond <= 0) continue;
+    double t = hour;
+    while ((t += -log(uniform()) / tipsPerSecond) < hour + 3600) {
+      time_t timestamp = (time_t)t;
+      tips.push_back(ulp ? timestamp - timestamp % 60 : timestamp);
+    }
+  }
+
+  static RainHistory history;
+  static RainRate rate;
+  rainHistoryReset(history);
+  rainRateReset(rate);
+
+  std::map<uint32_t, uint32_t> binTips;     // Contagem exata por intervalo
+  const uint16_t windowBins[RAIN_RATE_WINDOWS] = {1, 15 / RAIN_BIN_MINUTES, RAIN_HOUR_BINS};
+  std::vector<double> rateError;
+  std::vector<double> hourError;
+  long mismatches = 0;
+  long staleRates = 0;
+  double tipNs = 0;
+  double queryNs = 0;
+  uint32_t cycles = 0;
+  size_t next = 0;
+
+  for (time_t now = START_EPOCH + RAIN_BIN_SECONDS; now <= end; now += RAIN_BIN_SECONDS) {
+    auto tipStart = std::chrono::steady_clock::now();
+    size_t first = next;
+    for (; next < tips.size() && tips[next] <= now; next++) {
+      rainHistoryAddTips(history, 1, tips[next]);
+      rainRateAddTips(rate, history, 1, tips[next]);
+    }
+    tipNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tipStart).count();
+    for (size_t i = first; i < next; i++) {
+      binTips[(uint32_t)tips[i] / RAIN_BIN_SECONDS]++;
+    }
+
+    auto queryStart = std::chrono::steady_clock::now();
+    rainHistoryAdvance(history, now);
+    float instant = rainRateInstant(rate, now, MM_PER_TIP);
+    float peaks[RAIN_RATE_WINDOWS];
+    rainRatePeaks(rate, now, MM_PER_TIP, peaks);
+    queryNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - queryStart).count();
+    cycles++;
+
+    // Varredura: janelas que terminam em intervalos com chuva nas horas do anel
+    uint32_t nowBin = (uint32_t)now / RAIN_BIN_SECONDS;
+    uint32_t firstBin = (nowBin / RAIN_HOUR_BINS - (RAIN_RATE_PEAK_HOURS - 1)) * RAIN_HOUR_BINS;
+    uint32_t expected[RAIN_RATE_WINDOWS] = {};
+    for (auto it = binTips.lower_bound(firstBin); it != binTips.end() && it->first <= nowBin; ++it) {
+      for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+        uint32_t sum = 0;
+        for (uint32_t b = it->first + 1 - windowBins[w]; b <= it->first; b++) {
+          auto found = binTips.find(b);
+          if (found != binTips.end()) sum += found->second;
+        }
+        expected[w] = std::max(expected[w], sum);
+      }
+    }
+    for (uint8_t w = 0; w < RAIN_RATE_WINDOWS; w++) {
+      float mmPerHour = expected[w] * MM_PER_TIP * 60.0f / rainRateWindowMinutes(w);
+      if (fabsf(peaks[w] - mmPerHour) > 1e-3f) {
+        if (mismatches++ < 5) {
+          printf("pico de %u min divergente em %ld: %.2f mm/h, esperado %.2f\n",
+                 rainRateWindowMinutes(w), (long)(now - START_EPOCH), peaks[w], mmPerHour);
+        }
+      }
+    }
+
+    // Intensidade real na hora corrente (a do instante anterior a now)
+    size_t hourIndex = (size_t)((now - 1 - START_EPOCH) / 3600);
+    double real = hourlyMmPerHour[hourIndex];
+    // Só onde a resolução permite medir: pelo menos duas basculadas por hora
+    if (real >= 2 * MM_PER_TIP) {
+      rateError.push_back(fabs(instant - real) / real);
+      hourError.push_back(fabs(rainHistoryHourTips(history, now) * MM_PER_TIP - real) / real);
+    }
+    // Sem basculadas por RAIN_RATE_TIMEOUT_MINUTES a intensidade tem de ser zero
+    if (instant > 0 && (next == 0 || now - tips[next - 1] >= RAIN_RATE_TIMEOUT_MINUTES * 60)) {
+      staleRates++;
+    }
+  }
+  if (staleRates > 0) {
+    mismatches++;
+    printf("%ld consultas com intensidade depois de %d min sem chuva\n", staleRates, RAIN_RATE_TIMEOUT_MINUTES);
+  }
+
+  printf("%d dias, %.0f mm/dia em média, %zu basculadas%s, %u ciclos\n",
+         days, mmPerDay, tips.size(), ulp ? " (resolução de 1 min)" : "", cycles);
+  printf("  intensidade: erro mediano %.0f%% (chuva da última hora: %.0f%%) com mais de %.1f mm/h\n",
+         100.0 * median(rateError), 100.0 * median(hourError), 2 * MM_PER_TIP);
+  printf("  %.0f ns por basculada, %.0f ns por consulta, %zu bytes de memória RTC\n",
+         next ? tipNs / next : 0.0, queryNs / cycles, sizeof(RainRate));
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
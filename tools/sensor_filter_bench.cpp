@@ -0,0 +1,180 @@
+// Reprodução de dias de leituras de temperatura, umidade e pressão com ruído e picos,
+// sobre o filtro entre wakes (SensorFilter).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/sensor_filter_bench.cpp src/SensorFilter.cpp -o sensor_filter_bench
+//   ./sensor_filter_bench [minutos entre wakes] [dias]
+//
+// Os valores reais seguem o ciclo do dia (temperatura ±6 °C, umidade ±20 %), com uma
+// frente que derruba 8 hPa e 5 °C em uma hora no meio da reprodução. As leituras têm o
+// ruído dos sensores (DHT22/AHT20: ±0,3 °C e ±2 %; BMP280: ±3 Pa) e 1% delas vem com um pico
+// de 10 °C, 30 % ou 20 hPa. Compara o erro das leituras brutas com o dos valores filtrados
+// e confere que:
+//   - o filtro reduz o erro médio de cada canal;
+//   - nenhum pico chega ao valor filtrado;
+//   - a frente é acompanhada: o erro volta ao nível do ruído em até quatro wakes;
+//   - num wake em que o sensor falha, o valor mantido é a última estimativa até
+//     SENSOR_FILTER_HOLD_SECONDS depois da leitura, e NAN depois disso ou sem estimativa.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "SensorFilter.h"
+
+#define START_EPOCH 1717200000L
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+static double gaussian(double sigma) {
+  return sigma * sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+struct Channel {
+  const char* name;
+  const char* unit;
+  SensorFilterParams params;
+  double noise;             // Desvio das leituras
+  double spike;             // Tamanho de um pico
+  SensorFilterChannel filter;
+  double sumRaw, sumFiltered, maxFiltered;
+  long samples, spikes, leaked;
+};
+
+// Canal sem estimativa e com as estatísticas zeradas
+static Channel makeChannel(const char* name, const char* unit, const SensorFilterParams& params,
+                           double noise, double spike) {
+  Channel channel = {};
+  channel.name = name;
+  channel.unit = unit;
+  channel.params = params;
+  channel.noise = noise;
+  channel.spike = spike;
+  sensorFilterReset(channel.filter);
+  return channel;
+}
+
+// Valor real do canal em t segundos
+static double truth(int channel, double t, double frontStart) {
+  double day = 2.0 * M_PI * fmod(t, 86400.0) / 86400.0;
+  double front = t < frontStart ? 0.0 : fmin((t - frontStart) / 3600.0, 1.0);
+  switch (channel) {
+    case 0: return 22.0 - 6.0 * cos(day) - 5.0 * front;
+    case 1: return 65.0 + 20.0 * cos(day) + 10.0 * front;
+    default: return 1015.0 + 0.8 * sin(day * 2.0) - 8.0 * front;
+  }
+}
+
+int main(int argc, char** argv) {
+  int minutes = argc > 1 ? atoi(argv[1]) : 5;
+  int days = argc > 2 ? atoi(argv[2]) : 7;
+
+  Channel channels[3] = {
+    makeChannel("temperatura", "°C", {100, SENSOR_FILTER_TEMPERATURE_NOISE, SENSOR_FILTER_TEMPERATURE_DRIFT}, 0.3, 10.0),
+    makeChannel("umidade", "%", {100, SENSOR_FILTER_HUMIDITY_NOISE, SENSOR_FILTER_HUMIDITY_DRIFT}, 2.0, 30.0),
+    makeChannel("pressão", "hPa", {1000, SENSOR_FILTER_PRESSURE_NOISE, SENSOR_FILTER_PRESSURE_DRIFT}, 0.03, 20.0)
+  };
+
+  double end = days * 86400.0;
+  double frontStart = end / 2;
+  long mismatches = 0;
+  long wakes = 0;
+  long frontWakes = -1;
+  time_t lastNow = START_EPOCH;
+  double lastFiltered[3] = {};
+
+  for (double t = 0; t < end; t += minutes * 60.0) {
+    wakes++;
+    // Intervalo entre wakes com a variação do agendador
+    t += (uniform() - 0.5) * 20.0;
+    time_t now = START_EPOCH + (time_t)t;
+    lastNow = now;
+    bool afterFront = t >= frontStart + 3600.0;
+    bool settled = true;
+
+    for (int c = 0; c < 3; c++) {
+      Channel& channel = channels[c];
+      double real = truth(c, t, frontStart);
+      double raw = real + gaussian(channel.noise / 3.0);
+      bool spike = uniform() < 0.01;
+      if (spike) {
+        raw += uniform() < 0.5 ? channel.spike : -channel.spike;
+        channel.spikes++;
+      }
+
+      double filtered = sensorFilterUpdate(channel.filter, channel.params, (float)raw, now);
+      double error = fabs(filtered - real);
+      lastFiltered[c] = filtered;
+      if (spike && error > channel.spike / 2) {
+        if (channel.leaked++ < 3) {
+          printf("pico de %s chegou ao valor filtrado no wake %ld (%.2f %s)\n",
+                 channel.name, wakes, filtered - real, channel.unit);
+        }
+        mismatches++;
+      }
+      if (error > 2 * channel.noise) {
+        settled = false;
+      }
+
+      // Primeira hora sem estimativa firme fica fora da média
+      if (t >= 3600.0) {
+        channel.sumRaw += fabs(raw - real);
+        channel.sumFiltered += error;
+        if (error > channel.maxFiltered) channel.maxFiltered = error;
+        channel.samples++;
+      }
+    }
+
+    if (afterFront && frontWakes < 0) {
+      frontWakes = 0;
+    }
+    if (frontWakes >= 0 && frontWakes < 1000) {
+      frontWakes = settled ? 1000 + frontWakes : frontWakes + 1;
+    }
+  }
+
+  printf("%d dias, wakes a cada %d min: %ld wakes\n", days, minutes, wakes);
+  for (Channel& channel : channels) {
+    double raw = channel.sumRaw / channel.samples;
+    double filtered = channel.sumFiltered / channel.samples;
+    printf("  %-12s erro médio %.3f %s bruto, %.3f filtrado (máximo %.3f); %ld picos, %ld passaram\n",
+           channel.name, raw, channel.unit, filtered, channel.maxFiltered, channel.spikes, channel.leaked);
+    if (filtered >= raw) {
+      printf("  filtro não reduz o erro de %s\n", channel.name);
+      mismatches++;
+    }
+  }
+
+  // Sensor que falha depois do último wake
+  for (int c = 0; c < 3; c++) {
+    Channel& channel = channels[c];
+    float held = sensorFilterHeld(channel.filter, channel.params, lastNow + SENSOR_FILTER_HOLD_SECONDS);
+    float expired = sensorFilterHeld(channel.filter, channel.params, lastNow + SENSOR_FILTER_HOLD_SECONDS + 1);
+    if (held != (float)lastFiltered[c] || !isnan(expired)) {
+      printf("  estimativa mantida de %s: %.3f (última %.3f), %.3f depois do prazo\n",
+             channel.name, held, lastFiltered[c], expired);
+      mismatches++;
+    }
+  }
+  SensorFilterChannel empty;
+  sensorFilterReset(empty);
+  if (!isnan(sensorFilterHeld(empty, channels[0].params, lastNow))) {
+    printf("  canal sem estimativa mantém um valor\n");
+    mismatches++;
+  }
+
+  long settleWakes = frontWakes >= 1000 ? frontWakes - 1000 : -1;
+  printf("  frente acompanhada %ld wakes depois do fim da queda\n", settleWakes);
+  if (settleWakes < 0 || settleWakes > 4) {
+    printf("  filtro não acompanha a frente\n");
+    mismatches++;
+  }
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+// Reprodução de um trace gravado de chuva, pressão e bateria sobre o agendador de sono
+// (SleepScheduler), com os valores padrão de config.h.
+//
+//   g++ -O2 -std=gnu++17 -I include tools/sleep_scheduler_bench.cpp src/SleepScheduler.cpp -o sleep_scheduler_bench
+//   ./sleep_scheduler_bench [trace.csv]
+//
+// O trace embutido é um dia de tempestade, wake a wake: tempo estável, queda de pressão,
+// uma hora de chuva (com uma leitura sem pressão no meio), bateria baixa e bateria crítica
+// com chuva. Um arquivo CSV pode ser reproduzido no lugar dele, uma linha por wake com
+// "segundos,rain_1h,pressão,bateria,dp,next,why" (pressão e dp "nan" quando ausentes; next,
+// why e dp como no campo "sleep" da telemetria). Confere que:
+//   - cada wake escolhe o intervalo e o motivo gravados;
+//   - a tendência de pressão usada na decisão é a gravada (±0,01 hPa/h);
+//   - cada wake do trace vem depois do intervalo escolhido no anterior;
+//   - o wake alinhado ao relógio cai no ponto da grade calculado à mão, inclusive com o
+//     sono mínimo e na virada do dia;
+//   - os nomes dos motivos são os da telemetria.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "config.h"
+#include "SleepScheduler.h"
+
+#define START_EPOCH 1717200000L      // 2024-06-01 00:00:00 UTC
+#define AT(h, m, s) (START_EPOCH + (h) * 3600L + (m) * 60L + (s))
+#define TREND_TOLERANCE 0.01
+
+// Um wake do trace: entradas e a decisão gravada
+struct TraceRow {
+  long seconds;                      // Desde o primeiro wake
+  float rainLastHourMm;
+  float pressureHpa;
+  float batteryVoltage;
+  double pressureTrend;              // hPa/h (NAN: desconhecida)
+  uint16_t minutes;
+  SleepReason reason;
+};
+
+static const TraceRow stormDay[] = {
+  // Tempo estável: o intervalo cresce 1,5x até o máximo; +0,35 hPa/h (acima do limiar
+  // de estável, abaixo do rápido) volta ao base até a média cair
+  {    0, 0.00f, 1013.20f, 4.05f,    NAN,  7, SLEEP_REASON_STABLE},
+  {  421, 0.00f, 1013.20f, 4.05f,    NAN, 10, SLEEP_REASON_STABLE},
+  { 1023, 0.00f, 1013.30f, 4.05f,  +0.35,  5, SLEEP_REASON_BASE},
+  { 1326, 0.00f, 1013.30f, 4.05f,  +0.35,  5, SLEEP_REASON_BASE},
+  { 1628, 0.00f, 1013.30f, 4.05f,  +0.18,  7, SLEEP_REASON_STABLE},
+  { 2049, 0.00f, 1013.30f, 4.05f,  +0.18, 10, SLEEP_REASON_STABLE},
+  { 2651, 0.00f, 1013.30f, 4.05f,  +0.09, 15, SLEEP_REASON_STABLE},
+  { 3554, 0.00f, 1013.30f, 4.05f,  +0.04, 22, SLEEP_REASON_STABLE},
+  { 4876, 0.00f, 1013.30f, 4.05f,  +0.02, 30, SLEEP_REASON_STABLE},
+  // Frente chegando: pressão caindo mais de 1 hPa/h
+  { 6677, 0.00f, 1012.17f, 4.05f,  -1.12,  3, SLEEP_REASON_PRESSURE},
+  { 6859, 0.00f, 1011.87f, 4.05f,  -1.12,  3, SLEEP_REASON_PRESSURE},
+  // Chuva na última hora tem prioridade sobre a pressão; uma leitura sem pressão descarta
+  // a tendência, que só volta 10 min depois da última pressão usada
+  { 7042, 0.14f, 1011.56f, 4.05f,  -1.12,  2, SLEEP_REASON_RAIN},
+  { 7164, 0.55f, 1011.36f, 4.05f,  -1.12,  2, SLEEP_REASON_RAIN},
+  { 7285, 0.95f, 1011.16f, 4.05f,  -3.55,  2, SLEEP_REASON_RAIN},
+  { 7407, 1.36f,      NAN, 4.05f,    NAN,  2, SLEEP_REASON_RAIN},
+  { 7530, 1.77f, 1010.75f, 4.05f,    NAN,  2, SLEEP_REASON_RAIN},
+  { 7652, 2.17f, 1010.55f, 4.05f,    NAN,  2, SLEEP_REASON_RAIN},
+  { 7773, 2.58f, 1010.34f, 4.05f,    NAN,  2, SLEEP_REASON_RAIN},
+  { 7895, 2.67f, 1010.34f, 4.05f,  -4.84,  2, SLEEP_REASON_RAIN},
+  { 8018, 2.67f, 1010.39f, 4.05f,  -4.84,  2, SLEEP_REASON_RAIN},
+  { 8140, 2.67f, 1010.44f, 4.05f,  -4.84,  2, SLEEP_REASON_RAIN},
+  { 8261, 2.67f, 1010.49f, 4.05f,  -4.84,  2, SLEEP_REASON_RAIN},
+  { 8383, 2.67f, 1010.54f, 4.05f,  -4.84,  2, SLEEP_REASON_RAIN},
+  { 8506, 2.67f, 1010.59f, 4.05f,  -1.68,  2, SLEEP_REASON_RAIN},
+  { 8628, 2.67f, 1010.64f, 4.05f,  -1.68,  2, SLEEP_REASON_RAIN},
+  { 8749, 2.67f, 1010.70f, 4.05f,  -1.68,  2, SLEEP_REASON_RAIN},
+  { 8871, 2.67f, 1010.75f, 4.05f,  -1.68,  2, SLEEP_REASON_RAIN},
+  { 8994, 2.67f, 1010.80f, 4.05f,  -1.68,  2, SLEEP_REASON_RAIN},
+  { 9116, 2.67f, 1010.85f, 4.05f,  -0.07,  2, SLEEP_REASON_RAIN},
+  { 9237, 2.67f, 1010.90f, 4.05f,  -0.07,  2, SLEEP_REASON_RAIN},
+  { 9359, 2.67f, 1010.95f, 4.05f,  -0.07,  2, SLEEP_REASON_RAIN},
+  { 9482, 2.67f, 1011.00f, 4.05f,  -0.07,  2, SLEEP_REASON_RAIN},
+  { 9604, 2.67f, 1011.05f, 4.05f,  -0.07,  2, SLEEP_REASON_RAIN},
+  { 9725, 2.67f, 1011.10f, 4.05f,  +0.70,  2, SLEEP_REASON_RAIN},
+  { 9847, 2.67f, 1011.15f, 4.05f,  +0.70,  2, SLEEP_REASON_RAIN},
+  { 9970, 2.67f, 1011.20f, 4.05f,  +0.70,  2, SLEEP_REASON_RAIN},
+  {10092, 2.67f, 1011.25f, 4.05f,  +0.70,  2, SLEEP_REASON_RAIN},
+  {10213, 2.67f, 1011.30f, 4.05f,  +0.70,  2, SLEEP_REASON_RAIN},
+  {10335, 2.67f, 1011.30f, 4.05f,  +0.94,  2, SLEEP_REASON_RAIN},
+  {10458, 2.67f, 1011.30f, 4.05f,  +0.94,  2, SLEEP_REASON_RAIN},
+  {10580, 2.67f, 1011.30f, 4.05f,  +0.94,  2, SLEEP_REASON_RAIN},
+  {10701, 2.33f, 1011.30f, 4.05f,  +0.94,  2, SLEEP_REASON_RAIN},
+  {10823, 1.92f, 1011.30f, 4.05f,  +0.94,  2, SLEEP_REASON_RAIN},
+  {10946, 1.51f, 1011.30f, 4.05f,  +0.47,  2, SLEEP_REASON_RAIN},
+  {11068, 1.11f, 1011.30f, 4.05f,  +0.47,  2, SLEEP_REASON_RAIN},
+  {11189, 0.70f, 1011.30f, 4.05f,  +0.47,  2, SLEEP_REASON_RAIN},
+  {11311, 0.30f, 1011.30f, 4.05f,  +0.47,  2, SLEEP_REASON_RAIN},
+  // Chuva sai da janela de uma hora; pressão subindo devagar e depois estável
+  {11434, 0.00f, 1011.30f, 4.05f,  +0.47,  5, SLEEP_REASON_BASE},
+  {11736, 0.00f, 1011.30f, 4.05f,  +0.24,  7, SLEEP_REASON_STABLE},
+  {12157, 0.00f, 1011.30f, 4.05f,  +0.24, 10, SLEEP_REASON_STABLE},
+  {12759, 0.00f, 1011.30f, 4.05f,  +0.12, 15, SLEEP_REASON_STABLE},
+  {13662, 0.00f, 1011.30f, 4.05f,  +0.06, 22, SLEEP_REASON_STABLE},
+  // Bateria baixa: o dobro do base, mesmo com tempo estável
+  {14984, 0.00f, 1011.30f, 3.45f,  +0.03, 10, SLEEP_REASON_BATTERY_LOW},
+  {15585, 0.00f, 1011.30f, 3.45f,  +0.01, 10, SLEEP_REASON_BATTERY_LOW},
+  {16187, 0.00f, 1011.30f, 3.45f,  +0.01, 10, SLEEP_REASON_BATTERY_LOW},
+  {16790, 0.00f, 1011.30f, 3.45f,  +0.00, 10, SLEEP_REASON_BATTERY_LOW},
+  {17392, 0.00f, 1011.30f, 3.45f,  +0.00, 10, SLEEP_REASON_BATTERY_LOW},
+  {17993, 0.00f, 1011.30f, 3.45f,  +0.00, 10, SLEEP_REASON_BATTERY_LOW},
+  // Bateria crítica: sempre o máximo, mesmo com chuva
+  {18595, 0.00f, 1011.30f, 3.25f,  +0.00, 30, SLEEP_REASON_BATTERY_CRITICAL},
+  {20398, 0.50f, 1011.30f, 3.25f,  +0.00, 30, SLEEP_REASON_BATTERY_CRITICAL},
+};
+
+struct AlignCase {
+  time_t now;
+  uint16_t minutes;
+  uint16_t minLeadSeconds;
+  time_t wake;
+};
+
+// Grade = mdc(intervalo, 60 min); empate vai para o ponto seguinte
+static const AlignCase alignCases[] = {
+  {AT(12, 3, 20), 5, 60, AT(12, 10, 0)},    // 12:08:20 -> grade de 5 min
+  {AT(12, 3, 20), 30, 60, AT(12, 30, 0)},   // 12:33:20 -> grade de 30 min
+  {AT(12, 3, 20), 7, 60, AT(12, 10, 0)},    // 12:10:20 -> grade de 1 min
+  {AT(12, 9, 50), 2, 60, AT(12, 12, 0)},    // 12:11:50 -> grade de 2 min
+  {AT(12, 2, 0), 5, 300, AT(12, 10, 0)},    // 12:05 fica antes do sono mínimo
+  {AT(12, 14, 59), 30, 60, AT(12, 30, 0)},  // 12:44:59, mais perto de 12:30
+  {AT(12, 15, 0), 30, 60, AT(13, 0, 0)},    // 12:45:00, empate
+  {AT(12, 0, 30), 60, 60, AT(13, 0, 0)},    // Grade de uma hora
+  {AT(23, 50, 0), 45, 60, AT(24, 30, 0)},   // 00:35 do dia seguinte -> grade de 15 min
+  {AT(12, 0, 0), 0, 60, AT(12, 1, 0)}       // Intervalo zero vale um minuto
+};
+
+static const char* const reasonNames[] = {
+  "base", "rain", "pressure", "stable", "battery_low", "battery_critical"
+};
+
+static long mismatches = 0;
+
+// Lê um trace CSV; linhas vazias e começadas por '#' são ignoradas
+static bool loadTrace(const char* path, std::vector<TraceRow>& rows) {
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+  char line[160];
+  int number = 0;
+  while (fgets(line, sizeof(line), file)) {
+    number++;
+    if (line[0] == '#' || line[0] == '\n') continue;
+    TraceRow row;
+    char why[32];
+    if (sscanf(line, "%ld,%f,%f,%f,%lf,%hu,%31s", &row.seconds, &row.rainLastHourMm,
+               &row.pressureHpa, &row.batteryVoltage, &row.pressureTrend, &row.minutes, why) != 7) {
+      printf("%s:%d: linha inválida\n", path, number);
+      fclose(file);
+      return false;
+    }
+    int reason = -1;
+    for (int r = 0; r < (int)(sizeof(reasonNames) / sizeof(reasonNames[0])); r++) {
+      if (strcmp(why, reasonNames[r]) == 0) reason = r;
+    }
+    if (reason < 0) {
+      printf("%s:%d: motivo desconhecido \"%s\"\n", path, number, why);
+      fclose(file);
+      return false;
+    }
+    row.reason = (SleepReason)reason;
+    rows.push_back(row);
+  }
+  fclose(file);
+  return true;
+}
+
+// Reproduz o trace do primeiro wake (estado zerado) ao último
+static void replay(const TraceRow* rows, size_t count, const char* name) {
+  SleepSchedulerConfig config;
+  config.baseMinutes = DEFAULT_DEEP_SLEEP_TIME_MINUTES;
+  config.minMinutes = DEFAULT_SLEEP_MIN_MINUTES;
+  config.maxMinutes = DEFAULT_SLEEP_MAX_MINUTES;
+  config.lowBatteryVoltage = SLEEP_LOW_BATTERY_VOLTAGE;
+  config.criticalBatteryVoltage = SLEEP_CRITICAL_BATTERY_VOLTAGE;
+  config.fastPressureHpaPerHour = SLEEP_FAST_PRESSURE_HPA_H;
+  config.stablePressureHpaPerHour = SLEEP_STABLE_PRESSURE_HPA_H;
+
+  SleepSchedulerState state;
+  memset(&state, 0, sizeof(state));
+
+  long reasons[6] = {};
+  long sleptMinutes = 0;
+  for (size_t i = 0; i < count; i++) {
+    const TraceRow& row = rows[i];
+    SleepSchedulerInputs inputs;
+    inputs.now = START_EPOCH + row.seconds;
+    inputs.rainLastHourMm = row.rainLastHourMm;
+    inputs.pressureHpa = row.pressureHpa;
+    inputs.batteryVoltage = row.batteryVoltage;
+
+    SleepDecision decision = scheduleNextWake(config, state, inputs);
+    if (decision.minutes != row.minutes || decision.reason != row.reason) {
+      if (mismatches < 5) {
+        printf("%s, wake %zu (%ld s): %u min (%s), gravado %u min (%s)\n", name, i + 1, row.seconds,
+               decision.minutes, sleepReasonName(decision.reason), row.minutes, sleepReasonName(row.reason));
+      }
+      mismatches++;
+    }
+    bool trendMatches = isnan(row.pressureTrend)
+                          ? isnan(decision.pressureTrend)
+                          : fabs(decision.pressureTrend - row.pressureTrend) <= TREND_TOLERANCE;
+    if (!trendMatches) {
+      if (mismatches < 5) {
+        printf("%s, wake %zu (%ld s): dP/dt %.3f hPa/h, gravado %.3f\n", name, i + 1, row.seconds,
+               decision.pressureTrend, row.pressureTrend);
+      }
+      mismatches++;
+    }
+    if (i + 1 < count && rows[i + 1].seconds - row.seconds < (long)row.minutes * 60) {
+      if (mismatches < 5) {
+        printf("%s, wake %zu (%ld s): próximo wake antes dos %u min escolhidos\n", name, i + 1,
+               row.seconds, row.minutes);
+      }
+      mismatches++;
+    }
+    reasons[decision.reason < 6 ? decision.reason : 0]++;
+    sleptMinutes += decision.minutes;
+  }
+
+  printf("%s: %zu wakes em %.1f h, intervalo médio %.1f min\n", name, count,
+         count > 0 ? rows[count - 1].seconds / 3600.0 : 0.0, count > 0 ? (double)sleptMinutes / count : 0.0);
+  printf(" ");
+  for (int r = 0; r < 6; r++) {
+    printf(" %s=%ld", reasonNames[r], reasons[r]);
+  }
+  printf("\n");
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    std::vector<TraceRow> rows;
+    if (!loadTrace(argv[1], rows)) {
+      return 1;
+    }
+    replay(rows.data(), rows.size(), argv[1]);
+  } else {
+    replay(stormDay, sizeof(stormDay) / sizeof(stormDay[0]), "dia de tempestade");
+  }
+
+  for (const AlignCase& test : alignCases) {
+    time_t wake = sleepAlignedWake(test.now, test.minutes, test.minLeadSeconds);
+    if (wake != test.wake) {
+      if (mismatches < 5) {
+        printf("wake alinhado a partir de %+ld s com %u min: %+ld s, esperado %+ld s\n",
+               (long)(test.now - START_EPOCH), test.minutes,
+               (long)(wake - START_EPOCH), (long)(test.wake - START_EPOCH));
+      }
+      mismatches++;
+    }
+  }
+  printf("  %zu wakes alinhados conferidos\n", sizeof(alignCases) / sizeof(alignCases[0]));
+
+  for (int r = 0; r < 6; r++) {
+    if (strcmp(sleepReasonName((SleepReason)r), reasonNames[r]) != 0) {
+      if (mismatches < 5) {
+        printf("motivo %d: \"%s\", esperado \"%s\"\n", r, sleepReasonName((SleepReason)r), reasonNames[r]);
+      }
+      mismatches++;
+    }
+  }
+  if (strcmp(sleepReasonName((SleepReason)99), "?") != 0) {
+    if (mismatches < 5) {
+      printf("motivo inválido não é \"?\"\n");
+    }
+    mismatches++;
+  }
+
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
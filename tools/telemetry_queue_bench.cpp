@@ -0,0 +1,198 @@
+// Reprodução de quedas de rede para conferir a fila de leituras não enviadas
+// (TelemetryQueue) e o ganho do envio em lotes.
+//
+//   g++ -O2 -std=gnu++17 -I include tools/telemetry_queue_bench.cpp src/TelemetryQueue.cpp -o telemetry_queue_bench
+//   ./telemetry_queue_bench [dias] [leituras por lote] [quedas por dia] [horas por queda]
+//
+// Uma leitura a cada 5 min. As quedas começam em instantes sorteados e duram um tempo
+// exponencial com a média dada; durante a queda cada leitura vai para a fila (memória RTC
+// e, quando ela enche, o anel no flash). Na primeira conexão depois da queda a leitura
+// corrente é enviada e a fila sai em até TELEMETRY_DRAIN_MAX_BATCHES lotes na mesma
+// conexão. Em 2% das quedas a energia também cai: a memória RTC se perde e só o anel do
+// flash continua. Confere que as leituras chegam em ordem, sem repetições, e que só se
+// perdem as descartadas com a fila cheia (as mais antigas) e as da memória RTC nas quedas
+// de energia. Depois confere, com leituras feitas antes da primeira sincronização NTP
+// (na memória RTC e no flash), que a sincronização as passa para hora de parede sem mudar
+// as já acertadas, e que um power-on descarta do flash só as ainda sem hora de parede,
+// na ordem. A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "TelemetryQueue.h"
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+int main(int argc, char** argv) {
+  int days = argc > 1 ? atoi(argv[1]) : 60;
+  uint32_t batchFrames = argc > 2 ? (uint32_t)atoi(argv[2]) : 10;
+  double outagesPerDay = argc > 3 ? atof(argv[3]) : 0.5;
+  double outageHours = argc > 4 ? atof(argv[4]) : 4.0;
+
+  static TelemetryQueue queue;
+  static TelemetrySpill spill;     // Cópia em RAM do anel, como no firmware
+  static TelemetrySpill flash;     // Arquivo no flash
+  telemetryQueueReset(queue);
+  telemetrySpillReset(spill);
+  telemetrySpillReset(flash);
+  telemetrySpillSeal(flash);
+
+  uint32_t cycles = (uint32_t)days * 288;
+  uint32_t outageLeft = 0;
+  bool powerCutPending = false;
+  uint32_t lastDelivered = 0;
+  uint32_t delivered = 0;          // Leituras da fila entregues
+  uint32_t queued = 0;
+  uint32_t lostToPower = 0;
+  uint32_t connections = 0;
+  uint32_t batches = 0;
+  uint32_t flashWrites = 0;
+  uint32_t maxPending = 0;
+  long mismatches = 0;
+
+  for (uint32_t reading = 1; reading <= cycles; reading++) {
+    if (outageLeft == 0 && uniform() < outagesPerDay / 288.0) {
+      outageLeft = 1 + (uint32_t)(-log(uniform()) * outageHours * 12.0);
+      powerCutPending = uniform() < 0.02;
+    }
+
+    if (outageLeft > 0) {
+      outageLeft--;
+      if (telemetryQueueFull(queue)) {
+        spill = flash;
+        telemetryQueueSpill(queue, spill);
+        telemetrySpillSeal(spill);
+        flash = spill;
+        flashWrites++;
+      }
+      TelemetryFrame frame = {};
+      frame.timestamp = reading;
+      telemetryQueuePush(queue, frame);
+      queued++;
+      maxPending = telemetryQueuePending(queue) > maxPending ? telemetryQueuePending(queue) : maxPending;
+
+      if (outageLeft == 0 && powerCutPending) {
+        // Boot a frio: a memória RTC é zerada e a fila recomeça do flash
+        lostToPower += queue.count;
+        telemetryQueueReset(queue);
+        if (!telemetrySpillValid(flash)) {
+          mismatches++;
+          printf("anel do flash inválido depois da queda de energia\n");
+        }
+        queue.spilled = flash.count;
+        powerCutPending = false;
+      }
+      continue;
+    }
+
+    // Conexão bem-sucedida: a leitura corrente e a fila na mesma conexão
+    connections++;
+    if (telemetryQueuePending(queue) == 0) {
+      continue;
+    }
+    spill = flash;
+    bool spillChanged = false;
+    for (uint8_t b = 0; b < TELEMETRY_DRAIN_MAX_BATCHES && telemetryQueuePending(queue) > 0; b++) {
+      uint32_t count = 0;
+      const TelemetryFrame* frame;
+      while (count < batchFrames && (frame = telemetryQueueAt(queue, spill, count)) != nullptr) {
+        if (frame->timestamp <= lastDelivered) {
+          if (mismatches++ < 5) {
+            printf("leitura %u entregue depois da %u\n", frame->timestamp, lastDelivered);
+          }
+        }
+        lastDelivered = frame->timestamp;
+        count++;
+      }
+      spillChanged |= queue.spilled > 0;
+      telemetryQueueDrop(queue, spill, count);
+      delivered += count;
+      batches++;
+    }
+    if (spillChanged) {
+      telemetrySpillSeal(spill);
+      flash = spill;
+      flashWrites++;
+    }
+  }
+
+  uint32_t pending = telemetryQueuePending(queue);
+  if (delivered + queue.dropped + lostToPower + pending != queued) {
+    mismatches++;
+    printf("contas divergentes: %u na fila, %u entregues, %u descartadas, %u perdidas, %u pendentes\n",
+           queued, delivered, queue.dropped, lostToPower, pending);
+  }
+
+  printf("%d dias, %.1f quedas/dia de %.1f h em média, lotes de %u leituras\n",
+         days, outagesPerDay, outageHours, batchFrames);
+  printf("  %u leituras na fila: %u entregues em %u lotes, %u descartadas (fila cheia), %u perdidas (energia), %u pendentes\n",
+         queued, delivered, batches, queue.dropped, lostToPower, pending);
+  printf("  %u conexões; as leituras atrasadas saíram em %u mensagens nelas (uma conexão por leitura seriam %u a mais)\n",
+         connections, batches, delivered);
+  printf("  até %u leituras pendentes, %u gravações do anel no flash\n", maxPending, flashWrites);
+
+  // Leituras antes da primeira sincronização: uma já acertada no flash, depois 20 com a
+  // base sem âncora (segundos desde o power-on), parte delas no flash
+  const int64_t offset = 1717200000;
+  const uint32_t unsynced = 20;
+  telemetryQueueReset(queue);
+  telemetrySpillReset(spill);
+  TelemetryFrame frame = {};
+  frame.timestamp = 1717100000;
+  telemetryQueuePush(queue, frame);
+  for (uint32_t i = 1; i <= unsynced; i++) {
+    if (telemetryQueueFull(queue)) {
+      telemetryQueueSpill(queue, spill);
+    }
+    frame.timestamp = i * 300;
+    frame.flags = TELEMETRY_FRAME_UNSYNCED;
+    telemetryQueuePush(queue, frame);
+  }
+  TelemetryQueue beforeSync = queue;
+  static TelemetrySpill spillBeforeSync;
+  spillBeforeSync = spill;
+
+  uint32_t rebased = telemetryQueueRebase(queue, spill, offset);
+  uint32_t expectedRebased = queue.spilled - 1;
+  for (uint32_t i = 0; i <= unsynced; i++) {
+    const TelemetryFrame* f = telemetryQueueAt(queue, spill, i);
+    uint32_t expected = i == 0 ? 1717100000 : (uint32_t)(i * 300 + offset);
+    if (f == nullptr || f->timestamp != expected || (f->flags & TELEMETRY_FRAME_UNSYNCED)) {
+      if (mismatches++ < 5) {
+        printf("leitura %u depois da sincronização: %u, esperado %u\n", i, f ? f->timestamp : 0, expected);
+      }
+    }
+  }
+  if (rebased != expectedRebased || telemetryQueueRebase(queue, spill, offset) != 0) {
+    mismatches++;
+    printf("sincronização acertou %u leituras do flash, esperado %u uma única vez\n", rebased, expectedRebased);
+  }
+
+  // Power-on antes da sincronização: a memória RTC se perde e o flash fica só com a
+  // leitura já acertada
+  queue = beforeSync;
+  spill = spillBeforeSync;
+  telemetryQueueReset(queue);
+  queue.spilled = spill.count;
+  uint32_t discarded = telemetrySpillDropUnsynced(queue, spill);
+  const TelemetryFrame* kept = telemetryQueueAt(queue, spill, 0);
+  if (discarded != (uint32_t)spillBeforeSync.count - 1 || telemetryQueuePending(queue) != 1 ||
+      kept == nullptr || kept->timestamp != 1717100000 || queue.dropped != discarded) {
+    mismatches++;
+    printf("power-on: %u descartadas, %u pendentes\n", discarded, telemetryQueuePending(queue));
+  }
+  printf("  %u leituras antes do NTP: %u acertadas no flash, %u descartadas num power-on\n",
+         unsynced, rebased, discarded);
+
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+// Reprodução de dias de wakes com um oscilador RTC que desvia durante o sono, sobre a
+// base de tempo (Timebase).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/timebase_bench.cpp src/Timebase.cpp -o timebase_bench
+//   ./timebase_bench [ppm] [dias] [horas sem NTP]
+//
+// A cada wake o relógio do sistema anda certo enquanto acordado (cristal) e com o desvio
+// do oscilador enquanto dorme; o desvio varia ±20% ao longo do dia, como com a
+// temperatura. A cada hora o NTP ajusta o relógio, exceto em quedas de rede sorteadas com
+// a duração pedida. Compara o erro da hora sem correção (o relógio do sistema, certo só
+// logo depois de cada NTP) com o da base de tempo e confere que:
+//   - depois da primeira medida do desvio, a base erra bem menos que o relógio sem correção;
+//   - a base nunca volta atrás entre wakes mais que o erro que a sincronização corrige.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "Timebase.h"
+
+#define START_EPOCH_US 1717200000000000LL
+#define SLEEP_SECONDS 300
+#define NTP_INTERVAL_SECONDS 3600
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+int main(int argc, char** argv) {
+  double ppm = argc > 1 ? atof(argv[1]) : 150.0;
+  int days = argc > 2 ? atoi(argv[2]) : 30;
+  double outageHours = argc > 3 ? atof(argv[3]) : 6.0;
+
+  Timebase timebase;
+  timebaseReset(timebase);
+
+  int64_t worldUs = START_EPOCH_US;     // Tempo real
+  int64_t clockUs = 0;                  // Relógio do sistema (power-on em 1970)
+  int64_t endUs = START_EPOCH_US + (int64_t)days * 86400 * 1000000LL;
+  int64_t lastNtpUs = 0;
+  int64_t outageEndUs = 0;
+  int64_t lastStampUs = 0;
+  double maxRawUs = 0, maxBaseUs = 0, maxBackUs = 0, sumBaseUs = 0;
+  long wakes = 0, syncs = 0, measured = 0;
+  long mismatches = 0;
+
+  while (worldUs < endUs) {
+    // Acordado: 0,3 a 3 s no cristal
+    int64_t awakeUs = (int64_t)((0.3 + 2.7 * uniform() * uniform()) * 1000000);
+    wakes++;
+
+    // Uma queda de rede de outageHours a cada dois dias, em média
+    if (worldUs >= outageEndUs && uniform() < (double)SLEEP_SECONDS / (2 * 86400)) {
+      outageEndUs = worldUs + (int64_t)(outageHours * 3600 * 1000000);
+    }
+
+    bool synced = false;
+    if (worldUs >= outageEndUs && worldUs - lastNtpUs >= NTP_INTERVAL_SECONDS * 1000000LL) {
+      // Sincroniza no meio do wake: relógio antes do ajuste, depois igual à hora NTP
+      int64_t half = awakeUs / 2;
+      worldUs += half;
+      clockUs += half;
+      timebaseSync(timebase, clockUs, worldUs, worldUs);
+      if (timebase.driftSamples > 0) measured++;
+      clockUs = worldUs;
+      lastNtpUs = worldUs;
+      awakeUs -= half;
+      syncs++;
+      synced = true;
+    }
+
+    // Registro com a base de tempo; só vale como hora de parede depois da primeira sincronização
+    if (timebaseSynced(timebase)) {
+      int64_t stampUs = timebaseNowUs(timebase, clockUs);
+      double rawError = fabs((double)(clockUs - worldUs));
+      double baseError = fabs((double)(stampUs - worldUs));
+      if (rawError > maxRawUs) maxRawUs = rawError;
+      if (measured > 0) {
+        if (baseError > maxBaseUs) maxBaseUs = baseError;
+        sumBaseUs += baseError;
+      }
+      if (lastStampUs != 0 && stampUs < lastStampUs) {
+        double back = (double)(lastStampUs - stampUs);
+        if (back > maxBackUs) maxBackUs = back;
+        // Só uma sincronização pode levar a base para trás, e só o que ela corrigiu
+        if (!synced || back > 2 * rawError + 1000000) {
+          if (mismatches++ < 5) {
+            printf("base voltou %.3f s no wake %ld\n", back / 1e6, wakes);
+          }
+        }
+      }
+      lastStampUs = stampUs;
+    }
+
+    worldUs += awakeUs;
+    clockUs += awakeUs;
+
+    // Sono com o desvio do oscilador, que varia com a hora do dia
+    double hour = fmod((double)(worldUs - START_EPOCH_US) / 3600e6, 24.0);
+    double drift = ppm * (1.0 + 0.2 * sin(hour * M_PI / 12.0)) * 1e-6;
+    int64_t sleepUs = (int64_t)SLEEP_SECONDS * 1000000LL - awakeUs % 1000000LL;
+    timebaseSleep(timebase, clockUs);
+    worldUs += sleepUs;
+    clockUs += (int64_t)(sleepUs * (1.0 + drift));
+    timebaseWake(timebase, clockUs);
+  }
+
+  long samples = wakes;
+  if (measured > 0 && maxBaseUs * 4 > maxRawUs) {
+    mismatches++;
+    printf("base de tempo não corrige o desvio: erro máximo %.3f s contra %.3f s sem correção\n",
+           maxBaseUs / 1e6, maxRawUs / 1e6);
+  }
+
+  printf("%d dias, oscilador com %.0f ppm (±20%%), quedas de rede de %.1f h\n", days, ppm, outageHours);
+  printf("  %ld wakes, %ld sincronizações NTP, desvio aprendido %.1f ppm em %u medidas\n",
+         wakes, syncs, timebase.driftPpb / 1000.0, timebase.driftSamples);
+  printf("  erro máximo: %.3f s sem correção, %.3f s na base de tempo (média %.3f s)\n",
+         maxRawUs / 1e6, maxBaseUs / 1e6, samples ? sumBaseUs / samples / 1e6 : 0.0);
+  printf("  maior recuo da base numa sincronização: %.3f s\n", maxBackUs / 1e6);
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
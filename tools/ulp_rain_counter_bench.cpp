@@ -0,0 +1,170 @@
+// Reprodução de horas de basculadas com repique do contato sobre o modelo do programa
+// ULP (UlpRainCounterSim) e a colheita (ulpRainHarvest).
+//
+//   g++ -O2 -std=gnu++17 -I include tools/ulp_rain_counter_bench.cpp src/UlpRainCounter.cpp -o ulp_rain_counter_bench
+//   ./ulp_rain_counter_bench [horas] [basculadas/min máx.] [minutos máx. entre colheitas]
+//
+// O pino é amostrado a cada ULP_RAIN_SAMPLE_PERIOD_US. Cada basculada fecha o contato com
+// até três repiques mais curtos que o debounce, fica fechada ~100 ms e abre com repiques;
+// entre basculadas há pulsos isolados de ruído. A intensidade muda a cada hora, com horas
+// secas. Os contadores partem perto do fim dos 16 bits, então o total e o minuto dão a
+// volta logo no início. As colheitas caem em intervalos sorteados, parte deles maior que
+// os ULP_RAIN_BINS minutos dos bins. Confere que:
+//   - cada colheita retorna exatamente as basculadas desde a anterior, sem contar repiques
+//     nem ruído, inclusive quando os contadores dão a volta;
+//   - o callback recebe uma chamada por basculada, em ordem cronológica;
+//   - o timestamp de cada basculada é o início do seu minuto no relógio da colheita, e as
+//     basculadas de bins já sobrescritos caem no minuto mais antigo ainda guardado.
+// A saída é diferente de zero se houver alguma divergência.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "UlpRainCounter.h"
+
+#define START_EPOCH 1717200000L
+#define START_COUNTER 0xFFF0          // Total e minuto iniciais, perto da volta
+#define CLOSED_SAMPLES 20             // Contato fechado por basculada (~100 ms)
+
+static uint32_t rng = 12345;
+
+static double uniform() {
+  rng ^= rng << 13;
+  rng ^= rng >> 17;
+  rng ^= rng << 5;
+  return (rng + 1.0) / 4294967297.0;
+}
+
+static int between(int low, int high) {
+  return low + (int)(uniform() * (high - low + 1));
+}
+
+static std::vector<time_t> delivered;
+
+static void onTip(time_t timestamp) {
+  delivered.push_back(timestamp);
+}
+
+int main(int argc, char** argv) {
+  int hours = argc > 1 ? atoi(argv[1]) : 48;
+  int maxRate = argc > 2 ? atoi(argv[2]) : 8;
+  int maxHarvestMinutes = argc > 3 ? atoi(argv[3]) : 45;
+
+  const uint8_t wet = RAIN_GAUGE_WAKE_LEVEL;
+  const uint8_t dry = !RAIN_GAUGE_WAKE_LEVEL;
+  const uint64_t samplesPerHour = 3600000000ULL / ULP_RAIN_SAMPLE_PERIOD_US;
+  const uint64_t end = (uint64_t)hours * samplesPerHour;
+
+  UlpRainCounterSim ulp;
+  ulp.reset(dry);
+  // Contadores de uma estação ligada há meses: colheita anterior em dia com o ULP
+  ulp.memory[ULP_RAIN_VAR_TOTAL] = START_COUNTER;
+  ulp.memory[ULP_RAIN_VAR_MINUTE] = START_COUNTER;
+  ulp.memory[ULP_RAIN_VAR_LAST_TOTAL] = START_COUNTER;
+  ulp.memory[ULP_RAIN_VAR_LAST_MINUTE] = START_COUNTER;
+
+  std::vector<uint8_t> pattern;       // Níveis ainda a aplicar no pino
+  size_t patternPos = 0;
+  int closedRun = 0;                  // Amostras seguidas no nível molhado
+  std::vector<uint64_t> pendingMinutes; // Minuto (absoluto) de cada basculada ainda não colhida
+  double tipsPerSample = 0;
+  uint64_t nextHarvest = (uint64_t)between(1, maxHarvestMinutes) * ULP_RAIN_TICKS_PER_MINUTE;
+  long tips = 0, glitches = 0, harvests = 0, overwritten = 0, totalWraps = 0;
+  long mismatches = 0;
+  uint16_t lastTotal = START_COUNTER;
+
+  for (uint64_t sample = 1; sample <= end; sample++) {
+    if ((sample - 1) % samplesPerHour == 0) {
+      // Intensidade da hora: um terço das horas é seco
+      tipsPerSample = uniform() < 0.33 ? 0 : uniform() * maxRate / (double)ULP_RAIN_TICKS_PER_MINUTE;
+    }
+
+    if (patternPos >= pattern.size()) {
+      pattern.clear();
+      patternPos = 0;
+      if (uniform() < tipsPerSample) {
+        // Fechamento com repiques, contato fechado e abertura com repiques
+        for (int b = between(0, 3); b > 0; b--) {
+          pattern.insert(pattern.end(), between(1, ULP_RAIN_DEBOUNCE_SAMPLES - 1), wet);
+          pattern.insert(pattern.end(), between(1, 2), dry);
+        }
+        pattern.insert(pattern.end(), CLOSED_SAMPLES, wet);
+        for (int b = between(0, 3); b > 0; b--) {
+          pattern.insert(pattern.end(), between(1, 2), dry);
+          pattern.insert(pattern.end(), between(1, ULP_RAIN_DEBOUNCE_SAMPLES - 1), wet);
+        }
+        pattern.insert(pattern.end(), ULP_RAIN_DEBOUNCE_SAMPLES, dry);
+      } else if (uniform() < 1e-5) {
+        // Ruído no cabo: pulso mais curto que o debounce
+        pattern.insert(pattern.end(), between(1, ULP_RAIN_DEBOUNCE_SAMPLES - 1), wet);
+        glitches++;
+      }
+    }
+    uint8_t level = patternPos < pattern.size() ? pattern[patternPos++] : dry;
+
+    ulp.run(level);
+
+    // Basculada aceita na amostra em que o nível molhado completa o debounce; o ULP a
+    // conta no minuto em que essa amostra cai
+    closedRun = level == wet ? closedRun + 1 : 0;
+    if (closedRun == ULP_RAIN_DEBOUNCE_SAMPLES) {
+      pendingMinutes.push_back(sample / ULP_RAIN_TICKS_PER_MINUTE);
+      tips++;
+    }
+
+    uint16_t total = ulp.memory[ULP_RAIN_VAR_TOTAL] & 0xFFFF;
+    if (total < lastTotal) totalWraps++;
+    lastTotal = total;
+
+    if (sample < nextHarvest && sample != end) {
+      continue;
+    }
+
+    // Colheita no wake por timer
+    harvests++;
+    uint64_t minute = sample / ULP_RAIN_TICKS_PER_MINUTE;
+    time_t now = START_EPOCH + (time_t)(sample * ULP_RAIN_SAMPLE_PERIOD_US / 1000000ULL);
+    uint16_t lastMinute = ulp.memory[ULP_RAIN_VAR_LAST_MINUTE] & 0xFFFF;
+    uint16_t elapsed = (uint16_t)((START_COUNTER + minute) & 0xFFFF) - lastMinute;
+    if (elapsed > ULP_RAIN_BINS - 1) overwritten++;
+
+    delivered.clear();
+    uint16_t harvested = ulpRainHarvest(ulp.memory, now, onTip);
+
+    if (harvested != pendingMinutes.size() || delivered.size() != pendingMinutes.size()) {
+      if (mismatches < 5) {
+        printf("colheita %ld: %zu basculadas, retornou %u, callback %zu\n",
+               harvests, pendingMinutes.size(), harvested, delivered.size());
+      }
+      mismatches++;
+    } else {
+      for (size_t i = 0; i < delivered.size(); i++) {
+        uint64_t age = minute - pendingMinutes[i];
+        if (age > ULP_RAIN_BINS - 1) age = ULP_RAIN_BINS - 1;
+        time_t expected = now - (time_t)age * 60;
+        if (delivered[i] != expected) {
+          if (mismatches < 5) {
+            printf("colheita %ld: basculada %zu com timestamp %ld, esperado %ld (%lu min antes)\n",
+                   harvests, i, (long)delivered[i], (long)expected, (unsigned long)(minute - pendingMinutes[i]));
+          }
+          mismatches++;
+          break;
+        }
+      }
+    }
+
+    pendingMinutes.clear();
+    nextHarvest = sample + (uint64_t)between(1, maxHarvestMinutes) * ULP_RAIN_TICKS_PER_MINUTE;
+  }
+
+  uint16_t minuteCounter = ulp.memory[ULP_RAIN_VAR_MINUTE] & 0xFFFF;
+  printf("%d h, até %d basculadas/min: %ld basculadas, %ld pulsos de ruído\n", hours, maxRate, tips, glitches);
+  printf("  %ld colheitas, %ld com bins sobrescritos\n", harvests, overwritten);
+  printf("  total deu a volta %ld vezes; minuto %u\n", totalWraps, minuteCounter);
+  if (totalWraps == 0 || minuteCounter >= START_COUNTER) {
+    printf("  contadores não deram a volta\n");
+    mismatches++;
+  }
+  printf("  %ld divergências\n", mismatches);
+  return mismatches == 0 ? 0 : 1;
+}
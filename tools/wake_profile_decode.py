@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+Decodifica o campo "prof" da telemetria da estação e calcula percentis por fase.
+
+Cada payload (MQTT ou Meshtastic) traz em "prof" a duração, em ms, de cada fase
+do ciclo de wake anterior, na mesma ordem do enum WakePhase (include/WakeProfiler.h).
+
+Uso:
+    mosquitto_sub -h broker -t weather/station1 | python3 tools/wake_profile_decode.py
+    python3 tools/wake_profile_decode.py payloads.log
+
+Aceita uma mensagem JSON por linha; texto antes do primeiro '{' (por exemplo o
+tópico impresso por `mosquitto_sub -v`) é ignorado.
+"""
+
+import json
+import sys
+
+# Mesma ordem de WakePhase
+PHASES = ["boot", "config", "wifi", "ntp", "sensors", "send", "sleep"]
+PERCENTILES = [50, 90, 99]
+
+
+def percentile(sorted_values, pct):
+    """Percentil com interpolação linear entre os vizinhos mais próximos."""
+    if not sorted_values:
+        return 0.0
+    rank = (len(sorted_values) - 1) * pct / 100.0
+    low = int(rank)
+    high = min(low + 1, len(sorted_values) - 1)
+    return sorted_values[low] + (sorted_values[high] - sorted_values[low]) * (rank - low)
+
+
+def read_profiles(stream):
+    for line in stream:
+        start = line.find("{")
+        if start < 0:
+            continue
+        try:
+            payload = json.loads(line[start:])
+        except ValueError:
+            continue
+        prof = payload.get("prof")
+        if isinstance(prof, list) and prof:
+            yield prof
+
+
+def main(argv):
+    stream = open(argv[1]) if len(argv) > 1 else sys.stdin
+    samples = {name: [] for name in PHASES + ["total"]}
+
+    for prof in read_profiles(stream):
+        for index, value in enumerate(prof[:len(PHASES)]):
+            samples[PHASES[index]].append(value)
+        samples["total"].append(sum(prof))
+
+    count = len(samples["total"])
+    if count == 0:
+        print("Nenhum campo \"prof\" encontrado na entrada")
+        return 1
+
+    mean_total = sum(samples["total"]) / count
+    header = "%-8s" % "fase" + "".join("%9s" % ("p%d" % p) for p in PERCENTILES) + "%9s%9s%8s" % ("max", "média", "%total")
+    print("%d ciclos analisados (valores em ms)" % count)
+    print(header)
+    for name in PHASES + ["total"]:
+        values = sorted(samples[name])
+        if not values:
+            continue
+        mean = sum(values) / len(values)
+        row = "%-8s" % name
+        row += "".join("%9.0f" % percentile(values, p) for p in PERCENTILES)
+        row += "%9.0f%9.0f%7.1f%%" % (values[-1], mean, 100.0 * mean / mean_total if mean_total else 0.0)
+        print(row)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))